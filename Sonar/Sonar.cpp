@@ -118,6 +118,7 @@ int main(int, char**)
     state.has_debug_privilege = EnableDebugPrivilege();
     state.process_list = GetProcessList();
     state.quick_scan_selections.resize(state.process_list.size(), false);
+    state.dump_selections.resize(state.process_list.size(), false);
 
     PushLog(state.quick_scan_lines, state.accent_color, ICON_FA_INFO_CIRCLE " Sonar initialized. Found %zu processes.", state.process_list.size());
     if (state.has_debug_privilege) {
@@ -6,6 +6,10 @@
 #include <memory>
 #include <map>
 #include <cctype>
+#include <array>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
 
 namespace AhoCorasick {
 
@@ -103,8 +107,105 @@ namespace AhoCorasick {
             return matches;
         }
 
+        const TrieNode<CharT>* root_node() const { return root.get(); }
+        size_t pattern_count() const { return patterns.size(); }
+
     private:
         std::unique_ptr<TrieNode<CharT>> root;
         std::vector<StringT> patterns;
     };
+
+    // Read-only, flattened form of a byte Trie for hot loops that only need to know whether any
+    // pattern occurs. Nodes and their sorted edges live in flat arrays, the root has a full
+    // 256-entry transition table since most steps start there, and a node is terminal if a pattern
+    // ends at it or anywhere along its failure chain. Safe to share between threads.
+    class ByteMatcher {
+    public:
+        // `trie` must have had build_failure_links() called.
+        template <bool CaseInsensitive>
+        explicit ByteMatcher(const Trie<char, CaseInsensitive>& trie) {
+            for (int c = 0; c < 256; ++c) fold[c] = CaseInsensitive ? (unsigned char)std::tolower(c) : (unsigned char)c;
+
+            // Number the nodes breadth-first so every node's edges can be written as it is visited.
+            std::unordered_map<const TrieNode<char>*, uint32_t> ids;
+            std::vector<const TrieNode<char>*> order;
+            ids[trie.root_node()] = 0;
+            order.push_back(trie.root_node());
+            for (size_t i = 0; i < order.size(); ++i) {
+                for (const auto& [label, child] : order[i]->children) {
+                    ids[child.get()] = (uint32_t)order.size();
+                    order.push_back(child.get());
+                }
+            }
+            nodes.resize(order.size());
+            root_next.fill(0);
+            for (size_t i = 0; i < order.size(); ++i) {
+                const TrieNode<char>* node = order[i];
+                Node& flat = nodes[i];
+                flat.first_edge = (uint32_t)edge_labels.size();
+                for (const auto& [label, child] : node->children) {
+                    edge_labels.push_back((unsigned char)label);
+                    edge_targets.push_back(ids[child.get()]);
+                    if (i == 0) root_next[(unsigned char)label] = ids[child.get()];
+                }
+                flat.edge_count = (uint32_t)(edge_labels.size() - flat.first_edge);
+                flat.failure = node->failure_link ? ids[node->failure_link] : 0;
+                flat.terminal = !node->output_indices.empty();
+            }
+            // std::map orders char labels as signed; edge search needs them as unsigned bytes.
+            for (Node& flat : nodes) {
+                std::vector<std::pair<unsigned char, uint32_t>> edges;
+                for (uint32_t e = flat.first_edge; e < flat.first_edge + flat.edge_count; ++e) edges.push_back({ edge_labels[e], edge_targets[e] });
+                std::sort(edges.begin(), edges.end());
+                for (uint32_t e = 0; e < flat.edge_count; ++e) {
+                    edge_labels[flat.first_edge + e] = edges[e].first;
+                    edge_targets[flat.first_edge + e] = edges[e].second;
+                }
+            }
+            empty = trie.pattern_count() == 0;
+        }
+
+        bool is_empty() const { return empty; }
+
+        // True if any pattern occurs in `text`. Stops at the first match.
+        bool contains_any(const char* text, size_t text_len) const {
+            if (empty) return false;
+            uint32_t state = 0;
+            for (size_t i = 0; i < text_len; ++i) {
+                const unsigned char c = fold[(unsigned char)text[i]];
+                while (state != 0) {
+                    const Node& node = nodes[state];
+                    const unsigned char* labels = edge_labels.data() + node.first_edge;
+                    const unsigned char* found = std::lower_bound(labels, labels + node.edge_count, c);
+                    if (found != labels + node.edge_count && *found == c) break;
+                    state = node.failure;
+                }
+                if (state == 0) {
+                    state = root_next[c];
+                }
+                else {
+                    const Node& node = nodes[state];
+                    const unsigned char* labels = edge_labels.data() + node.first_edge;
+                    state = edge_targets[node.first_edge + (uint32_t)(std::lower_bound(labels, labels + node.edge_count, c) - labels)];
+                }
+                if (nodes[state].terminal) return true;
+            }
+            return false;
+        }
+
+    private:
+        struct Node {
+            uint32_t first_edge = 0;
+            uint32_t edge_count = 0;
+            uint32_t failure = 0;
+            bool terminal = false;
+        };
+
+        std::vector<Node> nodes;
+        std::vector<unsigned char> edge_labels;
+        std::vector<uint32_t> edge_targets;
+        std::array<uint32_t, 256> root_next;
+        unsigned char fold[256];
+        bool empty = true;
+    };
 } // namespace AhoCorasick
\ No newline at end of file
@@ -2,6 +2,22 @@
 
 #include "backend.h"
 #include "ui.h" // Include ui.h to get the definition of AppState
+#include "dump_format.h"
+#include "dump_reader.h"
+#include "dump_job.h"
+#include "dump_manifest.h"
+#include "job_journal.h"
+#include "provenance.h"
+#include "string_scan.hpp"
+#include "string_runs.h"
+#include "string_set.h"
+#include "throttle.h"
+#include "frame_file.h"
+#include "front_coded.h"
+#include "aho_corasick.hpp"
+#include "binary_diff.h"
+#include "chunk_diff.h"
+#include "text_diff.h"
 #include <windows.h>
 #include <tlhelp32.h>
 #include <psapi.h>
@@ -14,9 +30,11 @@
 #include <mutex>
 #include <functional>
 #include <algorithm>
+#include <cstring>
 #include <string_view>
 #include <ctime>
 #include <iomanip>
+#include <unordered_map>
 #include <unordered_set>
 #include <cwctype>
 #include <filesystem>
@@ -207,10 +225,133 @@ PEInfo InspectPEFile(const std::string& file_path) {
     file.close();
     return result;
 }
-static void ReadAllLines(const std::string& path, std::unordered_set<std::string>& lines) { std::ifstream file(path); if (!file.is_open()) return; std::string line; while (std::getline(file, line)) { if (!line.empty() && line.back() == '\r') line.pop_back(); if (!line.empty()) lines.insert(line); } }
-static void ExtractStringsFromBuffer(const std::vector<char>& buffer, std::streamsize bytes_read, std::unordered_set<std::string>& string_set) { std::string current_string; for (std::streamsize i = 0; i < bytes_read; ++i) { char c = buffer[i]; if (isprint(static_cast<unsigned char>(c))) { current_string += c; } else { if (current_string.length() >= 4) { string_set.insert(current_string); } current_string.clear(); } } if (current_string.length() >= 4) { string_set.insert(current_string); } }
-DiffResult PerformDifferentialAnalysis(const std::string& clean_path, const std::string& dirty_path, std::function<void(float)> progress_callback) { DiffResult result; bool use_text_comparison = (clean_path.size() > 4 && clean_path.substr(clean_path.size() - 4) == ".txt") && (dirty_path.size() > 4 && dirty_path.substr(dirty_path.size() - 4) == ".txt"); if (use_text_comparison) { progress_callback(0.0f); std::unordered_set<std::string> clean_strings; std::unordered_set<std::string> dirty_strings; std::thread clean_thread(ReadAllLines, clean_path, std::ref(clean_strings)); std::thread dirty_thread(ReadAllLines, dirty_path, std::ref(dirty_strings)); clean_thread.join(); dirty_thread.join(); progress_callback(0.5f); for (const auto& str : dirty_strings) { if (clean_strings.find(str) == clean_strings.end()) { result.new_strings.push_back(str); } } std::sort(result.new_strings.begin(), result.new_strings.end()); progress_callback(1.0f); return result; } std::ifstream clean_file(clean_path, std::ios::binary | std::ios::ate); std::ifstream dirty_file(dirty_path, std::ios::binary | std::ios::ate); if (!clean_file.is_open()) { result.error = "Error: Could not open clean dump file."; return result; } if (!dirty_file.is_open()) { result.error = "Error: Could not open dirty dump file."; return result; } std::streampos clean_size = clean_file.tellg(); std::streampos dirty_size = dirty_file.tellg(); clean_file.seekg(0, std::ios::beg); dirty_file.seekg(0, std::ios::beg); if (clean_size == 0 || dirty_size == 0) { result.error = "Error: One or both dump files are empty."; return result; } const size_t CHUNK_SIZE = 4 * 1024 * 1024; std::vector<char> clean_buffer(CHUNK_SIZE); std::vector<char> dirty_buffer(CHUNK_SIZE); std::unordered_set<std::string> clean_strings; std::unordered_set<std::string> dirty_strings; uint64_t current_offset = 0; std::streampos max_size = std::max(clean_size, dirty_size); progress_callback(0.0f); while (current_offset < (uint64_t)max_size) { clean_file.read(clean_buffer.data(), CHUNK_SIZE); dirty_file.read(dirty_buffer.data(), CHUNK_SIZE); std::streamsize clean_bytes_read = clean_file.gcount(); std::streamsize dirty_bytes_read = dirty_file.gcount(); if (clean_bytes_read == 0 && dirty_bytes_read == 0) break; if (clean_bytes_read > 0 || dirty_bytes_read > 0) { size_t clean_hash = (clean_bytes_read > 0) ? std::hash<std::string_view>{}(std::string_view(clean_buffer.data(), clean_bytes_read)) : 0; size_t dirty_hash = (dirty_bytes_read > 0) ? std::hash<std::string_view>{}(std::string_view(dirty_buffer.data(), dirty_bytes_read)) : 0; if (clean_hash != dirty_hash) { result.modified_regions.push_back({ current_offset, (size_t)std::max(clean_bytes_read, dirty_bytes_read), clean_hash, dirty_hash }); } } if (clean_bytes_read > 0) { ExtractStringsFromBuffer(clean_buffer, clean_bytes_read, clean_strings); } if (dirty_bytes_read > 0) { ExtractStringsFromBuffer(dirty_buffer, dirty_bytes_read, dirty_strings); } current_offset += CHUNK_SIZE; progress_callback(static_cast<float>(current_offset) / max_size); } for (const auto& str : dirty_strings) { if (clean_strings.find(str) == clean_strings.end()) { result.new_strings.push_back(str); } } std::sort(result.new_strings.begin(), result.new_strings.end()); progress_callback(1.0f); return result; }
-std::pair<bool, std::string> ExportDiffResults(const DiffResult& result, const std::string& output_path) { std::ofstream out_file(output_path); if (!out_file.is_open()) { return { false, "Error: Could not open file for writing: " + output_path }; } auto t = std::time(nullptr); tm tm_info; localtime_s(&tm_info, &t); std::ostringstream time_stream; time_stream << std::put_time(&tm_info, "%Y-%m-%d %H:%M:%S"); out_file << "--- Sonar Differential Analysis Report ---\n"; out_file << "--- Generated on: " << time_stream.str() << " ---\n\n"; if (!result.new_strings.empty()) { out_file << "--- New Strings Found (" << result.new_strings.size() << ") ---\n"; for (const auto& str : result.new_strings) { out_file << str << "\n"; } } else { out_file << "--- No New Strings Found ---\n"; } out_file << "\n\n"; if (!result.modified_regions.empty()) { out_file << "--- Modified Memory Regions (" << result.modified_regions.size() << ") ---\n"; out_file << "Offset,Size (bytes),Clean Hash,Dirty Hash\n"; for (const auto& region : result.modified_regions) { std::stringstream ss; ss << "0x" << std::hex << region.offset << "," << std::dec << region.size << "," << "0x" << std::hex << region.clean_hash << "," << "0x" << region.dirty_hash << "\n"; out_file << ss.str(); } } else { out_file << "--- No Modified Memory Regions Found ---\n"; } out_file.close(); return { true, "Successfully exported results to " + output_path }; }
+
+// Reads through DumpFileSource so compressed text dumps diff the same as plain ones.
+static void ReadAllLines(const std::string& path, std::unordered_set<std::string>& lines) {
+    std::string error;
+    DumpFileSource source;
+    if (!source.Open(path, error)) return;
+    const size_t CHUNK_SIZE = 1024 * 1024;
+    std::vector<char> buffer(CHUNK_SIZE);
+    std::string line;
+    for (uint64_t offset = 0; offset < source.Size();) {
+        size_t bytes_read = source.ReadAt(offset, buffer.data(), buffer.size());
+        if (bytes_read == 0) break;
+        offset += bytes_read;
+        for (size_t i = 0; i < bytes_read; ++i) {
+            if (buffer[i] != '\n') { line += buffer[i]; continue; }
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!line.empty()) lines.insert(line);
+            line.clear();
+        }
+    }
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (!line.empty()) lines.insert(line);
+}
+
+// Fills the string lists of `result` from both dumps' string sets.
+static void CompareStringSets(const std::unordered_set<std::string>& clean_strings, const std::unordered_set<std::string>& dirty_strings, DiffResult& result) {
+    for (const auto& str : dirty_strings) {
+        if (clean_strings.find(str) == clean_strings.end()) result.new_strings.push_back(str);
+        else ++result.common_string_count;
+    }
+    for (const auto& str : clean_strings) { if (dirty_strings.find(str) == dirty_strings.end()) { result.removed_strings.push_back(str); } }
+    std::sort(result.new_strings.begin(), result.new_strings.end());
+    std::sort(result.removed_strings.begin(), result.removed_strings.end());
+}
+
+// Memory the in-memory text diff needs for one dump: its strings in a hash set cost several times
+// their bytes in nodes, buckets and string headers.
+static uint64_t TextDiffFootprint(const std::string& path) {
+    DumpFileSource source;
+    std::string error;
+    return source.Open(path, error) ? source.Size() * 4 : 0;
+}
+
+// Text diffs larger than this go through sorted runs on disk: a quarter of the free physical memory.
+static uint64_t TextDiffMemoryBudget() {
+    const uint64_t MIN_BUDGET = 256ULL * 1024 * 1024;
+    MEMORYSTATUSEX status = {};
+    status.dwLength = sizeof(status);
+    if (!GlobalMemoryStatusEx(&status)) return MIN_BUDGET;
+    return std::max<uint64_t>(status.ullAvailPhys / 4, MIN_BUDGET);
+}
+DiffResult PerformDifferentialAnalysis(const std::string& clean_path, const std::string& dirty_path, std::function<void(float)> progress_callback, BinaryDiffMode binary_mode) {
+    DiffResult result;
+    const bool clean_front_coded = FrontCoded::IsFrontCoded(clean_path);
+    const bool dirty_front_coded = FrontCoded::IsFrontCoded(dirty_path);
+    auto is_text = [](const std::string& path, bool front_coded) { return front_coded || (path.size() > 4 && path.substr(path.size() - 4) == ".txt"); };
+    bool use_text_comparison = is_text(clean_path, clean_front_coded) && is_text(dirty_path, dirty_front_coded);
+    const uint64_t text_budget = use_text_comparison ? TextDiffMemoryBudget() : 0;
+    if (use_text_comparison && (clean_front_coded || dirty_front_coded || TextDiffFootprint(clean_path) + TextDiffFootprint(dirty_path) > text_budget)) {
+        // Sorted runs on disk and one merge-join: memory stays within the budget whatever the dump
+        // sizes. Front-coded dumps are already sorted and are merged as they are.
+        TextDiff::Result text_result;
+        std::string diff_error;
+        const int thread_count = std::max(1, (int)std::thread::hardware_concurrency());
+        const std::string temp_prefix = dirty_path + ".diffsort";
+        progress_callback(0.0f);
+        if (!TextDiff::Compare(clean_path, dirty_path, text_budget, thread_count, temp_prefix, progress_callback, text_result, diff_error)) { result.error = "Error: " + diff_error; return result; }
+        result.new_strings = std::move(text_result.new_strings);
+        result.removed_strings = std::move(text_result.removed_strings);
+        result.common_string_count = text_result.common_count;
+        return result;
+    }
+    if (use_text_comparison) {
+        progress_callback(0.0f);
+        std::unordered_set<std::string> clean_strings;
+        std::unordered_set<std::string> dirty_strings;
+        std::thread clean_thread(ReadAllLines, clean_path, std::ref(clean_strings));
+        std::thread dirty_thread(ReadAllLines, dirty_path, std::ref(dirty_strings));
+        clean_thread.join();
+        dirty_thread.join();
+        progress_callback(0.5f);
+        CompareStringSets(clean_strings, dirty_strings, result);
+        progress_callback(1.0f);
+        return result;
+    }
+    // Binary dumps go through DumpReader so optimized (deduplicated) dumps compare as their full image.
+    DumpReader clean_reader;
+    DumpReader dirty_reader;
+    std::string open_error;
+    if (!clean_reader.Open(clean_path, open_error)) { result.error = "Error: Could not open clean dump file. " + open_error; return result; }
+    if (!dirty_reader.Open(dirty_path, open_error)) { result.error = "Error: Could not open dirty dump file. " + open_error; return result; }
+    if (clean_reader.LogicalSize() == 0 || dirty_reader.LogicalSize() == 0) { result.error = "Error: One or both dump files are empty."; return result; }
+    // Pages are compared on every core; each worker also collects strings into its own sets.
+    const int thread_count = std::max(1, (int)std::thread::hardware_concurrency());
+    std::vector<std::unordered_set<std::string>> worker_clean_strings(thread_count);
+    std::vector<std::unordered_set<std::string>> worker_dirty_strings(thread_count);
+    auto collect_strings = [&](int worker, const char* clean, size_t clean_size, const char* dirty, size_t dirty_size) {
+        StringScan::ForEachPrintableRun(clean, clean_size, 4, [&](size_t offset, size_t length) { worker_clean_strings[worker].emplace(clean + offset, length); });
+        StringScan::ForEachPrintableRun(dirty, dirty_size, 4, [&](size_t offset, size_t length) { worker_dirty_strings[worker].emplace(dirty + offset, length); });
+    };
+    progress_callback(0.0f);
+    auto compare_progress = [&](float progress) { progress_callback(progress * 0.95f); };
+    if (binary_mode == BINARY_DIFF_BY_ADDRESS) {
+        if (!clean_reader.IsStructured() || !dirty_reader.IsStructured()) { result.error = "Error: Diffing by address needs two optimized (structured) dumps with region tables."; return result; }
+        for (const auto& change : BinaryDiff::CompareRegions(clean_reader, dirty_reader, thread_count, compare_progress, collect_strings)) {
+            result.modified_regions.push_back({ change.offset, change.size, change.changed_bytes, change.kind, true, change.address, change.clean_size });
+        }
+    }
+    else if (binary_mode == BINARY_DIFF_BY_CONTENT) {
+        for (const auto& change : ChunkDiff::Compare(clean_reader, dirty_reader, thread_count, compare_progress, collect_strings)) {
+            result.modified_regions.push_back({ change.offset, change.size, change.changed_bytes, change.kind, false, 0, 0, change.clean_offset });
+        }
+    }
+    else {
+        for (const auto& range : BinaryDiff::ComparePages(clean_reader, dirty_reader, thread_count, compare_progress, collect_strings)) {
+            result.modified_regions.push_back({ range.offset, range.size, range.changed_bytes });
+        }
+    }
+    std::unordered_set<std::string> clean_strings;
+    std::unordered_set<std::string> dirty_strings;
+    for (auto& strings : worker_clean_strings) { clean_strings.merge(strings); std::unordered_set<std::string>().swap(strings); }
+    for (auto& strings : worker_dirty_strings) { dirty_strings.merge(strings); std::unordered_set<std::string>().swap(strings); }
+    CompareStringSets(clean_strings, dirty_strings, result);
+    progress_callback(1.0f);
+    return result;
+}
+std::pair<bool, std::string> ExportDiffResults(const DiffResult& result, const std::string& output_path) { std::ofstream out_file(output_path); if (!out_file.is_open()) { return { false, "Error: Could not open file for writing: " + output_path }; } auto t = std::time(nullptr); tm tm_info; localtime_s(&tm_info, &t); std::ostringstream time_stream; time_stream << std::put_time(&tm_info, "%Y-%m-%d %H:%M:%S"); out_file << "--- Sonar Differential Analysis Report ---\n"; out_file << "--- Generated on: " << time_stream.str() << " ---\n\n"; if (!result.new_strings.empty()) { out_file << "--- New Strings Found (" << result.new_strings.size() << ") ---\n"; for (const auto& str : result.new_strings) { out_file << str << "\n"; } } else { out_file << "--- No New Strings Found ---\n"; } out_file << "\n\n"; if (!result.removed_strings.empty()) { out_file << "--- Removed Strings (" << result.removed_strings.size() << ") ---\n"; for (const auto& str : result.removed_strings) { out_file << str << "\n"; } } else { out_file << "--- No Removed Strings Found ---\n"; } out_file << "\n--- Strings In Both Dumps: " << result.common_string_count << " ---\n\n\n"; if (!result.modified_regions.empty()) { out_file << "--- Modified Memory Regions (" << result.modified_regions.size() << ") ---\n"; out_file << "Change,Address,Offset,Size (bytes),Changed Bytes,Clean Size (bytes),Clean Offset\n"; for (const auto& region : result.modified_regions) { std::stringstream ss; ss << BinaryDiff::ChangeKindName(region.kind) << ","; if (region.has_address) ss << "0x" << std::hex << region.address; ss << "," << "0x" << std::hex << region.offset << "," << std::dec << region.size << "," << region.changed_bytes << ","; if (region.kind == BinaryDiff::CHANGE_RESIZED) ss << region.clean_size; ss << ","; if (region.kind == BinaryDiff::CHANGE_MOVED) ss << "0x" << std::hex << region.clean_offset; ss << "\n"; out_file << ss.str(); } } else { out_file << "--- No Modified Memory Regions Found ---\n"; } out_file.close(); return { true, "Successfully exported results to " + output_path }; }
 
 void PerformQuickScan(AppState& state, const std::vector<ProcessInfo>& targets, const std::string& signatures_str, bool case_insensitive, std::function<void(float, const std::string&)> progress_callback) {
 
@@ -279,7 +420,36 @@ void PerformQuickScan(AppState& state, const std::vector<ProcessInfo>& targets,
         return;
     }
 
-    std::atomic<size_t> regions_scanned = 0;
+    // Checkpoint: a scan interrupted part way (crash, killed host) resumes from its journal when it
+    // is restarted with the same signatures and the same region layout. Each scanned region records
+    // its hits, which are replayed into the results instead of being scanned again.
+    struct JournalHit { uint64_t address; uint32_t signature; uint32_t wide; };
+    JournalIdentity identity;
+    identity.Add(signatures_str).Add(case_insensitive);
+    for (const auto& task : all_regions) identity.Add((uint64_t)task.target.pid).Add((uint64_t)(uintptr_t)task.region.BaseAddress).Add((uint64_t)task.region.RegionSize);
+    JobJournal journal;
+    std::vector<char> region_done(all_regions.size(), 0);
+    std::vector<char> journal_extra;
+    std::vector<ScanResult> replayed_results;
+    std::string journal_error;
+    auto replay = [&](uint64_t region_index, const char* payload, size_t size) {
+        const auto& task = all_regions[region_index];
+        for (size_t offset = 0; offset + sizeof(JournalHit) <= size; offset += sizeof(JournalHit)) {
+            JournalHit hit;
+            std::memcpy(&hit, payload + offset, sizeof(hit));
+            if (hit.signature >= signatures.size()) continue;
+            replayed_results.push_back({ signatures[hit.signature].original + (hit.wide ? " (Unicode)" : " (ASCII)"), task.target.name, task.target.pid, (void*)(uintptr_t)hit.address });
+        }
+        region_done[region_index] = 1;
+    };
+    const bool journaling = journal.Open(GetAppDataDirectory() + "\\quickscan.journal", identity.Digest(), all_regions.size(), journal_extra, replay, journal_error);
+    if (!replayed_results.empty()) {
+        std::lock_guard<std::mutex> lock(state.scan_result_queue_mutex);
+        state.scan_result_queue.insert(state.scan_result_queue.end(), replayed_results.begin(), replayed_results.end());
+    }
+    const size_t resumed_regions = (size_t)std::count(region_done.begin(), region_done.end(), 1);
+
+    std::atomic<size_t> regions_scanned = resumed_regions;
     const size_t total_regions = all_regions.size();
     const int num_threads = state.scanner_thread_count;
     std::vector<std::thread> threads;
@@ -292,9 +462,13 @@ void PerformQuickScan(AppState& state, const std::vector<ProcessInfo>& targets,
 
             HANDLE hProcess = NULL;
             DWORD current_pid = 0;
+            WorkerThrottle throttle(&state.resource_limits);
+            std::vector<JournalHit> region_hits;
 
             for (size_t i = t; i < total_regions; i += num_threads) {
+                if (region_done[i]) continue;
                 const auto& task = all_regions[i];
+                region_hits.clear();
 
                 if (task.target.pid != current_pid) {
                     if (hProcess) CloseHandle(hProcess);
@@ -312,17 +486,22 @@ void PerformQuickScan(AppState& state, const std::vector<ProcessInfo>& targets,
                 while (total_bytes_scanned < total_region_size) {
                     SIZE_T bytes_to_read = std::min(CHUNK_SIZE, total_region_size - total_bytes_scanned);
                     SIZE_T bytes_read = 0;
+                    state.resource_limits.read.Consume(bytes_to_read);
+                    throttle.Begin();
                     if (ReadProcessMemory(hProcess, current_base + total_bytes_scanned, buffer.data(), bytes_to_read, &bytes_read) && bytes_read > 0) {
                         std::string_view haystack_ascii(buffer.data(), bytes_read);
                         std::wstring_view haystack_wide((const wchar_t*)buffer.data(), bytes_read / sizeof(wchar_t));
 
                         std::vector<ScanResult> local_results;
-                        for (const auto& sig : signatures) {
+                        for (size_t sig_index = 0; sig_index < signatures.size(); ++sig_index) {
+                            const auto& sig = signatures[sig_index];
                             for (size_t pos = 0; (pos = haystack_ascii.find(sig.ascii_to_find, pos)) != std::string_view::npos; ++pos) {
                                 local_results.push_back({ sig.original + " (ASCII)", task.target.name, task.target.pid, (void*)(current_base + total_bytes_scanned + pos) });
+                                region_hits.push_back({ (uint64_t)(uintptr_t)local_results.back().address, (uint32_t)sig_index, 0 });
                             }
                             for (size_t pos = 0; (pos = haystack_wide.find(sig.wide_to_find, pos)) != std::wstring_view::npos; ++pos) {
                                 local_results.push_back({ sig.original + " (Unicode)", task.target.name, task.target.pid, (void*)(current_base + total_bytes_scanned + (pos * sizeof(wchar_t))) });
+                                region_hits.push_back({ (uint64_t)(uintptr_t)local_results.back().address, (uint32_t)sig_index, 1 });
                             }
                         }
 
@@ -331,12 +510,16 @@ void PerformQuickScan(AppState& state, const std::vector<ProcessInfo>& targets,
                             state.scan_result_queue.insert(state.scan_result_queue.end(), local_results.begin(), local_results.end());
                         }
                         total_bytes_scanned += bytes_read;
+                        throttle.End();
                     }
                     else {
+                        throttle.End();
                         break;
                     }
                 }
 
+                if (journaling) journal.Record(i, region_hits.data(), region_hits.size() * sizeof(JournalHit));
+
                 size_t scanned_count = regions_scanned.fetch_add(1) + 1;
                 float progress = static_cast<float>(scanned_count) / total_regions;
                 char msg[256];
@@ -351,52 +534,158 @@ void PerformQuickScan(AppState& state, const std::vector<ProcessInfo>& targets,
         th.join();
     }
 
-    progress_callback(1.0f, "Scan complete.");
+    if (journaling) journal.Remove();
+    if (resumed_regions > 0) {
+        progress_callback(1.0f, "Scan complete (resumed, " + std::to_string(resumed_regions) + " regions restored from checkpoint).");
+    }
+    else {
+        progress_callback(1.0f, "Scan complete.");
+    }
     state.scan_running = false;
 }
-std::pair<bool, std::string> CreateManualMemoryDump(DWORD processId, const std::string& output_path, bool optimize_dump, bool as_text, int dump_string_type, const std::string& filter_list_path, bool use_filter_list, bool filter_non_ascii, std::function<void(float, const std::string&)> progress_callback) {
+
+// Committed, accessible regions of a process: everything a dump reads.
+static std::vector<MEMORY_BASIC_INFORMATION> GetDumpRegions(HANDLE hProcess) {
+    std::vector<MEMORY_BASIC_INFORMATION> regions;
+    unsigned char* address = 0;
+    MEMORY_BASIC_INFORMATION mbi;
+    while (VirtualQueryEx(hProcess, address, &mbi, sizeof(mbi))) {
+        if (mbi.State == MEM_COMMIT && !(mbi.Protect & (PAGE_NOACCESS | PAGE_GUARD))) { regions.push_back(mbi); }
+        address += mbi.RegionSize;
+    }
+    return regions;
+}
+
+// Prepares the binary dump jobs of one process: a single job, or one per segment for segmented
+// dumps. The jobs only run once they are handed to RunDumpJobs.
+static bool PlanProcessDump(HANDLE hProcess, DWORD processId, const std::vector<MEMORY_BASIC_INFORMATION>& regions, const std::string& output_path, const DumpOptions& options,
+                            int worker_count, std::vector<std::unique_ptr<BinaryDumpJob>>& jobs, std::string& error) {
+    const bool segmented = options.segment_size > 0;
+    if (segmented && (options.container != DUMP_CONTAINER_SONAR || !options.base_dump_path.empty())) { error = "ERROR: Segmented dumps use the Sonar format and cannot be incremental."; return false; }
+    std::vector<std::vector<MEMORY_BASIC_INFORMATION>> parts;
+    if (segmented) { parts = SplitDumpSegments(regions, options.segment_size); }
+    else { parts.push_back(regions); }
+    DumpOptions job_options = options;
+    // Segments are always structured so each one carries its own region table.
+    if (segmented) { job_options.optimize = true; }
+    for (size_t i = 0; i < parts.size(); ++i) {
+        const std::string job_path = segmented ? DumpManifest::SegmentPath(output_path, i) : output_path;
+        jobs.push_back(std::make_unique<BinaryDumpJob>(hProcess, processId, std::move(parts[i]), job_path, job_options));
+        if (!jobs.back()->Prepare(worker_count, error)) return false;
+    }
+    return true;
+}
+
+// Finalizes a process's jobs once the pool is done and, for segmented dumps, writes the manifest
+// that ties the segments together at the output path.
+static bool FinishProcessDump(DWORD processId, const std::string& output_path, const DumpOptions& options, const std::vector<std::unique_ptr<BinaryDumpJob>>& jobs, std::string& error) {
+    DumpManifest::Manifest manifest;
+    manifest.process_id = processId;
+    uint64_t first_page = 0;
+    for (const auto& job : jobs) {
+        if (!job->Finish(error)) return false;
+        const auto& table = job->RegionTable();
+        DumpManifest::Segment segment;
+        segment.file_name = std::filesystem::path(job->OutputPath()).filename().string();
+        segment.first_address = table.empty() ? 0 : table.front().base_address;
+        segment.end_address = table.empty() ? 0 : table.back().base_address + table.back().size;
+        segment.first_page = first_page;
+        segment.page_count = job->Header().page_count;
+        segment.dump_id[0] = job->Header().dump_id[0];
+        segment.dump_id[1] = job->Header().dump_id[1];
+        first_page += segment.page_count;
+        manifest.segments.push_back(segment);
+    }
+    std::string manifest_error;
+    if (options.segment_size > 0 && !DumpManifest::Save(output_path, manifest, manifest_error)) { error = "ERROR: " + manifest_error; return false; }
+    return true;
+}
+
+std::pair<bool, std::string> CreateManualMemoryDump(DWORD processId, const std::string& output_path, const DumpOptions& options, std::function<void(float, const std::string&)> progress_callback) {
     HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, processId);
     if (hProcess == NULL) {
         if (GetLastError() == ERROR_ACCESS_DENIED) { return { false, "[ACCESS_DENIED]" }; }
         return { false, "ERROR: OpenProcess failed. Error code: " + std::to_string(GetLastError()) };
     }
     progress_callback(0.0f, "Enumerating memory regions...");
-    std::vector<MEMORY_BASIC_INFORMATION> regions_to_dump;
-    unsigned char* address = 0;
-    MEMORY_BASIC_INFORMATION mbi;
-    while (VirtualQueryEx(hProcess, address, &mbi, sizeof(mbi))) {
-        if (mbi.State == MEM_COMMIT && !(mbi.Protect & (PAGE_NOACCESS | PAGE_GUARD))) { regions_to_dump.push_back(mbi); }
-        address += mbi.RegionSize;
-    }
+    std::vector<MEMORY_BASIC_INFORMATION> regions_to_dump = GetDumpRegions(hProcess);
     if (regions_to_dump.empty()) { CloseHandle(hProcess); return { false, "ERROR: Could not find any commit-able memory regions in the process." }; }
     const int num_threads = std::thread::hardware_concurrency();
     std::vector<std::thread> threads;
     std::atomic<size_t> total_bytes_written = 0;
     std::atomic<size_t> total_bytes_scanned_val = 0;
-    if (as_text) {
-        std::unordered_set<std::string> filters;
-        if (use_filter_list) {
-            std::ifstream filter_file(filter_list_path);
+    std::atomic<size_t> total_bytes_elided_val = 0;
+    size_t total_bytes_from_base_val = 0;
+    size_t segment_count = 0;
+    size_t resumed_chunks = 0;
+    size_t sort_run_count = 0;
+    if (options.as_text) {
+        // The filter list is compiled once into a case-folded automaton; workers drop any string that
+        // contains a filter before it reaches their set, in one pass over the string.
+        std::unique_ptr<AhoCorasick::ByteMatcher> filter;
+        if (options.use_filter_list) {
+            std::ifstream filter_file(options.filter_list_path);
             if (filter_file.is_open()) {
+                AhoCorasick::Trie<char, true> filter_trie;
+                size_t filter_count = 0;
                 std::string line;
                 while (std::getline(filter_file, line)) {
-                    if (!line.empty()) {
-                        std::transform(line.begin(), line.end(), line.begin(), [](unsigned char c) { return std::tolower(c); });
-                        filters.insert(line);
-                    }
+                    if (!line.empty() && line.back() == '\r') line.pop_back();
+                    if (!line.empty()) filter_trie.insert(line, filter_count++);
+                }
+                if (filter_count > 0) {
+                    filter_trie.build_failure_links();
+                    filter = std::make_unique<AhoCorasick::ByteMatcher>(filter_trie);
                 }
             }
         }
-        std::vector<std::unordered_set<std::string>> thread_local_sets(num_threads);
+        // Provenance: every string carries its occurrence count, encodings and lowest addresses in its
+        // set payload; duplicates are folded together when the sets are merged.
+        const size_t provenance_addresses = options.provenance_addresses;
+        if (provenance_addresses > 0 && options.text_memory_budget > 0) { CloseHandle(hProcess); return { false, "ERROR: Provenance records need the in-memory text dump; turn off sorted output." }; }
+        const size_t payload_size = provenance_addresses > 0 ? Provenance::PayloadSize(provenance_addresses) : 0;
+        std::vector<StringInternSet> thread_local_sets;
+        for (int t = 0; t < num_threads; ++t) thread_local_sets.emplace_back(payload_size);
+        // Sorted mode: a worker whose set outgrows its share of the memory budget spills it as a sorted
+        // run, and the runs are merged into one sorted file at the end.
+        const bool sorted_output = options.text_memory_budget > 0;
+        std::unique_ptr<SortedStringRuns> sorted_runs;
+        if (sorted_output) sorted_runs = std::make_unique<SortedStringRuns>(output_path + ".sort", options.limits ? &options.limits->write : nullptr);
+        const size_t MIN_WORKER_BUDGET = 16 * 1024 * 1024;
+        const size_t worker_budget = sorted_output ? std::max<size_t>((size_t)(options.text_memory_budget / num_threads), MIN_WORKER_BUDGET) : 0;
+        std::atomic<bool> spill_failed = false;
+        std::mutex spill_mutex;
+        std::string spill_error;
+        auto spill = [&](int t) {
+            std::vector<std::string_view> strings;
+            strings.reserve(thread_local_sets[t].Size());
+            thread_local_sets[t].ForEach([&](std::string_view text) { strings.push_back(text); });
+            std::string run_error;
+            if (!sorted_runs->AddRun(strings, run_error)) {
+                std::lock_guard<std::mutex> lock(spill_mutex);
+                if (!spill_failed.exchange(true)) spill_error = run_error;
+            }
+            thread_local_sets[t] = StringInternSet();
+        };
         std::atomic<size_t> regions_processed = 0;
         const size_t total_regions = regions_to_dump.size();
         const int progress_update_interval = std::max(1, (int)total_regions / 100);
-        bool do_ascii_pass = (dump_string_type == 0 || dump_string_type == 2);
-        bool do_unicode_pass = (dump_string_type == 1 || dump_string_type == 2);
+        // Every enabled encoding is extracted in one pass over each buffer.
+        StringScan::ExtractSettings extract_settings;
+        extract_settings.encodings = options.extra_encodings;
+        if (options.string_type == 0 || options.string_type == 2) extract_settings.encodings |= StringScan::ENCODING_ASCII;
+        if (options.string_type == 1 || options.string_type == 2) extract_settings.encodings |= StringScan::ENCODING_UTF16LE;
+        for (size_t e = 0; e < StringScan::kEncodingCount; ++e) extract_settings.min_length[e] = (size_t)std::max(options.min_string_length[e], 1);
         for (int t = 0; t < num_threads; ++t) {
             threads.emplace_back([&, t]() {
                 const size_t BUFFER_SIZE = 65536;
                 std::vector<char> buffer(BUFFER_SIZE);
+                StringArena transcode_arena;   // UTF-8 of the current buffer's transcoded strings.
+                auto add_string = [&](std::string_view text, uint8_t encoding, const char* address) {
+                    if (payload_size == 0) { thread_local_sets[t].Insert(text); return; }
+                    Provenance::AddOccurrence(thread_local_sets[t].InsertWithPayload(text).first, provenance_addresses, encoding, (uint64_t)(uintptr_t)address);
+                };
+                WorkerThrottle throttle(options.limits);
                 for (size_t i = t; i < regions_to_dump.size(); i += num_threads) {
                     const auto& region = regions_to_dump[i];
                     char* base = (char*)region.BaseAddress;
@@ -405,118 +694,257 @@ std::pair<bool, std::string> CreateManualMemoryDump(DWORD processId, const std::
                     while (current < end) {
                         SIZE_T bytes_to_read = std::min(BUFFER_SIZE, (SIZE_T)(end - current));
                         SIZE_T bytes_read = 0;
-                        if (!ReadProcessMemory(hProcess, current, buffer.data(), bytes_to_read, &bytes_read) || bytes_read == 0) { break; }
-                        if (do_ascii_pass) {
-                            const char* buf_ptr = buffer.data();
-                            const char* buf_end = buf_ptr + bytes_read;
-                            while (buf_ptr < buf_end) {
-                                if (isprint(static_cast<unsigned char>(*buf_ptr))) {
-                                    const char* start = buf_ptr;
-                                    while (buf_ptr < buf_end && isprint(static_cast<unsigned char>(*buf_ptr))) { buf_ptr++; }
-                                    if (buf_ptr - start >= 4) { thread_local_sets[t].insert(std::string(start, buf_ptr - start)); }
-                                }
-                                else { buf_ptr++; }
-                            }
-                        }
-                        if (do_unicode_pass) {
-                            const wchar_t* wbuf_ptr = reinterpret_cast<const wchar_t*>(buffer.data());
-                            const wchar_t* wbuf_end = wbuf_ptr + (bytes_read / sizeof(wchar_t));
-                            while (wbuf_ptr < wbuf_end) {
-                                if (iswprint(*wbuf_ptr)) {
-                                    const wchar_t* start = wbuf_ptr;
-                                    while (wbuf_ptr < wbuf_end && iswprint(*wbuf_ptr)) { wbuf_ptr++; }
-                                    if (wbuf_ptr - start >= 4) {
-                                        std::wstring wide_str(start, wbuf_ptr - start);
-                                        bool is_valid = true;
-                                        if (filter_non_ascii) {
-                                            for (wchar_t wc : wide_str) { if (wc < 0 || wc > 127) { is_valid = false; break; } }
-                                        }
-                                        if (is_valid) { thread_local_sets[t].insert(WideStringToString(wide_str.c_str())); }
-                                    }
-                                }
-                                else { wbuf_ptr++; }
-                            }
-                        }
+                        if (options.limits) options.limits->read.Consume(bytes_to_read);
+                        throttle.Begin();
+                        if (!ReadProcessMemory(hProcess, current, buffer.data(), bytes_to_read, &bytes_read) || bytes_read == 0) { throttle.End(); break; }
+                        transcode_arena.Clear();
+                        StringScan::ExtractStrings(buffer.data(), bytes_read, extract_settings, transcode_arena, [&](std::string_view text, StringScan::Encoding encoding, size_t offset) {
+                            // The non-ASCII filter is for wide strings; UTF-8 and Latin-1 are asked for by name.
+                            if (options.filter_non_ascii && (encoding & (StringScan::ENCODING_UTF16LE | StringScan::ENCODING_UTF16BE)) &&
+                                std::any_of(text.begin(), text.end(), [](char c) { return (unsigned char)c >= 0x80; })) return;
+                            if (filter && filter->contains_any(text.data(), text.size())) return;
+                            add_string(text, encoding, current + offset);
+                            });
                         current += bytes_read;
+                        throttle.End();
+                        if (sorted_output && thread_local_sets[t].MemoryUsage() > worker_budget) spill(t);
                     }
                     size_t processed = regions_processed.fetch_add(1) + 1;
                     if (processed % progress_update_interval == 0) {
                         char msg[128]; snprintf(msg, sizeof(msg), "Scanning... %zu / %zu regions", processed, total_regions);
                         progress_callback(static_cast<float>(processed) / total_regions, msg);
                     }
+                    if (spill_failed) break;
                 }
+                if (sorted_output && !spill_failed) spill(t);
                 });
         }
         for (auto& th : threads) th.join();
-        progress_callback(0.95f, "Merging and filtering results...");
-        std::unordered_set<std::string> final_strings;
-        for (const auto& local_set : thread_local_sets) { final_strings.insert(local_set.begin(), local_set.end()); }
-        if (use_filter_list && !filters.empty()) {
-            std::vector<std::string> strings_to_remove;
-            for (const auto& found_str : final_strings) {
-                std::string lower_found_str = found_str;
-                std::transform(lower_found_str.begin(), lower_found_str.end(), lower_found_str.begin(), [](unsigned char c) { return std::tolower(c); });
-                for (const auto& filter_str : filters) {
-                    if (lower_found_str.find(filter_str) != std::string::npos) {
-                        strings_to_remove.push_back(found_str);
-                        break;
+        StringInternSet merged_strings;
+        std::vector<std::string_view> final_strings;
+        if (!sorted_output) {
+            progress_callback(0.95f, "Merging results...");
+            // The merged set takes over the workers' arenas, so the strings are not copied again.
+            if (payload_size > 0) merged_strings = StringInternSet::Merge(thread_local_sets, num_threads, [&](char* kept, const char* duplicate) { Provenance::MergePayload(kept, duplicate, provenance_addresses); });
+            else merged_strings = StringInternSet::Merge(thread_local_sets, num_threads);
+            final_strings.reserve(merged_strings.Size());
+            merged_strings.ForEach([&](std::string_view text) { final_strings.push_back(text); });
+            progress_callback(0.99f, "Writing unique strings to file...");
+        }
+        if (sorted_output) {
+            if (spill_failed) { CloseHandle(hProcess); return { false, "ERROR: " + spill_error }; }
+            sort_run_count = sorted_runs->RunCount();
+            char msg[128]; snprintf(msg, sizeof(msg), "Merging %zu sorted runs...", sort_run_count);
+            progress_callback(0.95f, msg);
+            uint64_t bytes_written = 0;
+            std::string merge_error;
+            if (!sorted_runs->Merge(output_path, options.compress, options.front_coded, num_threads, bytes_written, merge_error)) { CloseHandle(hProcess); return { false, "ERROR: " + merge_error }; }
+            total_bytes_written = (size_t)bytes_written;
+        }
+        else if (options.front_coded) {
+            std::sort(final_strings.begin(), final_strings.end());
+            FrontCoded::Writer writer;
+            std::string file_error;
+            if (!writer.Open(output_path, file_error)) { CloseHandle(hProcess); return { false, "ERROR: " + file_error }; }
+            if (options.limits) writer.SetWriteLimit(&options.limits->write);
+            for (const auto& s : final_strings) {
+                if (!writer.Add(s)) { CloseHandle(hProcess); return { false, "ERROR: Failed while writing output file: " + output_path }; }
+            }
+            if (!writer.Finish(file_error)) { CloseHandle(hProcess); return { false, "ERROR: " + file_error }; }
+            total_bytes_written = (size_t)writer.BytesWritten();
+        }
+        else if (options.compress) {
+            // The text stream is cut into fixed-size frames; each worker fills and compresses whole frames.
+            std::vector<uint64_t> line_offsets;
+            line_offsets.reserve(final_strings.size() + 1);
+            uint64_t text_size = 0;
+            for (const auto& s : final_strings) { line_offsets.push_back(text_size); text_size += s.size() + 1; }
+            line_offsets.push_back(text_size);
+            const size_t frame_count = (size_t)((text_size + DumpFormat::kFrameSize - 1) / DumpFormat::kFrameSize);
+            FrameWriter frame_out;
+            std::string file_error;
+            if (!frame_out.Open(output_path, file_error)) { CloseHandle(hProcess); return { false, "ERROR: Failed to create final output file: " + file_error }; }
+            if (options.limits) frame_out.SetWriteLimit(&options.limits->write);
+            std::atomic<size_t> next_frame = 0;
+            std::atomic<bool> write_failed = false;
+            threads.clear();
+            for (int t = 0; t < num_threads; ++t) {
+                threads.emplace_back([&]() {
+                    std::vector<char> frame;
+                    for (size_t f = next_frame++; f < frame_count && !write_failed; f = next_frame++) {
+                        const uint64_t begin = (uint64_t)f * DumpFormat::kFrameSize;
+                        const uint64_t end = std::min<uint64_t>(begin + DumpFormat::kFrameSize, text_size);
+                        frame.clear();
+                        // Find the line containing `begin`, then copy lines (and their newlines) until the frame is full.
+                        size_t line = (size_t)(std::upper_bound(line_offsets.begin(), line_offsets.end(), begin) - line_offsets.begin()) - 1;
+                        for (uint64_t pos = begin; pos < end; ++line) {
+                            const std::string_view str = final_strings[line];
+                            const size_t from = (size_t)(pos - line_offsets[line]);
+                            const size_t take = (size_t)std::min<uint64_t>(str.size() + 1 - from, end - pos);
+                            const size_t text_take = std::min(take, str.size() > from ? str.size() - from : 0);
+                            frame.insert(frame.end(), str.data() + from, str.data() + from + text_take);
+                            if (take > text_take) frame.push_back('\n');
+                            pos += take;
+                        }
+                        if (!frame_out.WriteFrame(begin, frame.data(), frame.size())) write_failed = true;
                     }
-                }
+                    });
             }
-            for (const auto& str_to_remove : strings_to_remove) { final_strings.erase(str_to_remove); }
+            for (auto& th : threads) th.join();
+            if (!frame_out.Finish(text_size) || write_failed) { CloseHandle(hProcess); return { false, "ERROR: Failed while writing output file: " + output_path }; }
+            total_bytes_written = frame_out.BytesWritten();
+        }
+        else {
+            std::ofstream out_file(output_path, std::ios::out);
+            if (!out_file.is_open()) { CloseHandle(hProcess); return { false, "ERROR: Failed to create final output file." }; }
+            // Writes are charged to the write limit in batches rather than per string.
+            const size_t WRITE_BATCH = 1024 * 1024;
+            size_t unbilled = 0;
+            for (const auto& s : final_strings) {
+                out_file << s << '\n';
+                unbilled += s.size() + 1;
+                if (options.limits && unbilled >= WRITE_BATCH) { options.limits->write.Consume(unbilled); unbilled = 0; }
+            }
+            if (options.limits) options.limits->write.Consume(unbilled);
+            total_bytes_written = out_file.tellp();
+            out_file.close();
+        }
+        if (payload_size > 0) {
+            progress_callback(0.995f, "Writing provenance sidecar...");
+            Provenance::Writer provenance_writer(provenance_addresses);
+            merged_strings.ForEachWithPayload([&](std::string_view text, const char* payload) { provenance_writer.Add(StringInternSet::Hash(text), payload); });
+            std::string provenance_error;
+            if (!provenance_writer.Save(output_path, provenance_error)) { CloseHandle(hProcess); return { false, "ERROR: " + provenance_error }; }
         }
-        progress_callback(0.99f, "Writing unique strings to file...");
-        std::ofstream out_file(output_path, std::ios::out);
-        if (!out_file.is_open()) { CloseHandle(hProcess); return { false, "ERROR: Failed to create final output file." }; }
-        for (const auto& s : final_strings) { out_file << s << '\n'; }
-        total_bytes_written = out_file.tellp();
-        out_file.close();
     }
     else {
-        std::ofstream out_file(output_path, std::ios::out | std::ios::binary);
-        if (!out_file.is_open()) { CloseHandle(hProcess); return { false, "ERROR: Failed to create output file: " + output_path }; }
-        std::mutex file_mutex;
-        std::unordered_set<size_t> written_hashes;
-        for (int t = 0; t < num_threads; ++t) {
-            threads.emplace_back([&, t]() {
-                const size_t CHUNK_SIZE = 65536;
-                std::vector<char> buffer(CHUNK_SIZE);
-                for (size_t i = t; i < regions_to_dump.size(); i += num_threads) {
-                    const auto& region = regions_to_dump[i];
-                    char* current = (char*)region.BaseAddress;
-                    char* end = current + region.RegionSize;
-                    while (current < end) {
-                        SIZE_T bytes_to_read = std::min(CHUNK_SIZE, (size_t)(end - current));
-                        SIZE_T bytes_read = 0;
-                        if (ReadProcessMemory(hProcess, current, buffer.data(), bytes_to_read, &bytes_read) && bytes_read > 0) {
-                            total_bytes_scanned_val += bytes_read;
-                            bool should_write = true;
-                            if (optimize_dump) {
-                                size_t page_hash = std::hash<std::string_view>{}(std::string_view(buffer.data(), bytes_read));
-                                std::lock_guard<std::mutex> lock(file_mutex);
-                                if (written_hashes.find(page_hash) != written_hashes.end()) { should_write = false; }
-                                else { written_hashes.insert(page_hash); }
-                            }
-                            if (should_write) {
-                                std::lock_guard<std::mutex> lock(file_mutex);
-                                out_file.write(buffer.data(), bytes_read);
-                                total_bytes_written += bytes_read;
-                            }
-                            current += bytes_read;
-                        }
-                        else { break; }
-                    }
-                }
-                });
+        std::vector<std::unique_ptr<BinaryDumpJob>> jobs;
+        std::string dump_error;
+        if (!PlanProcessDump(hProcess, processId, regions_to_dump, output_path, options, num_threads, jobs, dump_error)) { CloseHandle(hProcess); return { false, dump_error }; }
+        std::vector<BinaryDumpJob*> job_list;
+        for (const auto& job : jobs) job_list.push_back(job.get());
+        RunDumpJobs(job_list, num_threads, options.limits, [&](uint64_t bytes_done, uint64_t bytes_total) {
+            char msg[128]; snprintf(msg, sizeof(msg), "Dumping... %.0f / %.0f MB", bytes_done / (1024.0 * 1024.0), bytes_total / (1024.0 * 1024.0));
+            progress_callback(bytes_total ? static_cast<float>((double)bytes_done / bytes_total) : 1.0f, msg);
+            });
+        if (!FinishProcessDump(processId, output_path, options, jobs, dump_error)) { CloseHandle(hProcess); return { false, dump_error }; }
+        segment_count = jobs.size();
+        for (const auto& job : jobs) {
+            total_bytes_written += job->BytesWritten();
+            total_bytes_scanned_val += job->BytesScanned();
+            total_bytes_elided_val += job->BytesElided();
+            total_bytes_from_base_val += job->BytesFromBase();
+            resumed_chunks += job->ResumedChunks();
         }
-        for (auto& th : threads) th.join();
-        out_file.close();
     }
     CloseHandle(hProcess);
     char final_log[256];
-    if (as_text) { snprintf(final_log, sizeof(final_log), "SUCCESS: Text dump complete. Wrote %.2f MB of unique, filtered strings.", total_bytes_written / (1024.0 * 1024.0)); }
-    else if (optimize_dump) { snprintf(final_log, sizeof(final_log), "SUCCESS: Optimized dump complete. Wrote %.2f MB (from %.2f MB).", total_bytes_written / (1024.0 * 1024.0), total_bytes_scanned_val / (1024.0 * 1024.0)); }
-    else { snprintf(final_log, sizeof(final_log), "SUCCESS: Dump complete. Wrote %.2f MB.", total_bytes_written / (1024.0 * 1024.0)); }
+    if (options.as_text && options.text_memory_budget > 0) { snprintf(final_log, sizeof(final_log), "SUCCESS: Sorted text dump complete. Wrote %.2f MB of unique, filtered strings merged from %zu runs.", total_bytes_written / (1024.0 * 1024.0), sort_run_count); }
+    else if (options.as_text) { snprintf(final_log, sizeof(final_log), "SUCCESS: Text dump complete. Wrote %.2f MB of unique, filtered strings.", total_bytes_written / (1024.0 * 1024.0)); }
+    else if (options.segment_size > 0) { snprintf(final_log, sizeof(final_log), "SUCCESS: Segmented dump complete. Wrote %.2f MB in %zu segments (from %.2f MB, %.2f MB constant pages elided).", total_bytes_written / (1024.0 * 1024.0), segment_count, total_bytes_scanned_val / (1024.0 * 1024.0), total_bytes_elided_val / (1024.0 * 1024.0)); }
+    else if (!options.base_dump_path.empty()) { snprintf(final_log, sizeof(final_log), "SUCCESS: Incremental dump complete. Wrote %.2f MB; %.2f MB unchanged since the base dump.", total_bytes_written / (1024.0 * 1024.0), total_bytes_from_base_val / (1024.0 * 1024.0)); }
+    else if (options.compress) { snprintf(final_log, sizeof(final_log), "SUCCESS: Compressed dump complete. Wrote %.2f MB (from %.2f MB, %.2f MB constant pages elided).", total_bytes_written / (1024.0 * 1024.0), total_bytes_scanned_val / (1024.0 * 1024.0), total_bytes_elided_val / (1024.0 * 1024.0)); }
+    else if (options.optimize) { snprintf(final_log, sizeof(final_log), "SUCCESS: Optimized dump complete. Wrote %.2f MB (from %.2f MB, %.2f MB constant pages elided).", total_bytes_written / (1024.0 * 1024.0), total_bytes_scanned_val / (1024.0 * 1024.0), total_bytes_elided_val / (1024.0 * 1024.0)); }
+    else if (options.container != DUMP_CONTAINER_SONAR) { snprintf(final_log, sizeof(final_log), "SUCCESS: %s dump complete. Wrote %.2f MB (%.2f MB of zero pages left as holes).", options.container == DUMP_CONTAINER_ELF_CORE ? "ELF core" : "Minidump", total_bytes_written / (1024.0 * 1024.0), total_bytes_elided_val / (1024.0 * 1024.0)); }
+    else { snprintf(final_log, sizeof(final_log), "SUCCESS: Dump complete. Wrote %.2f MB (%.2f MB of zero pages left as holes).", total_bytes_written / (1024.0 * 1024.0), total_bytes_elided_val / (1024.0 * 1024.0)); }
+    std::string result = final_log;
+    if (options.as_text && options.front_coded) result += " Strings are front-coded, sorted and block-indexed.";
+    if (options.as_text && options.provenance_addresses > 0) result += " Provenance sidecar written to " + Provenance::SidecarPath(output_path) + ".";
+    if (resumed_chunks > 0) result += " Resumed from checkpoint: " + std::to_string(resumed_chunks) + " chunks were already done.";
     progress_callback(1.0f, "Done!");
-    return { true, std::string(final_log) };
-}
\ No newline at end of file
+    return { true, result };
+}
+
+// Batch output file for one process: "sweep.bin" becomes "sweep_notepad.exe_1234.bin".
+static std::string BatchDumpPath(const std::string& output_path, const std::string& process_name, DWORD processId) {
+    std::filesystem::path path(output_path);
+    return (path.parent_path() / (path.stem().string() + "_" + process_name + "_" + std::to_string(processId) + path.extension().string())).string();
+}
+
+static std::string GetDumpProcessName(HANDLE hProcess) {
+    char process_name[MAX_PATH] = {};
+    if (hProcess && GetModuleBaseNameA(hProcess, NULL, process_name, MAX_PATH)) return process_name;
+    return "process";
+}
+
+std::pair<bool, std::string> CreateBatchMemoryDump(const std::vector<DWORD>& process_ids, const std::string& output_path, const DumpOptions& options, std::function<void(float, const std::string&)> progress_callback) {
+    if (process_ids.empty()) return { false, "ERROR: No processes selected." };
+    std::vector<std::string> failures;
+    size_t dumped = 0;
+    uint64_t total_bytes_written = 0;
+    auto describe_failure = [](const std::string& name, DWORD pid, const std::string& message) {
+        return name + " (" + std::to_string(pid) + "): " + (message == "[ACCESS_DENIED]" ? std::string("access denied") : message);
+    };
+    if (options.as_text) {
+        // A text dump already spreads one process over every core, so text batches run one process at a time.
+        for (size_t i = 0; i < process_ids.size(); ++i) {
+            HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, process_ids[i]);
+            const std::string name = GetDumpProcessName(hProcess);
+            if (hProcess) CloseHandle(hProcess);
+            const std::string path = BatchDumpPath(output_path, name, process_ids[i]);
+            auto [success, message] = CreateManualMemoryDump(process_ids[i], path, options, [&](float p, const std::string& m) {
+                progress_callback((i + p) / process_ids.size(), "[" + std::to_string(i + 1) + "/" + std::to_string(process_ids.size()) + "] " + m);
+                });
+            if (success) ++dumped;
+            else failures.push_back(describe_failure(name, process_ids[i], message));
+        }
+    }
+    else {
+        // Every process's chunks go into one queue served by one pool, so the batch is balanced by
+        // bytes across all processes instead of running each dump on its own set of threads.
+        struct Target {
+            DWORD pid;
+            std::string name;
+            std::string path;
+            HANDLE handle;
+            std::vector<std::unique_ptr<BinaryDumpJob>> jobs;
+        };
+        const int num_threads = std::thread::hardware_concurrency();
+        std::vector<Target> targets;
+        std::vector<BinaryDumpJob*> job_list;
+        for (size_t i = 0; i < process_ids.size(); ++i) {
+            const DWORD pid = process_ids[i];
+            char msg[128]; snprintf(msg, sizeof(msg), "Preparing %zu / %zu processes...", i + 1, process_ids.size());
+            progress_callback(0.0f, msg);
+            HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, pid);
+            if (hProcess == NULL) {
+                failures.push_back(describe_failure("process", pid, GetLastError() == ERROR_ACCESS_DENIED ? "[ACCESS_DENIED]" : "OpenProcess failed with error " + std::to_string(GetLastError())));
+                continue;
+            }
+            Target target = { pid, GetDumpProcessName(hProcess), "", hProcess, {} };
+            target.path = BatchDumpPath(output_path, target.name, pid);
+            std::string plan_error;
+            const std::vector<MEMORY_BASIC_INFORMATION> regions = GetDumpRegions(hProcess);
+            if (regions.empty()) plan_error = "no committed memory regions";
+            else if (PlanProcessDump(hProcess, pid, regions, target.path, options, num_threads, target.jobs, plan_error)) {
+                for (const auto& job : target.jobs) job_list.push_back(job.get());
+                targets.push_back(std::move(target));
+                continue;
+            }
+            failures.push_back(describe_failure(target.name, pid, plan_error));
+            target.jobs.clear();
+            CloseHandle(hProcess);
+        }
+        RunDumpJobs(job_list, num_threads, options.limits, [&](uint64_t bytes_done, uint64_t bytes_total) {
+            char msg[128]; snprintf(msg, sizeof(msg), "Dumping %zu processes... %.0f / %.0f MB", targets.size(), bytes_done / (1024.0 * 1024.0), bytes_total / (1024.0 * 1024.0));
+            progress_callback(bytes_total ? static_cast<float>((double)bytes_done / bytes_total) : 1.0f, msg);
+            });
+        for (auto& target : targets) {
+            std::string finish_error;
+            if (FinishProcessDump(target.pid, target.path, options, target.jobs, finish_error)) {
+                ++dumped;
+                for (const auto& job : target.jobs) total_bytes_written += job->BytesWritten();
+            }
+            else { failures.push_back(describe_failure(target.name, target.pid, finish_error)); }
+            target.jobs.clear();
+            CloseHandle(target.handle);
+        }
+    }
+    progress_callback(1.0f, "Done!");
+    char summary[256];
+    if (options.as_text) { snprintf(summary, sizeof(summary), "Batch dump complete. Dumped %zu of %zu processes.", dumped, process_ids.size()); }
+    else { snprintf(summary, sizeof(summary), "Batch dump complete. Dumped %zu of %zu processes, wrote %.2f MB.", dumped, process_ids.size(), total_bytes_written / (1024.0 * 1024.0)); }
+    std::string message = (dumped > 0 ? "SUCCESS: " : "ERROR: ") + std::string(summary);
+    for (const auto& failure : failures) message += "\n  Failed: " + failure;
+    return { dumped > 0, message };
+}
@@ -5,9 +5,11 @@
 #include <windows.h>
 #include <utility>
 #include <functional>
+#include "binary_diff.h"
 
 // Forward-declare AppState to avoid circular dependency
 struct AppState;
+struct ResourceLimits;
 
 // Struct to hold a single scan result
 struct ScanResult {
@@ -42,34 +44,71 @@ struct PEInfo {
 
 // Structs for the Differential Analyzer
 struct ModifiedRegion {
-    uint64_t offset;
-    size_t size;
-    size_t clean_hash;
-    size_t dirty_hash;
+    uint64_t offset;                // First differing byte in the flat image.
+    uint64_t size;                  // Up to and including the last differing byte.
+    uint64_t changed_bytes;         // Differing bytes within the range.
+    BinaryDiff::ChangeKind kind = BinaryDiff::CHANGE_MODIFIED;
+    bool has_address = false;       // Address-aware diffs only.
+    uint64_t address = 0;
+    uint64_t clean_size = 0;        // Resized regions: the size in the clean dump.
+    uint64_t clean_offset = 0;      // Moved content: its offset in the clean dump.
 };
 
 struct DiffResult {
-    std::vector<std::string> new_strings;
+    std::vector<std::string> new_strings;       // Only in the dirty dump, sorted.
+    std::vector<std::string> removed_strings;   // Only in the clean dump, sorted.
+    uint64_t common_string_count = 0;           // Unique strings in both dumps.
     std::vector<ModifiedRegion> modified_regions;
     std::string error;
 };
 
+// Options for the Memory Dumper
+// Container for binary dumps. Sonar dumps support optimization and compression; the others are
+// standard formats written as plain images for external tools.
+enum DumpContainer { DUMP_CONTAINER_SONAR = 0, DUMP_CONTAINER_ELF_CORE = 1, DUMP_CONTAINER_MINIDUMP = 2 };
+
+struct DumpOptions {
+    bool optimize = true;           // Binary: structured, page-deduplicated dump.
+    bool as_text = false;           // Dump extracted strings instead of raw memory.
+    int string_type = 2;            // Text: 0 = ASCII, 1 = Unicode (UTF-16LE), 2 = both.
+    unsigned extra_encodings = 0;   // Text: further StringScan::Encoding bits to extract (UTF-8, UTF-16BE, Latin-1).
+    int min_string_length[5] = { 4, 4, 4, 4, 4 }; // Text: minimum characters per encoding, indexed by StringScan::EncodingIndex().
+    std::string filter_list_path;
+    bool use_filter_list = false;
+    bool filter_non_ascii = true;
+    bool compress = false;          // Wrap the output in independently compressed frames.
+    std::string base_dump_path;     // Optimized only: store just the pages changed since this earlier dump.
+    DumpContainer container = DUMP_CONTAINER_SONAR;
+    uint64_t segment_size = 0;      // Binary: split into numbered segment files of at most this many bytes (0 = one file).
+    ResourceLimits* limits = nullptr; // Optional read/write/CPU limits; may be changed while the dump runs.
+    bool checkpoint = false;        // Binary, uncompressed: keep a journal so an interrupted dump resumes where it stopped.
+    uint64_t text_memory_budget = 0; // Text: spill sorted runs to disk above this many bytes and write sorted output (0 = in memory).
+    bool front_coded = false;       // Text: write a sorted, front-coded dump with a block index (front_coded.h) instead of lines; not compressed.
+    uint32_t provenance_addresses = 0; // Text, in memory: write a provenance sidecar keeping up to this many addresses per string (0 = none).
+};
+
 // --- Function Declarations ---
 void InitializeAppState(AppState& state);
 std::vector<ProcessInfo> GetProcessList();
 void PerformQuickScan(AppState& state, const std::vector<ProcessInfo>& targets, const std::string& signatures_str, bool case_insensitive, std::function<void(float, const std::string&)> progress_callback);
 PEInfo InspectPEFile(const std::string& file_path);
-DiffResult PerformDifferentialAnalysis(const std::string& clean_path, const std::string& dirty_path, std::function<void(float)> progress_callback);
+// How binary dumps are lined up: by flat-image offset, by process address (structured dumps), or
+// by content-defined chunks that are matched wherever they sit.
+enum BinaryDiffMode { BINARY_DIFF_BY_OFFSET = 0, BINARY_DIFF_BY_ADDRESS = 1, BINARY_DIFF_BY_CONTENT = 2 };
+DiffResult PerformDifferentialAnalysis(const std::string& clean_path, const std::string& dirty_path, std::function<void(float)> progress_callback, BinaryDiffMode binary_mode = BINARY_DIFF_BY_OFFSET);
 std::pair<bool, std::string> ExportDiffResults(const DiffResult& result, const std::string& output_path);
 
 std::pair<bool, std::string> CreateManualMemoryDump(
     DWORD processId,
     const std::string& output_path,
-    bool optimize_dump,
-    bool as_text,
-    int dump_string_type,
-    const std::string& filter_list_path,
-    bool use_filter_list,
-    bool filter_non_ascii,
+    const DumpOptions& options,
+    std::function<void(float, const std::string&)> progress_callback
+);
+// Dumps several processes in one job, one output file per process named after the process and
+// its PID. Binary dumps of all processes share a single worker pool.
+std::pair<bool, std::string> CreateBatchMemoryDump(
+    const std::vector<DWORD>& process_ids,
+    const std::string& output_path,
+    const DumpOptions& options,
     std::function<void(float, const std::string&)> progress_callback
 );
\ No newline at end of file
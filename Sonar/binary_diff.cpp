@@ -0,0 +1,284 @@
+#include "binary_diff.h"
+#include "dump_format.h"
+#include "dump_reader.h"
+#include "string_scan.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace {
+    constexpr size_t kPageSize = DumpFormat::kPageSize;
+    constexpr size_t kChunkSize = 1024 * 1024;
+
+    // A changed page: absolute offsets of its first and last differing byte.
+    struct PageChange {
+        uint64_t page;
+        uint64_t first;
+        uint64_t last;
+        uint64_t count;
+    };
+
+    inline unsigned CountLeadingZeros(uint64_t value) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return 63 - (unsigned)index;
+#else
+        return (unsigned)__builtin_clzll(value);
+#endif
+    }
+    inline unsigned PopCount(uint64_t value) {
+#if defined(_MSC_VER)
+        return (unsigned)__popcnt64(value);
+#else
+        return (unsigned)__builtin_popcountll(value);
+#endif
+    }
+
+    // One bit per byte of a 64-byte block, set where the buffers differ.
+    inline uint64_t ScalarDiffMask(const char* a, const char* b, size_t size) {
+        uint64_t mask = 0;
+        for (size_t i = 0; i < size; ++i) mask |= (uint64_t)(a[i] != b[i]) << i;
+        return mask;
+    }
+
+#ifdef SONAR_STRING_SCAN_SSE2
+    inline bool EqualSse2(const char* a, const char* b, size_t blocks) {
+        for (size_t i = 0; i < blocks; ++i) {
+            const __m128i* pa = reinterpret_cast<const __m128i*>(a + i * 64);
+            const __m128i* pb = reinterpret_cast<const __m128i*>(b + i * 64);
+            __m128i x = _mm_or_si128(_mm_xor_si128(_mm_loadu_si128(pa), _mm_loadu_si128(pb)), _mm_xor_si128(_mm_loadu_si128(pa + 1), _mm_loadu_si128(pb + 1)));
+            x = _mm_or_si128(x, _mm_or_si128(_mm_xor_si128(_mm_loadu_si128(pa + 2), _mm_loadu_si128(pb + 2)), _mm_xor_si128(_mm_loadu_si128(pa + 3), _mm_loadu_si128(pb + 3))));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_setzero_si128())) != 0xFFFF) return false;
+        }
+        return true;
+    }
+    inline uint64_t DiffMaskSse2(const char* a, const char* b) {
+        uint64_t equal = 0;
+        for (int part = 0; part < 4; ++part) {
+            const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + part * 16));
+            const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + part * 16));
+            equal |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) << (part * 16);
+        }
+        return ~equal;
+    }
+    SONAR_TARGET_AVX2 inline bool EqualAvx2(const char* a, const char* b, size_t blocks) {
+        for (size_t i = 0; i < blocks; ++i) {
+            const __m256i* pa = reinterpret_cast<const __m256i*>(a + i * 64);
+            const __m256i* pb = reinterpret_cast<const __m256i*>(b + i * 64);
+            const __m256i x = _mm256_or_si256(_mm256_xor_si256(_mm256_loadu_si256(pa), _mm256_loadu_si256(pb)), _mm256_xor_si256(_mm256_loadu_si256(pa + 1), _mm256_loadu_si256(pb + 1)));
+            if (!_mm256_testz_si256(x, x)) return false;
+        }
+        return true;
+    }
+    SONAR_TARGET_AVX2 inline uint64_t DiffMaskAvx2(const char* a, const char* b) {
+        const __m256i low = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b)));
+        const __m256i high = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + 32)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 32)));
+        return ~((uint64_t)(uint32_t)_mm256_movemask_epi8(low) | ((uint64_t)(uint32_t)_mm256_movemask_epi8(high) << 32));
+    }
+#endif
+
+    bool BlocksEqual(const char* a, const char* b, size_t blocks) {
+#ifdef SONAR_STRING_SCAN_SSE2
+        if (StringScan::Detail::HasAvx2()) return EqualAvx2(a, b, blocks);
+        return EqualSse2(a, b, blocks);
+#else
+        return std::memcmp(a, b, blocks * 64) == 0;
+#endif
+    }
+    uint64_t DiffMask(const char* a, const char* b) {
+#ifdef SONAR_STRING_SCAN_SSE2
+        if (StringScan::Detail::HasAvx2()) return DiffMaskAvx2(a, b);
+        return DiffMaskSse2(a, b);
+#else
+        return ScalarDiffMask(a, b, 64);
+#endif
+    }
+}
+
+namespace BinaryDiff {
+
+    bool CompareBytes(const char* a, const char* b, size_t size, size_t& first, size_t& last, uint64_t& count) {
+        const size_t blocks = size / 64;
+        const size_t tail = size % 64;
+        // Most pages are unchanged; the cheap equality pass settles them.
+        if (BlocksEqual(a, b, blocks) && std::memcmp(a + blocks * 64, b + blocks * 64, tail) == 0) return false;
+        bool found = false;
+        uint64_t differing = 0;
+        auto note = [&](size_t base, uint64_t mask) {
+            if (!mask) return;
+            if (!found) first = base + StringScan::Detail::CountTrailingZeros(mask);
+            found = true;
+            last = base + 63 - CountLeadingZeros(mask);
+            differing += PopCount(mask);
+        };
+        for (size_t block = 0; block < blocks; ++block) note(block * 64, DiffMask(a + block * 64, b + block * 64));
+        note(blocks * 64, ScalarDiffMask(a + blocks * 64, b + blocks * 64, tail));
+        count = differing;
+        return true;
+    }
+
+    std::vector<std::vector<ChangedRange>> CompareSpans(const DumpReader& clean, const DumpReader& dirty, const std::vector<Span>& spans, int thread_count, const std::function<void(float)>& progress, const ChunkVisitor& visit) {
+        // Work items are (span, chunk) pairs, so one large span does not hold up the pool.
+        std::vector<std::pair<size_t, uint64_t>> chunks;
+        for (size_t s = 0; s < spans.size(); ++s) {
+            const uint64_t length = std::max(spans[s].clean_size, spans[s].dirty_size);
+            for (uint64_t start = 0; start < length; start += kChunkSize) chunks.emplace_back(s, start);
+        }
+        std::vector<std::vector<PageChange>> chunk_changes(chunks.size());
+        std::atomic<size_t> next_chunk = 0;
+        std::atomic<size_t> chunks_done = 0;
+        thread_count = std::max(1, thread_count);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&, t]() {
+                std::vector<char> clean_buffer(kChunkSize);
+                std::vector<char> dirty_buffer(kChunkSize);
+                for (size_t c = next_chunk++; c < chunks.size(); c = next_chunk++) {
+                    const Span& span = spans[chunks[c].first];
+                    const uint64_t start = chunks[c].second;
+                    auto read = [&](const DumpReader& reader, uint64_t offset, uint64_t size, std::vector<char>& buffer) {
+                        return start < size ? reader.Read(offset + start, buffer.data(), (size_t)std::min<uint64_t>(kChunkSize, size - start)) : 0;
+                    };
+                    const size_t clean_read = read(clean, span.clean_offset, span.clean_size, clean_buffer);
+                    const size_t dirty_read = read(dirty, span.dirty_offset, span.dirty_size, dirty_buffer);
+                    if (visit) visit(t, clean_buffer.data(), clean_read, dirty_buffer.data(), dirty_read);
+                    const size_t common = std::min(clean_read, dirty_read);
+                    for (size_t page_start = 0; page_start < common; page_start += kPageSize) {
+                        size_t first = 0, last = 0;
+                        uint64_t count = 0;
+                        if (CompareBytes(clean_buffer.data() + page_start, dirty_buffer.data() + page_start, std::min(kPageSize, common - page_start), first, last, count)) {
+                            chunk_changes[c].push_back({ (start + page_start) / kPageSize, start + page_start + first, start + page_start + last, count });
+                        }
+                    }
+                    if (progress) progress((float)(++chunks_done) / (float)chunks.size());
+                }
+                });
+        }
+        for (auto& th : threads) th.join();
+
+        std::vector<std::vector<ChangedRange>> ranges(spans.size());
+        uint64_t previous_page = 0;
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            std::vector<ChangedRange>& span_ranges = ranges[chunks[c].first];
+            for (const PageChange& change : chunk_changes[c]) {
+                if (!span_ranges.empty() && change.page == previous_page + 1) {
+                    span_ranges.back().size = change.last + 1 - span_ranges.back().offset;
+                    span_ranges.back().changed_bytes += change.count;
+                }
+                else span_ranges.push_back({ change.first, change.last + 1 - change.first, change.count });
+                previous_page = change.page;
+            }
+        }
+        return ranges;
+    }
+
+    std::vector<ChangedRange> ComparePages(const DumpReader& clean, const DumpReader& dirty, int thread_count, const std::function<void(float)>& progress, const ChunkVisitor& visit) {
+        Span image;
+        image.clean_size = clean.LogicalSize();
+        image.dirty_size = dirty.LogicalSize();
+        std::vector<ChangedRange> ranges = std::move(CompareSpans(clean, dirty, { image }, thread_count, progress, visit)[0]);
+        // The longer image's tail joins the last range when that range ends in the same or the previous page.
+        const uint64_t common = std::min(image.clean_size, image.dirty_size);
+        const uint64_t length = std::max(image.clean_size, image.dirty_size);
+        if (common == length) return ranges;
+        if (!ranges.empty() && common / kPageSize <= (ranges.back().offset + ranges.back().size - 1) / kPageSize + 1) {
+            ranges.back().size = length - ranges.back().offset;
+            ranges.back().changed_bytes += length - common;
+        }
+        else ranges.push_back({ common, length - common, length - common });
+        return ranges;
+    }
+
+    const char* ChangeKindName(ChangeKind kind) {
+        switch (kind) {
+        case CHANGE_MODIFIED: return "Modified";
+        case CHANGE_ADDED: return "Added";
+        case CHANGE_REMOVED: return "Removed";
+        case CHANGE_RESIZED: return "Resized";
+        case CHANGE_MOVED: return "Moved";
+        case CHANGE_INSERTED: return "Inserted";
+        case CHANGE_DELETED: return "Deleted";
+        }
+        return "Unknown";
+    }
+
+    std::vector<RegionChange> CompareRegions(const DumpReader& clean, const DumpReader& dirty, int thread_count, const std::function<void(float)>& progress, const ChunkVisitor& visit) {
+        auto by_address = [](const DumpReader& reader) {
+            std::vector<const DumpFormat::RegionEntry*> regions;
+            for (const auto& region : reader.Regions()) regions.push_back(&region);
+            std::sort(regions.begin(), regions.end(), [](const auto* a, const auto* b) { return a->base_address < b->base_address; });
+            return regions;
+        };
+        const std::vector<const DumpFormat::RegionEntry*> clean_regions = by_address(clean);
+        const std::vector<const DumpFormat::RegionEntry*> dirty_regions = by_address(dirty);
+        const uint64_t clean_page_size = clean.Header().page_size;
+        const uint64_t dirty_page_size = dirty.Header().page_size;
+
+        std::vector<RegionChange> changes;
+        std::vector<Span> spans;
+        std::vector<uint64_t> span_address;     // Address of each compared span, or UINT64_MAX.
+        // Both tables are walked in address order. `clean_at` and `dirty_at` are the first addresses of
+        // the current regions not yet accounted for; each step takes the piece up to where the other
+        // side starts or ends, so overlapping regions are compared over their intersection even when
+        // their bases differ, and only the addresses one side lacks are reported as added or removed.
+        size_t c = 0, d = 0;
+        uint64_t clean_at = clean_regions.empty() ? 0 : clean_regions[0]->base_address;
+        uint64_t dirty_at = dirty_regions.empty() ? 0 : dirty_regions[0]->base_address;
+        // A region already reported as resized needs no added or removed entry for its unmatched rest.
+        bool clean_resized = false, dirty_resized = false;
+        auto next_clean = [&]() { if (++c < clean_regions.size()) clean_at = clean_regions[c]->base_address; clean_resized = false; };
+        auto next_dirty = [&]() { if (++d < dirty_regions.size()) dirty_at = dirty_regions[d]->base_address; dirty_resized = false; };
+        while (c < clean_regions.size() || d < dirty_regions.size()) {
+            const DumpFormat::RegionEntry* clean_region = c < clean_regions.size() ? clean_regions[c] : nullptr;
+            const DumpFormat::RegionEntry* dirty_region = d < dirty_regions.size() ? dirty_regions[d] : nullptr;
+            const uint64_t clean_end = clean_region ? clean_region->base_address + clean_region->size : 0;
+            const uint64_t dirty_end = dirty_region ? dirty_region->base_address + dirty_region->size : 0;
+            if (clean_region && clean_at >= clean_end) { next_clean(); continue; }
+            if (dirty_region && dirty_at >= dirty_end) { next_dirty(); continue; }
+            Span span;
+            if (clean_region) span.clean_offset = clean_region->first_page * clean_page_size + (clean_at - clean_region->base_address);
+            if (dirty_region) span.dirty_offset = dirty_region->first_page * dirty_page_size + (dirty_at - dirty_region->base_address);
+            if (clean_region && dirty_region && clean_at == clean_region->base_address && dirty_at == dirty_region->base_address &&
+                clean_region->base_address == dirty_region->base_address && clean_region->size != dirty_region->size) {
+                const uint64_t delta = std::max(clean_region->size, dirty_region->size) - std::min(clean_region->size, dirty_region->size);
+                changes.push_back({ CHANGE_RESIZED, dirty_region->base_address, span.dirty_offset, dirty_region->size, clean_region->size, 0, delta });
+                clean_resized = dirty_resized = true;
+            }
+            if (clean_region && (!dirty_region || clean_at < dirty_at)) {
+                const uint64_t end = dirty_region ? std::min(clean_end, dirty_at) : clean_end;
+                if (!clean_resized) changes.push_back({ CHANGE_REMOVED, clean_at, span.clean_offset, end - clean_at, 0, 0, end - clean_at });
+                span.dirty_offset = 0;
+                span.clean_size = end - clean_at;
+                if (visit) { spans.push_back(span); span_address.push_back(UINT64_MAX); }
+                clean_at = end;
+            }
+            else if (dirty_region && (!clean_region || dirty_at < clean_at)) {
+                const uint64_t end = clean_region ? std::min(dirty_end, clean_at) : dirty_end;
+                if (!dirty_resized) changes.push_back({ CHANGE_ADDED, dirty_at, span.dirty_offset, end - dirty_at, 0, 0, end - dirty_at });
+                span.clean_offset = 0;
+                span.dirty_size = end - dirty_at;
+                if (visit) { spans.push_back(span); span_address.push_back(UINT64_MAX); }
+                dirty_at = end;
+            }
+            else {
+                const uint64_t end = std::min(clean_end, dirty_end);
+                span.clean_size = span.dirty_size = end - clean_at;
+                spans.push_back(span);
+                span_address.push_back(clean_at);
+                clean_at = dirty_at = end;
+            }
+        }
+
+        const std::vector<std::vector<ChangedRange>> ranges = CompareSpans(clean, dirty, spans, thread_count, progress, visit);
+        for (size_t s = 0; s < spans.size(); ++s) {
+            if (span_address[s] == UINT64_MAX) continue;
+            for (const ChangedRange& range : ranges[s]) {
+                changes.push_back({ CHANGE_MODIFIED, span_address[s] + range.offset, spans[s].dirty_offset + range.offset, range.size, 0, 0, range.changed_bytes });
+            }
+        }
+        std::sort(changes.begin(), changes.end(), [](const RegionChange& a, const RegionChange& b) { return a.address != b.address ? a.address < b.address : a.kind > b.kind; });
+        return changes;
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class DumpReader;
+
+// Page-granular comparison of two dump images. Workers take 1 MB chunks of both images from a
+// shared counter and compare them 4 KB page by page with a vectorized compare; only pages that
+// differ are scanned for their first, last and number of differing bytes. Runs of adjacent changed
+// pages are then joined into one range, trimmed to the first and last differing byte.
+//
+// The images can also be compared as a list of spans, pairs of stretches that should hold the same
+// content (a region at the same address in both dumps, say). Chunks of all spans share one pool.
+//
+// Structured dumps can be compared by address instead of by offset (CompareRegions): regions are
+// aligned by address, so a region that appears, disappears, changes size or is split differently
+// does not shift the comparison of every region after it.
+namespace BinaryDiff {
+
+    enum ChangeKind : uint8_t {
+        CHANGE_MODIFIED = 0,            // Content differs.
+        CHANGE_ADDED = 1,               // Addresses only in the dirty dump.
+        CHANGE_REMOVED = 2,             // Addresses only in the clean dump.
+        CHANGE_RESIZED = 3,             // Same base address, different size.
+        CHANGE_MOVED = 4,               // Content found at another offset in the clean dump.
+        CHANGE_INSERTED = 5,            // Content found nowhere in the clean dump.
+        CHANGE_DELETED = 6,             // Content found nowhere in the dirty dump.
+    };
+    const char* ChangeKindName(ChangeKind kind);
+
+    struct RegionChange {
+        ChangeKind kind = CHANGE_MODIFIED;
+        uint64_t address = 0;
+        uint64_t offset = 0;            // In the dirty image; in the clean image for removed and deleted content.
+        uint64_t size = 0;              // Bytes changed, added or removed; resized regions: the new size.
+        uint64_t clean_size = 0;        // Resized regions: the old size.
+        uint64_t clean_offset = 0;      // Moved content: its offset in the clean image.
+        uint64_t changed_bytes = 0;     // Modified: bytes that differ; otherwise bytes gained, lost or moved.
+    };
+
+    struct ChangedRange {
+        uint64_t offset = 0;            // First differing byte: in the flat image, or in the span.
+        uint64_t size = 0;              // Up to and including the last differing byte.
+        uint64_t changed_bytes = 0;     // Bytes that differ within the range.
+    };
+
+    // A stretch of each image to compare. Only the first min(clean_size, dirty_size) bytes are
+    // compared; the rest of the longer side is just passed to the chunk visitor.
+    struct Span {
+        uint64_t clean_offset = 0;
+        uint64_t clean_size = 0;
+        uint64_t dirty_offset = 0;
+        uint64_t dirty_size = 0;
+    };
+
+    // Called once per chunk with both sides' bytes (either side may be short or empty); `worker`
+    // is in [0, thread_count) and never runs twice at once.
+    typedef std::function<void(int worker, const char* clean, size_t clean_size, const char* dirty, size_t dirty_size)> ChunkVisitor;
+
+    // Compares the images of `clean` and `dirty` on `thread_count` workers. Bytes past the end of
+    // the shorter image count as changed. Ranges are in offset order.
+    std::vector<ChangedRange> ComparePages(const DumpReader& clean, const DumpReader& dirty, int thread_count, const std::function<void(float)>& progress, const ChunkVisitor& visit = nullptr);
+
+    // Compares every span on `thread_count` workers. Returns each span's ranges, with offsets
+    // relative to the span's start, in offset order.
+    std::vector<std::vector<ChangedRange>> CompareSpans(const DumpReader& clean, const DumpReader& dirty, const std::vector<Span>& spans, int thread_count, const std::function<void(float)>& progress, const ChunkVisitor& visit = nullptr);
+
+    // Structured dumps only. Overlapping regions are compared over the addresses both cover, whatever
+    // their bases; addresses only one dump holds are reported as added or removed, except the rest of
+    // a region whose base matches but whose size changed, which is reported as resized. Every region
+    // is passed to the chunk visitor in full, on both sides. Changes are in address order.
+    std::vector<RegionChange> CompareRegions(const DumpReader& clean, const DumpReader& dirty, int thread_count, const std::function<void(float)>& progress, const ChunkVisitor& visit = nullptr);
+
+    // Differing bytes of two equal-length buffers: their count, and the first and last position.
+    // Returns false (and leaves the outputs alone) when the buffers are equal.
+    bool CompareBytes(const char* a, const char* b, size_t size, size_t& first, size_t& last, uint64_t& count);
+}
@@ -0,0 +1,137 @@
+#include "block_codec.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace BlockCodec {
+
+    namespace {
+        constexpr size_t kMinMatch = 4;
+        constexpr size_t kLastLiterals = 5;   // The format requires the block to end with literals.
+        constexpr size_t kMatchFindLimit = 12; // No match may start this close to the end.
+        constexpr size_t kMaxOffset = 65535;
+        constexpr int kHashLog = 14;
+
+        inline uint32_t Read32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+        inline uint32_t Hash(uint32_t sequence) { return (sequence * 2654435761u) >> (32 - kHashLog); }
+
+        // Writes the 255-run continuation bytes of an LZ4 length field.
+        inline bool WriteLength(uint8_t*& op, const uint8_t* op_end, size_t length) {
+            while (length >= 255) {
+                if (op >= op_end) return false;
+                *op++ = 255;
+                length -= 255;
+            }
+            if (op >= op_end) return false;
+            *op++ = static_cast<uint8_t>(length);
+            return true;
+        }
+
+        inline bool EmitSequence(uint8_t*& op, const uint8_t* op_end, const uint8_t* literals, size_t literal_length, size_t offset, size_t match_length) {
+            if (op >= op_end) return false;
+            uint8_t* token = op++;
+            const size_t match_code = match_length ? match_length - kMinMatch : 0;
+            *token = static_cast<uint8_t>(((literal_length >= 15 ? 15 : literal_length) << 4) | (match_code >= 15 ? 15 : match_code));
+            if (literal_length >= 15 && !WriteLength(op, op_end, literal_length - 15)) return false;
+            if (static_cast<size_t>(op_end - op) < literal_length) return false;
+            std::memcpy(op, literals, literal_length);
+            op += literal_length;
+            if (match_length == 0) return true;
+            if (op_end - op < 2) return false;
+            *op++ = static_cast<uint8_t>(offset & 0xFF);
+            *op++ = static_cast<uint8_t>(offset >> 8);
+            if (match_code >= 15 && !WriteLength(op, op_end, match_code - 15)) return false;
+            return true;
+        }
+    } // namespace
+
+    size_t CompressBound(size_t size) { return size + size / 255 + 16; }
+
+    size_t Compress(const char* src_chars, size_t size, char* dst_chars, size_t capacity) {
+        const uint8_t* src = reinterpret_cast<const uint8_t*>(src_chars);
+        uint8_t* op = reinterpret_cast<uint8_t*>(dst_chars);
+        const uint8_t* op_end = op + capacity;
+        size_t anchor = 0;
+
+        if (size > kMatchFindLimit) {
+            thread_local std::vector<uint32_t> table;
+            table.assign(size_t(1) << kHashLog, UINT32_MAX);
+            const size_t match_limit = size - kMatchFindLimit;
+            const size_t extend_limit = size - kLastLiterals;
+            size_t ip = 0;
+            size_t misses = 0;
+            while (ip < match_limit) {
+                const uint32_t sequence = Read32(src + ip);
+                const uint32_t h = Hash(sequence);
+                const uint32_t candidate = table[h];
+                table[h] = static_cast<uint32_t>(ip);
+                if (candidate == UINT32_MAX || ip - candidate > kMaxOffset || Read32(src + candidate) != sequence) {
+                    // Skip ahead faster through incompressible data.
+                    ip += 1 + (misses++ >> 6);
+                    continue;
+                }
+                misses = 0;
+                size_t match_length = kMinMatch;
+                while (ip + match_length < extend_limit && src[candidate + match_length] == src[ip + match_length]) ++match_length;
+                if (!EmitSequence(op, op_end, src + anchor, ip - anchor, ip - candidate, match_length)) return 0;
+                ip += match_length;
+                anchor = ip;
+            }
+        }
+
+        if (!EmitSequence(op, op_end, src + anchor, size - anchor, 0, 0)) return 0;
+        return static_cast<size_t>(op - reinterpret_cast<uint8_t*>(dst_chars));
+    }
+
+    bool Decompress(const char* src_chars, size_t size, char* dst_chars, size_t decompressed_size) {
+        const uint8_t* ip = reinterpret_cast<const uint8_t*>(src_chars);
+        const uint8_t* ip_end = ip + size;
+        uint8_t* dst = reinterpret_cast<uint8_t*>(dst_chars);
+        size_t op = 0;
+
+        while (ip < ip_end) {
+            const uint8_t token = *ip++;
+            size_t literal_length = token >> 4;
+            if (literal_length == 15) {
+                uint8_t b;
+                do {
+                    if (ip >= ip_end) return false;
+                    b = *ip++;
+                    literal_length += b;
+                } while (b == 255);
+            }
+            if (static_cast<size_t>(ip_end - ip) < literal_length || decompressed_size - op < literal_length) return false;
+            std::memcpy(dst + op, ip, literal_length);
+            ip += literal_length;
+            op += literal_length;
+            if (ip == ip_end) break; // The last sequence carries literals only.
+
+            if (ip_end - ip < 2) return false;
+            const size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+            ip += 2;
+            if (offset == 0 || offset > op) return false;
+            size_t match_length = token & 15;
+            if (match_length == 15) {
+                uint8_t b;
+                do {
+                    if (ip >= ip_end) return false;
+                    b = *ip++;
+                    match_length += b;
+                } while (b == 255);
+            }
+            match_length += kMinMatch;
+            if (decompressed_size - op < match_length) return false;
+            const uint8_t* match = dst + op - offset;
+            if (offset >= match_length) {
+                std::memcpy(dst + op, match, match_length);
+            }
+            else {
+                // Overlapping copy (run-length style); must go byte by byte.
+                for (size_t i = 0; i < match_length; ++i) dst[op + i] = match[i];
+            }
+            op += match_length;
+        }
+        return op == decompressed_size;
+    }
+
+} // namespace BlockCodec
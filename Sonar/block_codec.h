@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+
+// Self-contained LZ4 block-format codec. Fast enough to keep up with dump workers and needs no
+// external library. Each call handles one independent block, so frames compress in parallel.
+namespace BlockCodec {
+
+    // Worst-case compressed size for `size` input bytes.
+    size_t CompressBound(size_t size);
+
+    // Compresses `size` bytes into `dst`. Returns the compressed size, or 0 if it would not fit in
+    // `capacity` (callers then store the block uncompressed).
+    size_t Compress(const char* src, size_t size, char* dst, size_t capacity);
+
+    // Decompresses a block that must expand to exactly `decompressed_size` bytes. Rejects malformed input.
+    bool Decompress(const char* src, size_t size, char* dst, size_t decompressed_size);
+
+} // namespace BlockCodec
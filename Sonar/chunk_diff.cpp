@@ -0,0 +1,217 @@
+#include "chunk_diff.h"
+#include "dump_reader.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+namespace {
+    constexpr size_t kMinChunk = 2 * 1024;
+    constexpr size_t kAverageChunk = 8 * 1024;
+    constexpr size_t kMaxChunk = 64 * 1024;
+    // Normalized chunking: 15 mask bits up to the average size, 11 after it.
+    constexpr uint64_t kMaskSmall = ~0ULL << (64 - 15);
+    constexpr uint64_t kMaskLarge = ~0ULL << (64 - 11);
+    constexpr uint64_t kSegmentSize = 16 * 1024 * 1024;
+    constexpr size_t kReadSize = 1024 * 1024;
+    // Segment boundaries move to the next anchor, a position whose preceding 64 bytes hit a 20-bit
+    // mask (about one per MB), so both images split at the same content.
+    constexpr uint64_t kAnchorMask = ~0ULL << (64 - 20);
+    constexpr size_t kAnchorSearch = 4 * 1024 * 1024;
+
+    // Random per-byte values for the Gear hash, from a fixed seed so chunking is the same every run.
+    struct GearTable {
+        uint64_t values[256];
+        GearTable() {
+            uint64_t state = 0x9E3779B97F4A7C15ULL;
+            for (uint64_t& value : values) {
+                // splitmix64
+                uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                value = z ^ (z >> 31);
+            }
+        }
+    };
+    const GearTable kGear;
+
+    // Runs fn(worker, index) for every index in [0, count) on `thread_count` workers.
+    void ParallelFor(size_t count, int thread_count, const std::function<void(int, size_t)>& fn) {
+        std::atomic<size_t> next = 0;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&, t]() {
+                for (size_t i = next++; i < count; i = next++) fn(t, i);
+                });
+        }
+        for (auto& th : threads) th.join();
+    }
+
+    // The first anchor at or after `from`, or `from` itself when there is none within kAnchorSearch.
+    uint64_t FindAnchor(const DumpReader& reader, uint64_t from, std::vector<char>& scratch) {
+        const uint64_t size = reader.LogicalSize();
+        if (from < 64 || from >= size) return std::min(from, size);
+        const uint64_t begin = from - 64;
+        scratch.resize((size_t)std::min<uint64_t>(kAnchorSearch + 64, size - begin));
+        const size_t got = reader.Read(begin, scratch.data(), scratch.size());
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(scratch.data());
+        uint64_t fingerprint = 0;
+        for (size_t i = 0; i < got; ++i) {
+            // After 64 steps the fingerprint depends only on the last 64 bytes.
+            fingerprint = (fingerprint << 1) + kGear.values[data[i]];
+            if (i >= 63 && !(fingerprint & kAnchorMask)) return begin + i + 1;
+        }
+        return from;
+    }
+
+    struct Segment {
+        bool dirty;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    // Chunks [segment.start, segment.end) of the image, reading it in 1 MB pieces.
+    void ChunkSegment(const DumpReader& reader, const Segment& segment, std::vector<char>& buffer, int worker, const BinaryDiff::ChunkVisitor& visit, std::vector<ChunkDiff::Chunk>& chunks) {
+        uint64_t position = segment.start;
+        uint64_t end = segment.end;
+        size_t filled = 0, consumed = 0;
+        while (position < end) {
+            // Keep at least one maximum chunk buffered until the segment end is in the buffer.
+            if (filled - consumed < kMaxChunk && position + (filled - consumed) < end) {
+                std::memmove(buffer.data(), buffer.data() + consumed, filled - consumed);
+                filled -= consumed;
+                consumed = 0;
+                const uint64_t read_offset = position + filled;
+                const size_t wanted = (size_t)std::min<uint64_t>(buffer.size() - filled, end - read_offset);
+                const size_t got = reader.Read(read_offset, buffer.data() + filled, wanted);
+                if (visit && got) {
+                    if (segment.dirty) visit(worker, nullptr, 0, buffer.data() + filled, got);
+                    else visit(worker, buffer.data() + filled, got, nullptr, 0);
+                }
+                filled += got;
+                if (got < wanted) end = read_offset + got;
+            }
+            const size_t available = filled - consumed;
+            if (available == 0) break;
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer.data() + consumed);
+            const size_t length = ChunkDiff::NextCut(data, available);
+            chunks.push_back({ position, (uint32_t)length, Hash128::Compute(data, length) });
+            consumed += length;
+            position += length;
+        }
+    }
+
+    // Joins changes into runs: contiguous in the reported image and, for moved content, with the
+    // same shift.
+    void AddRun(std::vector<BinaryDiff::RegionChange>& changes, BinaryDiff::ChangeKind kind, uint64_t offset, uint64_t size, uint64_t clean_offset) {
+        if (!changes.empty()) {
+            BinaryDiff::RegionChange& last = changes.back();
+            if (last.kind == kind && last.offset + last.size == offset && (kind != BinaryDiff::CHANGE_MOVED || last.clean_offset + last.size == clean_offset)) {
+                last.size += size;
+                last.changed_bytes += size;
+                return;
+            }
+        }
+        BinaryDiff::RegionChange change;
+        change.kind = kind;
+        change.offset = offset;
+        change.size = size;
+        change.clean_offset = clean_offset;
+        change.changed_bytes = size;
+        changes.push_back(change);
+    }
+}
+
+namespace ChunkDiff {
+
+    size_t NextCut(const uint8_t* data, size_t size) {
+        if (size <= kMinChunk) return size;
+        const size_t limit = std::min(size, kMaxChunk);
+        const size_t normal = std::min(limit, kAverageChunk);
+        uint64_t fingerprint = 0;
+        size_t i = kMinChunk;
+        for (; i < normal; ++i) {
+            fingerprint = (fingerprint << 1) + kGear.values[data[i]];
+            if (!(fingerprint & kMaskSmall)) return i + 1;
+        }
+        for (; i < limit; ++i) {
+            fingerprint = (fingerprint << 1) + kGear.values[data[i]];
+            if (!(fingerprint & kMaskLarge)) return i + 1;
+        }
+        return limit;
+    }
+
+    std::vector<BinaryDiff::RegionChange> Compare(const DumpReader& clean, const DumpReader& dirty, int thread_count, const std::function<void(float)>& progress, const BinaryDiff::ChunkVisitor& visit) {
+        thread_count = std::max(1, thread_count);
+        // Segments run from anchor to anchor, one anchor near every kSegmentSize boundary.
+        std::vector<Segment> segments;
+        for (bool is_dirty : { false, true }) {
+            const uint64_t size = (is_dirty ? dirty : clean).LogicalSize();
+            for (uint64_t start = 0; start < size; start += kSegmentSize) segments.push_back({ is_dirty, start, std::min(size, start + kSegmentSize) });
+        }
+        std::vector<std::vector<char>> scratch(thread_count);
+        ParallelFor(segments.size(), thread_count, [&](int worker, size_t s) { segments[s].start = FindAnchor(segments[s].dirty ? dirty : clean, segments[s].start, scratch[worker]); });
+        std::vector<std::vector<char>>().swap(scratch);
+        for (size_t s = 0; s + 1 < segments.size(); ++s) {
+            if (segments[s].dirty == segments[s + 1].dirty) segments[s].end = segments[s + 1].start;
+        }
+
+        std::vector<std::vector<Chunk>> segment_chunks(segments.size());
+        std::atomic<size_t> segments_done = 0;
+        std::vector<std::vector<char>> buffers(thread_count);
+        ParallelFor(segments.size(), thread_count, [&](int worker, size_t s) {
+            buffers[worker].resize(kReadSize + kMaxChunk);
+            ChunkSegment(segments[s].dirty ? dirty : clean, segments[s], buffers[worker], worker, visit, segment_chunks[s]);
+            if (progress) progress(0.9f * (float)(++segments_done) / (float)segments.size());
+            });
+
+        std::vector<Chunk> clean_chunks;
+        std::vector<Chunk> dirty_chunks;
+        for (size_t s = 0; s < segments.size(); ++s) {
+            std::vector<Chunk>& chunks = segments[s].dirty ? dirty_chunks : clean_chunks;
+            chunks.insert(chunks.end(), segment_chunks[s].begin(), segment_chunks[s].end());
+            std::vector<Chunk>().swap(segment_chunks[s]);
+        }
+
+        // Sorted by digest, then offset, for lookups on both sides.
+        auto by_digest = [](const Chunk& a, const Chunk& b) { return a.digest != b.digest ? a.digest < b.digest : a.offset < b.offset; };
+        std::vector<Chunk> clean_sorted = clean_chunks;
+        std::vector<Chunk> dirty_sorted = dirty_chunks;
+        std::sort(clean_sorted.begin(), clean_sorted.end(), by_digest);
+        std::sort(dirty_sorted.begin(), dirty_sorted.end(), by_digest);
+        auto matches = [&](const std::vector<Chunk>& sorted, const Hash128::Digest& digest) {
+            return std::equal_range(sorted.begin(), sorted.end(), Chunk{ 0, 0, digest }, [](const Chunk& a, const Chunk& b) { return a.digest < b.digest; });
+        };
+
+        std::vector<BinaryDiff::RegionChange> changes;
+        uint64_t next_clean = UINT64_MAX;   // Where the previous dirty chunk's clean copy ended.
+        for (const Chunk& chunk : dirty_chunks) {
+            const auto [first, last] = matches(clean_sorted, chunk.digest);
+            if (first == last) {
+                AddRun(changes, BinaryDiff::CHANGE_INSERTED, chunk.offset, chunk.size, 0);
+                next_clean = UINT64_MAX;
+                continue;
+            }
+            // Prefer the copy in place, then the one continuing the previous chunk's run.
+            auto at = [&](uint64_t offset) {
+                auto it = std::lower_bound(first, last, offset, [](const Chunk& c, uint64_t value) { return c.offset < value; });
+                return (it != last && it->offset == offset) ? it : last;
+            };
+            auto match = at(chunk.offset);
+            if (match == last && next_clean != UINT64_MAX) match = at(next_clean);
+            if (match == last) match = first;
+            if (match->offset != chunk.offset) AddRun(changes, BinaryDiff::CHANGE_MOVED, chunk.offset, chunk.size, match->offset);
+            next_clean = match->offset + match->size;
+        }
+        std::vector<BinaryDiff::RegionChange> deleted;
+        for (const Chunk& chunk : clean_chunks) {
+            const auto [first, last] = matches(dirty_sorted, chunk.digest);
+            if (first == last) AddRun(deleted, BinaryDiff::CHANGE_DELETED, chunk.offset, chunk.size, 0);
+        }
+        changes.insert(changes.end(), deleted.begin(), deleted.end());
+        std::stable_sort(changes.begin(), changes.end(), [](const BinaryDiff::RegionChange& a, const BinaryDiff::RegionChange& b) { return a.offset < b.offset; });
+        if (progress) progress(1.0f);
+        return changes;
+    }
+}
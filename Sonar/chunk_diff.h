@@ -0,0 +1,42 @@
+#pragma once
+
+#include "binary_diff.h"
+#include "hash128.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class DumpReader;
+
+// Content-defined chunking diff. Both images are cut into chunks where a rolling Gear hash of the
+// last 64 bytes hits a mask (FastCDC: 2 KB minimum, 8 KB average, 64 KB maximum, with a stricter
+// mask before the average size and a looser one after it). Boundaries depend only on nearby
+// content, so after an insertion or a moved block the chunks line up again and the same content
+// gets the same chunks wherever it sits. Chunks are then matched by their 128-bit hash:
+//
+//   moved     - a dirty chunk found in the clean image at another offset (runs with a constant
+//               shift are joined, so content pushed along by an insertion is one entry)
+//   inserted  - a dirty chunk found nowhere in the clean image
+//   deleted   - a clean chunk found nowhere in the dirty image
+//
+// A small edit shows up as an inserted chunk in the dirty image and a deleted one in the clean.
+// Images are chunked in parallel in segments of about 16 MB. A segment starts at an anchor, the
+// first position after its nominal start where the Gear hash hits a much stricter mask; anchors
+// depend only on the 64 bytes before them, so both images split at the same content and the
+// segment cuts do not show up as changes.
+namespace ChunkDiff {
+
+    struct Chunk {
+        uint64_t offset = 0;
+        uint32_t size = 0;
+        Hash128::Digest digest;
+    };
+
+    // Length of the first chunk of `data`; at most `size` bytes.
+    size_t NextCut(const uint8_t* data, size_t size);
+
+    // Chunks both images on `thread_count` workers and matches them. The visitor sees every byte
+    // of each image once, one side at a time. Changes are in offset order.
+    std::vector<BinaryDiff::RegionChange> Compare(const DumpReader& clean, const DumpReader& dirty, int thread_count, const std::function<void(float)>& progress, const BinaryDiff::ChunkVisitor& visit = nullptr);
+}
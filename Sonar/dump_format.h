@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// On-disk layout of Sonar's structured binary dumps.
+//
+//   FileHeader | RegionEntry[region_count] | page table (uint64_t[page_count]) | [base name] | page data
+//
+// Every committed region is split into page_size pages. The page table holds one reference per
+// page, in region order, so page N of the table always covers flat offset N * page_size of the
+// concatenated region image. Identical pages are stored once and referenced many times, and pages
+// filled with a single byte value (mostly zero pages) are recorded in the table without any data.
+// Incremental dumps additionally reference unchanged pages in an earlier (base) dump by index.
+namespace DumpFormat {
+
+    constexpr char kMagic[8] = { 'S', 'O', 'N', 'A', 'R', 'D', 'M', 'P' };
+    constexpr uint32_t kVersion = 3;           // 2: adds PAGE_CONSTANT. 3: adds incremental dumps.
+    constexpr uint32_t kPageSize = 4096;
+
+    enum HeaderFlags : uint32_t {
+        FLAG_DEDUPLICATED = 1u << 0,
+        FLAG_INCREMENTAL = 1u << 1,   // Some pages live in the base dump named in the header.
+    };
+
+#pragma pack(push, 1)
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t flags;
+        uint32_t page_size;
+        uint32_t process_id;
+        uint64_t region_count;
+        uint64_t page_count;          // Number of page table entries.
+        uint64_t stored_page_count;   // Number of pages physically present in the data section.
+        uint64_t region_table_offset;
+        uint64_t page_table_offset;
+        uint64_t data_offset;
+        uint64_t dump_id[2];          // Random identity of this dump, so an incremental dump can verify its base.
+        uint64_t base_id[2];          // dump_id of the base dump (incremental dumps only).
+        uint64_t base_name_offset;    // Path of the base dump, not NUL-terminated (incremental dumps only).
+        uint64_t base_name_length;
+        uint64_t reserved[2];
+    };
+
+    struct RegionEntry {
+        uint64_t base_address;
+        uint64_t size;
+        uint64_t first_page;          // Index of the region's first entry in the page table.
+        uint32_t protect;
+        uint32_t type;
+    };
+#pragma pack(pop)
+
+    // A page reference packs its kind into the top byte and a kind-specific payload into the rest.
+    enum PageKind : uint8_t {
+        PAGE_STORED = 0,              // Payload: slot in the data section.
+        PAGE_UNREADABLE = 1,          // The page could not be read from the target; reads back as zeros.
+        PAGE_CONSTANT = 2,            // Every byte has the same value. Payload: the byte. Nothing is stored.
+        PAGE_BASE = 3,                // Unchanged since the base dump. Payload: page index in the base dump.
+    };
+
+    constexpr uint64_t kPayloadMask = (1ULL << 56) - 1;
+
+    inline uint64_t MakePageRef(PageKind kind, uint64_t payload) { return (static_cast<uint64_t>(kind) << 56) | (payload & kPayloadMask); }
+    inline PageKind PageRefKind(uint64_t ref) { return static_cast<PageKind>(ref >> 56); }
+    inline uint64_t PageRefPayload(uint64_t ref) { return ref & kPayloadMask; }
+
+    inline uint64_t PagesForSize(uint64_t size, uint32_t page_size) { return (size + page_size - 1) / page_size; }
+    inline uint64_t AlignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+    inline bool HasMagic(const char* bytes) { return std::memcmp(bytes, kMagic, sizeof(kMagic)) == 0; }
+
+    // --- Framed (compressed) container ---
+    //
+    //   FramedHeader | compressed frames ... | FrameIndexEntry[frame_count]
+    //
+    // Any dump (raw, structured or text) can be wrapped in this container. Its logical byte stream
+    // is cut into independently compressed frames of at most frame_size bytes, so frames compress
+    // and decompress in parallel and the index allows random access without inflating the file.
+    constexpr char kFramedMagic[8] = { 'S', 'O', 'N', 'A', 'R', 'F', 'R', 'M' };
+    constexpr uint32_t kFramedVersion = 1;
+    constexpr uint32_t kCodecLZ4Block = 1;
+    constexpr uint32_t kFrameSize = 1024 * 1024;
+
+    enum FrameFlags : uint32_t {
+        FRAME_STORED_RAW = 1u << 0,   // The frame did not compress and is stored verbatim.
+    };
+
+#pragma pack(push, 1)
+    struct FramedHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t codec;
+        uint32_t frame_size;
+        uint32_t reserved0;
+        uint64_t logical_size;
+        uint64_t frame_count;
+        uint64_t index_offset;
+        uint64_t reserved[4];
+    };
+
+    struct FrameIndexEntry {
+        uint64_t logical_offset;
+        uint64_t file_offset;
+        uint32_t stored_size;
+        uint32_t logical_size;
+        uint32_t flags;
+        uint32_t reserved;
+    };
+#pragma pack(pop)
+
+    inline bool HasFramedMagic(const char* bytes) { return std::memcmp(bytes, kFramedMagic, sizeof(kFramedMagic)) == 0; }
+
+    // --- Page hash sidecar (<dump>.pagehash) ---
+    //
+    //   PageHashHeader | RegionEntry[region_count] | 128-bit digest[page_count]
+    //
+    // Written next to every structured dump. It lets a later incremental dump decide which pages
+    // changed without reading the base dump itself. Pages that were not stored have a zero digest.
+    constexpr char kPageHashMagic[8] = { 'S', 'O', 'N', 'A', 'R', 'P', 'H', 'S' };
+    constexpr uint32_t kPageHashVersion = 1;
+
+#pragma pack(push, 1)
+    struct PageHashHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t page_size;
+        uint64_t dump_id[2];
+        uint64_t region_count;
+        uint64_t page_count;
+        uint64_t region_table_offset;
+        uint64_t digest_offset;
+        uint64_t reserved[4];
+    };
+#pragma pack(pop)
+
+    inline bool HasPageHashMagic(const char* bytes) { return std::memcmp(bytes, kPageHashMagic, sizeof(kPageHashMagic)) == 0; }
+
+    inline FileHeader MakeHeader(uint32_t process_id, uint64_t region_count, uint64_t page_count, uint64_t base_name_length = 0) {
+        FileHeader header = {};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.page_size = kPageSize;
+        header.process_id = process_id;
+        header.region_count = region_count;
+        header.page_count = page_count;
+        header.region_table_offset = sizeof(FileHeader);
+        header.page_table_offset = header.region_table_offset + region_count * sizeof(RegionEntry);
+        header.base_name_offset = header.page_table_offset + page_count * sizeof(uint64_t);
+        header.base_name_length = base_name_length;
+        header.data_offset = AlignUp(header.base_name_offset + base_name_length, kPageSize);
+        return header;
+    }
+
+} // namespace DumpFormat
@@ -0,0 +1,504 @@
+#include "dump_job.h"
+#include "elf_core.h"
+#include "minidump.h"
+#include "page_scan.hpp"
+#include <psapi.h>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+// Files backing image and mapped-view regions, for the ELF core's NT_FILE note. Module paths come
+// from the loader (DOS paths); other mapped views fall back to their NT device path.
+static std::vector<ElfCore::MappedFile> GetMappedFiles(HANDLE hProcess, const std::vector<MEMORY_BASIC_INFORMATION>& regions) {
+    std::unordered_map<uint64_t, std::string> module_paths;
+    std::vector<HMODULE> modules(1024);
+    DWORD needed = 0;
+    if (EnumProcessModulesEx(hProcess, modules.data(), (DWORD)(modules.size() * sizeof(HMODULE)), &needed, LIST_MODULES_ALL)) {
+        modules.resize(std::min<size_t>(modules.size(), needed / sizeof(HMODULE)));
+        for (HMODULE module : modules) {
+            char path[MAX_PATH] = {};
+            if (GetModuleFileNameExA(hProcess, module, path, MAX_PATH)) module_paths[(uint64_t)module] = path;
+        }
+    }
+    std::vector<ElfCore::MappedFile> files;
+    for (const auto& region : regions) {
+        if (region.Type != MEM_IMAGE && region.Type != MEM_MAPPED) continue;
+        std::string path;
+        auto it = module_paths.find((uint64_t)region.AllocationBase);
+        if (it != module_paths.end()) { path = it->second; }
+        else {
+            char mapped[MAX_PATH] = {};
+            if (!GetMappedFileNameA(hProcess, region.BaseAddress, mapped, MAX_PATH)) continue;
+            path = mapped;
+        }
+        const uint64_t start = (uint64_t)region.BaseAddress;
+        files.push_back({ start, start + region.RegionSize, start - (uint64_t)region.AllocationBase, path });
+    }
+    return files;
+}
+
+// Loaded modules with the PE header fields a minidump module list records.
+static std::vector<Minidump::Module> GetMinidumpModules(HANDLE hProcess) {
+    std::vector<Minidump::Module> result;
+    std::vector<HMODULE> modules(1024);
+    DWORD needed = 0;
+    if (!EnumProcessModulesEx(hProcess, modules.data(), (DWORD)(modules.size() * sizeof(HMODULE)), &needed, LIST_MODULES_ALL)) return result;
+    modules.resize(std::min<size_t>(modules.size(), needed / sizeof(HMODULE)));
+    for (HMODULE module : modules) {
+        MODULEINFO info = {};
+        WCHAR path[MAX_PATH] = {};
+        if (!GetModuleInformation(hProcess, module, &info, sizeof(info)) || !GetModuleFileNameExW(hProcess, module, path, MAX_PATH)) continue;
+        Minidump::Module entry = { (uint64_t)info.lpBaseOfDll, info.SizeOfImage, 0, 0, std::u16string(path, path + wcslen(path)) };
+        // TimeDateStamp and CheckSum let debuggers match the module against symbol servers.
+        unsigned char pe_header[1024] = {};
+        SIZE_T bytes_read = 0;
+        if (ReadProcessMemory(hProcess, info.lpBaseOfDll, pe_header, sizeof(pe_header), &bytes_read) && bytes_read == sizeof(pe_header)) {
+            uint32_t nt_offset = 0;
+            std::memcpy(&nt_offset, pe_header + 0x3C, sizeof(nt_offset));
+            if (nt_offset + 24 + 68 <= sizeof(pe_header) && std::memcmp(pe_header + nt_offset, "PE\0\0", 4) == 0) {
+                std::memcpy(&entry.time_date_stamp, pe_header + nt_offset + 8, sizeof(uint32_t));
+                std::memcpy(&entry.checksum, pe_header + nt_offset + 24 + 64, sizeof(uint32_t));
+            }
+        }
+        result.push_back(std::move(entry));
+    }
+    return result;
+}
+
+static Minidump::SystemInfo GetMinidumpSystemInfo() {
+    Minidump::SystemInfo system;
+    SYSTEM_INFO info = {};
+    GetNativeSystemInfo(&info);
+    system.processor_architecture = info.wProcessorArchitecture;
+    system.processor_level = info.wProcessorLevel;
+    system.processor_revision = info.wProcessorRevision;
+    system.number_of_processors = (uint8_t)std::min<DWORD>(info.dwNumberOfProcessors, 255);
+    // GetVersionEx reports the manifest-compatible version; RtlGetVersion reports the real one.
+    typedef LONG(WINAPI* RtlGetVersionFn)(RTL_OSVERSIONINFOW*);
+    auto rtl_get_version = (RtlGetVersionFn)GetProcAddress(GetModuleHandleA("ntdll.dll"), "RtlGetVersion");
+    RTL_OSVERSIONINFOW version = {};
+    version.dwOSVersionInfoSize = sizeof(version);
+    if (rtl_get_version && rtl_get_version(&version) == 0) {
+        system.major_version = version.dwMajorVersion;
+        system.minor_version = version.dwMinorVersion;
+        system.build_number = version.dwBuildNumber;
+    }
+    return system;
+}
+
+BinaryDumpJob::BinaryDumpJob(HANDLE target, DWORD target_id, std::vector<MEMORY_BASIC_INFORMATION> target_regions, std::string path, const DumpOptions& dump_options)
+    : process(target), process_id(target_id), regions(std::move(target_regions)), output_path(std::move(path)), options(dump_options) {}
+
+bool BinaryDumpJob::Prepare(int worker_count, std::string& error) {
+    region_table.reserve(regions.size());
+    for (const auto& region : regions) {
+        region_table.push_back({ (uint64_t)region.BaseAddress, (uint64_t)region.RegionSize, page_count, region.Protect, region.Type });
+        page_count += DumpFormat::PagesForSize(region.RegionSize, DumpFormat::kPageSize);
+        flat_size += region.RegionSize;
+    }
+    chunks = PlanDumpChunks(region_table, DumpFormat::kPageSize, CHUNK_SIZE);
+
+    // ELF cores and minidumps are raw dumps behind a container header: the flat image starts at
+    // image_offset, and the headers are written once the workers are done.
+    plain_container = options.container != DUMP_CONTAINER_SONAR;
+    if (plain_container) {
+        if (options.optimize || options.compress || !options.base_dump_path.empty()) { error = "ERROR: ELF core and minidump outputs cannot be optimized, compressed or incremental."; return false; }
+        if (options.container == DUMP_CONTAINER_ELF_CORE) {
+            char process_name[MAX_PATH] = {};
+            GetModuleBaseNameA(process, NULL, process_name, MAX_PATH);
+            ElfCore::Layout layout = ElfCore::Plan(region_table, GetMappedFiles(process, regions), process_id, process_name);
+            container_headers = std::move(layout.headers);
+            image_offset = layout.data_offset;
+        }
+        else {
+            Minidump::Layout layout = Minidump::Plan(region_table, GetMinidumpModules(process), GetMinidumpSystemInfo(), (uint32_t)std::time(nullptr));
+            container_headers = std::move(layout.headers);
+            image_offset = layout.data_offset;
+        }
+    }
+
+    // Optimized dumps are structured: every page gets a reference in the page table and identical
+    // pages are stored once, addressed by their 128-bit content hash. The dump stays restorable.
+    // Incremental dumps also reference pages that are unchanged since the base dump.
+    incremental = !options.base_dump_path.empty();
+    if (incremental) {
+        std::string base_error;
+        if (!options.optimize) { error = "ERROR: Incremental dumps require the Optimize option."; return false; }
+        // Opening the output truncates it, so the base must be a different file.
+        std::error_code same_error;
+        if (std::filesystem::equivalent(options.base_dump_path, output_path, same_error)) { error = "ERROR: The base dump cannot also be the output file."; return false; }
+        if (!base_hashes.Load(options.base_dump_path, base_error)) { error = "ERROR: Could not load base dump. " + base_error; return false; }
+        base_name = std::filesystem::absolute(options.base_dump_path).string();
+    }
+    header = DumpFormat::MakeHeader(process_id, region_table.size(), page_count, base_name.size());
+    header.flags |= DumpFormat::FLAG_DEDUPLICATED;
+    std::random_device random;
+    for (uint64_t& id : header.dump_id) { id = ((uint64_t)random() << 32) ^ random() ^ (uint64_t)std::time(nullptr); }
+    if (incremental) {
+        header.flags |= DumpFormat::FLAG_INCREMENTAL;
+        header.base_id[0] = base_hashes.DumpId()[0];
+        header.base_id[1] = base_hashes.DumpId()[1];
+    }
+    if (options.optimize) {
+        page_table.assign(page_count, DumpFormat::MakePageRef(DumpFormat::PAGE_UNREADABLE, 0));
+        page_hashes.assign(page_count, Hash128::Digest{});
+    }
+    slot_blocks.assign(worker_count, SlotBlock());
+    if (options.compress && options.optimize) {
+        for (auto& block : slot_blocks) block.data.resize(DumpFormat::kFrameSize);
+    }
+
+    // Checkpointed dumps resume from a journal that matches this layout; the output file is then
+    // reopened in place instead of truncated. Compressed frames are appended at a shared cursor and
+    // have no fixed position, so compressed dumps are not checkpointed.
+    journaling = options.checkpoint && !options.compress;
+    if (journaling && !OpenJournal(error)) return false;
+
+    // Compressed dumps wrap the same logical layout in independently compressed frames. Workers
+    // compress their own frames, so compression scales with the dump threads.
+    std::string file_error;
+    bool opened = false;
+    if (options.compress) { opened = frame_out.Open(output_path, file_error); }
+    else if (journal.Resumed()) { opened = out_file.OpenExisting(output_path, file_error); }
+    else { opened = out_file.Open(output_path, file_error); }
+    if (!opened) { error = "ERROR: Failed to create output file: " + file_error; return false; }
+    if (options.limits) {
+        out_file.SetWriteLimit(&options.limits->write);
+        frame_out.SetWriteLimit(&options.limits->write);
+    }
+    // Raw dumps have a known final size. The file is sparse, so unreadable and zero pages are
+    // never written and stay holes at their correct offsets.
+    if (!options.compress && !options.optimize) {
+        out_file.MakeSparse();
+        if (!out_file.Preallocate(image_offset + flat_size)) { error = "ERROR: Failed to preallocate output file: " + output_path; return false; }
+    }
+    return true;
+}
+
+bool BinaryDumpJob::OpenJournal(std::string& error) {
+    JournalIdentity identity;
+    identity.Add(process_id).Add(options.optimize).Add((int)options.container).Add(base_name).Add(header.base_id[0]).Add(header.base_id[1]);
+    for (const auto& region : region_table) identity.Add(region);
+    const std::string journal_path = JobJournal::PathFor(output_path);
+    // A journal is only meaningful together with the output it describes.
+    std::error_code ignored;
+    if (!std::filesystem::exists(output_path, ignored)) std::filesystem::remove(journal_path, ignored);
+
+    std::vector<char> extra(sizeof(header.dump_id));
+    std::memcpy(extra.data(), header.dump_id, sizeof(header.dump_id));
+    chunk_done.assign(chunks.size(), 0);
+    std::vector<uint64_t> written_slots;
+    auto replay = [&](uint64_t chunk_index, const char* payload, size_t size) { ReplayChunk(chunk_index, payload, size, written_slots); };
+    if (!journal.Open(journal_path, identity.Digest(), chunks.size(), extra, replay, error)) { error = "ERROR: " + error; return false; }
+    if (!journal.Resumed()) return true;
+    // The resumed dump keeps its ID, so sidecars and incremental dumps taken later stay consistent.
+    if (extra.size() == sizeof(header.dump_id)) std::memcpy(header.dump_id, extra.data(), sizeof(header.dump_id));
+
+    if (options.optimize) {
+        // A finished chunk may reference a page that another chunk was still writing when the run
+        // stopped. Only slots recorded by finished chunks are known to hold data, so chunks that
+        // reference any other slot are redone. Unused slots stay as gaps in the data section.
+        std::sort(written_slots.begin(), written_slots.end());
+        uint64_t slot_count = written_slots.empty() ? 0 : written_slots.back() + 1;
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            if (!chunk_done[c]) continue;
+            const uint64_t first_page = chunks[c].first_page;
+            const uint64_t pages = DumpFormat::PagesForSize(chunks[c].size, DumpFormat::kPageSize);
+            bool valid = true;
+            for (uint64_t p = first_page; p < first_page + pages && valid; ++p) {
+                const uint64_t ref = page_table[p];
+                if (DumpFormat::PageRefKind(ref) == DumpFormat::PAGE_STORED) valid = std::binary_search(written_slots.begin(), written_slots.end(), DumpFormat::PageRefPayload(ref));
+            }
+            for (uint64_t p = first_page; p < first_page + pages; ++p) {
+                if (!valid) {
+                    page_table[p] = DumpFormat::MakePageRef(DumpFormat::PAGE_UNREADABLE, 0);
+                    page_hashes[p] = Hash128::Digest{};
+                }
+                else if (DumpFormat::PageRefKind(page_table[p]) == DumpFormat::PAGE_STORED) {
+                    const uint64_t slot = DumpFormat::PageRefPayload(page_table[p]);
+                    page_store.Restore(page_hashes[p], slot);
+                    slot_count = std::max(slot_count, slot + 1);
+                }
+            }
+            if (!valid) chunk_done[c] = 0;
+        }
+        page_store.SetSlotCount(slot_count);
+    }
+    resumed_chunks = (size_t)std::count(chunk_done.begin(), chunk_done.end(), 1);
+    return true;
+}
+
+void BinaryDumpJob::ReplayChunk(uint64_t chunk_index, const char* payload, size_t size, std::vector<uint64_t>& written_slots) {
+    const DumpChunk& chunk = chunks[chunk_index];
+    if (options.optimize) {
+        // Payload: page refs, page digests, then the slots this chunk wrote.
+        const size_t pages = (size_t)DumpFormat::PagesForSize(chunk.size, DumpFormat::kPageSize);
+        const size_t fixed = pages * (sizeof(uint64_t) + sizeof(Hash128::Digest));
+        if (size < fixed || (size - fixed) % sizeof(uint64_t) != 0) return;
+        std::memcpy(page_table.data() + chunk.first_page, payload, pages * sizeof(uint64_t));
+        std::memcpy(page_hashes.data() + chunk.first_page, payload + pages * sizeof(uint64_t), pages * sizeof(Hash128::Digest));
+        for (size_t offset = fixed; offset < size; offset += sizeof(uint64_t)) {
+            uint64_t slot;
+            std::memcpy(&slot, payload + offset, sizeof(slot));
+            written_slots.push_back(slot);
+        }
+    }
+    chunk_done[chunk_index] = 1;
+}
+
+void BinaryDumpJob::FlushBlock(SlotBlock& block) {
+    const size_t PAGES_PER_BLOCK = DumpFormat::kFrameSize / DumpFormat::kPageSize;
+    if (block.block == UINT64_MAX || block.used == 0) return;
+    if (!frame_out.WriteFrame(header.data_offset + block.block * PAGES_PER_BLOCK * DumpFormat::kPageSize, block.data.data(), block.used * DumpFormat::kPageSize)) { write_failed = true; }
+    block.block = UINT64_MAX;
+    block.used = 0;
+}
+
+uint64_t BinaryDumpJob::AllocateSlot(SlotBlock& block) {
+    const size_t PAGES_PER_BLOCK = DumpFormat::kFrameSize / DumpFormat::kPageSize;
+    if (block.block == UINT64_MAX) { block.block = next_block++; block.used = 0; }
+    return block.block * PAGES_PER_BLOCK + block.used++;
+}
+
+// Resolves pages that need no data of their own: constant pages and, in incremental dumps, pages
+// whose hash matches the base dump's page at the same address.
+bool BinaryDumpJob::ResolveWithoutData(const char* page_data, size_t page_len, uint64_t address, uint64_t page_index, Hash128::Digest& digest) {
+    uint8_t fill = 0;
+    if (PageScan::IsConstant(page_data, DumpFormat::kPageSize, fill)) {
+        page_table[page_index] = DumpFormat::MakePageRef(DumpFormat::PAGE_CONSTANT, fill);
+        bytes_elided += page_len;
+        return true;
+    }
+    digest = Hash128::Compute(page_data, DumpFormat::kPageSize);
+    page_hashes[page_index] = digest;
+    uint64_t base_page = 0;
+    if (incremental && base_hashes.FindPage(address, base_page) && base_hashes.PageDigest(base_page) == digest) {
+        page_table[page_index] = DumpFormat::MakePageRef(DumpFormat::PAGE_BASE, base_page);
+        bytes_from_base += page_len;
+        return true;
+    }
+    return false;
+}
+
+void BinaryDumpJob::ProcessChunk(size_t chunk_index, int worker, DumpWorkerBuffers& buffers) {
+    const size_t PAGE_SIZE = DumpFormat::kPageSize;
+    const size_t PAGES_PER_BLOCK = DumpFormat::kFrameSize / PAGE_SIZE;
+    if (write_failed) return;
+    buffers.buffer.resize(std::max(buffers.buffer.size(), CHUNK_SIZE));
+    buffers.page_ok.resize(std::max(buffers.page_ok.size(), CHUNK_SIZE / PAGE_SIZE));
+    buffers.page_skip.resize(std::max(buffers.page_skip.size(), CHUNK_SIZE / PAGE_SIZE));
+    char* buffer = buffers.buffer.data();
+    char* page_ok = buffers.page_ok.data();
+    char* page_skip = buffers.page_skip.data();
+
+    const DumpChunk& chunk = chunks[chunk_index];
+    char* current = (char*)chunk.address;
+    const size_t chunk_size = (size_t)chunk.size;
+    const size_t pages_in_chunk = (size_t)DumpFormat::PagesForSize(chunk_size, DumpFormat::kPageSize);
+    if (options.limits) options.limits->read.Consume(chunk_size);
+    SIZE_T bytes_read = 0;
+    // If the chunk read fails, retry page by page so one bad page doesn't lose its neighbours.
+    bool chunk_ok = ReadProcessMemory(process, current, buffer, chunk_size, &bytes_read) && bytes_read == chunk_size;
+    for (size_t p = 0; p < pages_in_chunk; ++p) {
+        SIZE_T page_len = std::min(PAGE_SIZE, chunk_size - p * PAGE_SIZE);
+        SIZE_T page_read = 0;
+        page_ok[p] = chunk_ok || (ReadProcessMemory(process, current + p * PAGE_SIZE, buffer + p * PAGE_SIZE, page_len, &page_read) && page_read == page_len);
+        if (page_ok[p]) { bytes_scanned += page_len; }
+    }
+    // Raw output skips pages that would only write zeros: unreadable ones and zero-filled ones.
+    bool chunk_empty = true;
+    if (!options.optimize) {
+        size_t zero_bytes = 0;
+        for (size_t p = 0; p < pages_in_chunk; ++p) {
+            SIZE_T page_len = std::min(PAGE_SIZE, chunk_size - p * PAGE_SIZE);
+            uint8_t fill = 0;
+            page_skip[p] = !page_ok[p] || (PageScan::IsConstant(buffer + p * PAGE_SIZE, page_len, fill) && fill == 0);
+            if (page_ok[p] && page_skip[p]) { zero_bytes += page_len; }
+            chunk_empty = chunk_empty && page_skip[p];
+        }
+        // Compressed raw dumps can only drop whole frames.
+        if (!options.compress || chunk_empty) { bytes_elided += zero_bytes; }
+    }
+
+    thread_local std::vector<uint64_t> new_slots;
+    new_slots.clear();
+    if (options.compress && !options.optimize) {
+        // Chunks are frame-sized, so each chunk becomes one frame at its flat offset.
+        // An all-zero chunk is left out entirely; gaps between frames read back as zeros.
+        for (size_t p = 0; p < pages_in_chunk; ++p) {
+            if (!page_ok[p]) std::fill(buffer + p * PAGE_SIZE, buffer + std::min(chunk_size, (p + 1) * PAGE_SIZE), 0);
+        }
+        if (!chunk_empty && !frame_out.WriteFrame(chunk.flat_offset, buffer, chunk_size)) { write_failed = true; }
+    }
+    else if (options.compress) {
+        SlotBlock& block = slot_blocks[worker];
+        for (size_t p = 0; p < pages_in_chunk; ++p) {
+            if (!page_ok[p]) continue;
+            char* page_data = buffer + p * PAGE_SIZE;
+            SIZE_T page_len = std::min(PAGE_SIZE, chunk_size - p * PAGE_SIZE);
+            if (page_len < PAGE_SIZE) { std::fill(page_data + page_len, page_data + PAGE_SIZE, 0); }
+            Hash128::Digest digest;
+            if (ResolveWithoutData(page_data, page_len, chunk.address + p * PAGE_SIZE, chunk.first_page + p, digest)) continue;
+            auto [slot, is_new] = page_store.Intern(digest, [&]() { return AllocateSlot(block); });
+            page_table[chunk.first_page + p] = DumpFormat::MakePageRef(DumpFormat::PAGE_STORED, slot);
+            if (!is_new) continue;
+            std::copy(page_data, page_data + PAGE_SIZE, block.data.data() + (slot % PAGES_PER_BLOCK) * PAGE_SIZE);
+            if (block.used == PAGES_PER_BLOCK) FlushBlock(block);
+        }
+    }
+    else if (!options.optimize) {
+        // Write each run of consecutive non-skipped pages with a single call. A resumed dump reopens
+        // the partial output in place, where the interrupted run may already have written this
+        // chunk, so its skipped runs are zeroed instead of left as they are.
+        const bool zero_skipped = journaling && journal.Resumed();
+        for (size_t p = 0; p < pages_in_chunk && !write_failed;) {
+            const bool skip = page_skip[p] != 0;
+            size_t run_end = p;
+            while (run_end < pages_in_chunk && (page_skip[run_end] != 0) == skip) ++run_end;
+            const size_t run_len = std::min(chunk_size, run_end * PAGE_SIZE) - p * PAGE_SIZE;
+            const uint64_t run_offset = image_offset + chunk.flat_offset + p * PAGE_SIZE;
+            if (skip) {
+                if (zero_skipped && !out_file.ZeroRange(run_offset, run_len)) { write_failed = true; }
+            }
+            else if (!out_file.WriteAt(run_offset, buffer + p * PAGE_SIZE, run_len)) { write_failed = true; }
+            else { bytes_written += run_len; }
+            p = run_end;
+        }
+    }
+    else {
+        for (size_t p = 0; p < pages_in_chunk; ++p) {
+            if (!page_ok[p]) continue;
+            char* page_data = buffer + p * PAGE_SIZE;
+            SIZE_T page_len = std::min(PAGE_SIZE, chunk_size - p * PAGE_SIZE);
+            if (page_len < PAGE_SIZE) { std::fill(page_data + page_len, page_data + PAGE_SIZE, 0); }
+            Hash128::Digest digest;
+            if (ResolveWithoutData(page_data, page_len, chunk.address + p * PAGE_SIZE, chunk.first_page + p, digest)) continue;
+            auto [slot, is_new] = page_store.Intern(digest);
+            page_table[chunk.first_page + p] = DumpFormat::MakePageRef(DumpFormat::PAGE_STORED, slot);
+            if (is_new && !out_file.WriteAt(header.data_offset + slot * PAGE_SIZE, page_data, PAGE_SIZE)) { write_failed = true; break; }
+            if (is_new) new_slots.push_back(slot);
+        }
+    }
+
+    // The record goes in only after the chunk's data is written, so replaying it never points at
+    // missing data if the process is killed. Neither file is flushed, so a power loss can still
+    // lose data that the journal records.
+    if (journaling && !write_failed) {
+        thread_local std::vector<char> record;
+        record.clear();
+        if (options.optimize) {
+            const char* refs = reinterpret_cast<const char*>(page_table.data() + chunk.first_page);
+            const char* digests = reinterpret_cast<const char*>(page_hashes.data() + chunk.first_page);
+            const char* slots = reinterpret_cast<const char*>(new_slots.data());
+            record.insert(record.end(), refs, refs + pages_in_chunk * sizeof(uint64_t));
+            record.insert(record.end(), digests, digests + pages_in_chunk * sizeof(Hash128::Digest));
+            record.insert(record.end(), slots, slots + new_slots.size() * sizeof(uint64_t));
+        }
+        journal.Record(chunk_index, record.data(), record.size());
+    }
+}
+
+bool BinaryDumpJob::Finish(std::string& error) {
+    const size_t PAGE_SIZE = DumpFormat::kPageSize;
+    const size_t PAGES_PER_BLOCK = DumpFormat::kFrameSize / PAGE_SIZE;
+    for (auto& block : slot_blocks) FlushBlock(block);
+    if (options.compress && !write_failed) {
+        // The tables become frames over [0, data_offset); the stored pages already sit above it.
+        uint64_t logical_size = flat_size;
+        if (options.optimize) {
+            header.stored_page_count = page_store.StoredCount();
+            logical_size = header.data_offset + next_block.load() * PAGES_PER_BLOCK * PAGE_SIZE;
+            std::vector<char> tables((size_t)header.data_offset, 0);
+            std::memcpy(tables.data(), &header, sizeof(header));
+            std::memcpy(tables.data() + header.region_table_offset, region_table.data(), region_table.size() * sizeof(DumpFormat::RegionEntry));
+            std::memcpy(tables.data() + header.page_table_offset, page_table.data(), page_table.size() * sizeof(uint64_t));
+            std::memcpy(tables.data() + header.base_name_offset, base_name.data(), base_name.size());
+            for (size_t offset = 0; offset < tables.size() && !write_failed; offset += DumpFormat::kFrameSize) {
+                if (!frame_out.WriteFrame(offset, tables.data() + offset, std::min<size_t>(DumpFormat::kFrameSize, tables.size() - offset))) write_failed = true;
+            }
+        }
+        if (!frame_out.Finish(logical_size)) write_failed = true;
+        bytes_written = frame_out.BytesWritten();
+    }
+    else if (plain_container && !write_failed) {
+        if (!out_file.WriteAt(0, container_headers.data(), container_headers.size())) write_failed = true;
+        bytes_written += container_headers.size();
+    }
+    else if (options.optimize && !write_failed) {
+        // Counted in slots: a resumed dump can have unused slots among the stored pages.
+        header.stored_page_count = page_store.SlotCount();
+        bytes_written = header.data_offset + header.stored_page_count * PAGE_SIZE;
+        if (!out_file.WriteAt(0, &header, sizeof(header)) ||
+            !out_file.WriteAt(header.region_table_offset, region_table.data(), region_table.size() * sizeof(DumpFormat::RegionEntry)) ||
+            !out_file.WriteAt(header.page_table_offset, page_table.data(), page_table.size() * sizeof(uint64_t)) ||
+            !out_file.WriteAt(header.base_name_offset, base_name.data(), base_name.size()) ||
+            !out_file.Truncate(bytes_written)) {
+            write_failed = true;
+        }
+    }
+    out_file.Close();
+    if (write_failed) { error = "ERROR: Failed while writing output file: " + output_path; return false; }
+    // The page hashes let a later dump of this process be taken incrementally against this one.
+    std::string sidecar_error;
+    if (options.optimize && !PageHashIndex::Save(output_path, header.dump_id, region_table, page_hashes, sidecar_error)) {
+        error = "ERROR: " + sidecar_error;
+        return false;
+    }
+    if (journaling) journal.Remove();
+    return true;
+}
+
+void RunDumpJobs(const std::vector<BinaryDumpJob*>& jobs, int thread_count, ResourceLimits* limits, const std::function<void(uint64_t, uint64_t)>& progress) {
+    std::vector<std::pair<BinaryDumpJob*, size_t>> work;
+    uint64_t total_bytes = 0;
+    uint64_t resumed_bytes = 0;
+    for (BinaryDumpJob* job : jobs) {
+        for (size_t c = 0; c < job->ChunkCount(); ++c) {
+            total_bytes += job->ChunkBytes(c);
+            if (job->IsChunkDone(c)) resumed_bytes += job->ChunkBytes(c);
+            else work.push_back({ job, c });
+        }
+    }
+    std::atomic<size_t> next_work = 0;
+    std::atomic<size_t> work_done = 0;
+    std::atomic<uint64_t> bytes_done = resumed_bytes;
+    const size_t progress_update_interval = std::max<size_t>(1, work.size() / 100);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t]() {
+            DumpWorkerBuffers buffers;
+            WorkerThrottle throttle(limits);
+            for (size_t w = next_work++; w < work.size(); w = next_work++) {
+                throttle.Begin();
+                work[w].first->ProcessChunk(work[w].second, t, buffers);
+                throttle.End();
+                const uint64_t done_bytes = bytes_done += work[w].first->ChunkBytes(work[w].second);
+                if ((work_done.fetch_add(1) + 1) % progress_update_interval == 0) progress(done_bytes, total_bytes);
+            }
+            });
+    }
+    for (auto& th : threads) th.join();
+}
+
+std::vector<std::vector<MEMORY_BASIC_INFORMATION>> SplitDumpSegments(const std::vector<MEMORY_BASIC_INFORMATION>& regions, uint64_t segment_size) {
+    segment_size = std::max<uint64_t>(DumpFormat::kPageSize, segment_size / DumpFormat::kPageSize * DumpFormat::kPageSize);
+    std::vector<std::vector<MEMORY_BASIC_INFORMATION>> segments(1);
+    uint64_t used = 0;
+    for (const auto& region : regions) {
+        uint64_t done = 0;
+        while (done < region.RegionSize) {
+            if (used == segment_size) { segments.emplace_back(); used = 0; }
+            MEMORY_BASIC_INFORMATION part = region;
+            part.BaseAddress = (char*)region.BaseAddress + done;
+            part.RegionSize = (SIZE_T)std::min<uint64_t>(region.RegionSize - done, segment_size - used);
+            segments.back().push_back(part);
+            used += part.RegionSize;
+            done += part.RegionSize;
+        }
+    }
+    return segments;
+}
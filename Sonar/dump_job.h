@@ -0,0 +1,128 @@
+#pragma once
+
+#include "backend.h"
+#include "dump_format.h"
+#include "dump_writer.h"
+#include "frame_file.h"
+#include "hash128.hpp"
+#include "job_journal.h"
+#include "page_hashes.h"
+#include "page_store.h"
+#include "throttle.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <windows.h>
+
+// Read buffers for one pool worker. They are sized for a chunk and shared by every job the worker
+// touches, so running many jobs does not multiply buffer memory.
+struct DumpWorkerBuffers {
+    std::vector<char> buffer;
+    std::vector<char> page_ok;
+    std::vector<char> page_skip;
+};
+
+// Writes one binary dump file from a set of regions of one process. The layout is planned in
+// Prepare(), so every chunk already knows where it lands in the output and workers write with
+// positional I/O instead of sharing a stream behind a lock. Jobs own no threads: ProcessChunk() is
+// called by a shared pool (RunDumpJobs), so the segments of a dump, or the dumps of several
+// processes, all draw from the same workers.
+class BinaryDumpJob {
+public:
+    static const size_t CHUNK_SIZE = 1024 * 1024;
+
+    BinaryDumpJob(HANDLE target, DWORD target_id, std::vector<MEMORY_BASIC_INFORMATION> target_regions, std::string path, const DumpOptions& dump_options);
+    BinaryDumpJob(const BinaryDumpJob&) = delete;
+    BinaryDumpJob& operator=(const BinaryDumpJob&) = delete;
+
+    // Plans the layout, loads the base dump's hashes for incremental dumps and opens the output.
+    // `worker_count` is the size of the pool that will call ProcessChunk().
+    bool Prepare(int worker_count, std::string& error);
+    size_t ChunkCount() const { return chunks.size(); }
+    // Chunks restored from a checkpoint journal need no work.
+    bool IsChunkDone(size_t chunk_index) const { return !chunk_done.empty() && chunk_done[chunk_index]; }
+    size_t ResumedChunks() const { return resumed_chunks; }
+    uint64_t ChunkBytes(size_t chunk_index) const { return chunks[chunk_index].size; }
+    // Reads and writes one chunk. Thread-safe; `worker` identifies the calling pool thread.
+    void ProcessChunk(size_t chunk_index, int worker, DumpWorkerBuffers& buffers);
+    // Writes the tables and headers once every chunk is processed, then the page hash sidecar, and
+    // removes the checkpoint journal.
+    bool Finish(std::string& error);
+
+    const std::string& OutputPath() const { return output_path; }
+    const std::vector<DumpFormat::RegionEntry>& RegionTable() const { return region_table; }
+    const DumpFormat::FileHeader& Header() const { return header; }
+    uint64_t FlatSize() const { return flat_size; }
+    uint64_t BytesWritten() const { return bytes_written; }
+    uint64_t BytesScanned() const { return bytes_scanned; }
+    uint64_t BytesElided() const { return bytes_elided; }
+    uint64_t BytesFromBase() const { return bytes_from_base; }
+
+private:
+    // Compressed optimized dumps give each worker a block of consecutive slots (one frame's worth),
+    // so new pages are buffered locally and a full block is compressed and written as one frame.
+    struct SlotBlock {
+        uint64_t block = UINT64_MAX;
+        size_t used = 0;
+        std::vector<char> data;
+    };
+
+    void FlushBlock(SlotBlock& block);
+    uint64_t AllocateSlot(SlotBlock& block);
+    bool ResolveWithoutData(const char* page_data, size_t page_len, uint64_t address, uint64_t page_index, Hash128::Digest& digest);
+    bool OpenJournal(std::string& error);
+    void ReplayChunk(uint64_t chunk_index, const char* payload, size_t size, std::vector<uint64_t>& written_slots);
+
+    HANDLE process;
+    DWORD process_id;
+    std::vector<MEMORY_BASIC_INFORMATION> regions;
+    std::string output_path;
+    DumpOptions options;
+
+    std::vector<DumpFormat::RegionEntry> region_table;
+    std::vector<DumpChunk> chunks;
+    uint64_t page_count = 0;
+    uint64_t flat_size = 0;
+
+    bool plain_container = false;
+    std::vector<char> container_headers;
+    uint64_t image_offset = 0;
+
+    bool incremental = false;
+    PageHashIndex base_hashes;
+    std::string base_name;
+    DumpFormat::FileHeader header = {};
+    std::vector<uint64_t> page_table;
+    std::vector<Hash128::Digest> page_hashes;
+    PageStore page_store;
+
+    PositionalFile out_file;
+    FrameWriter frame_out;
+    std::vector<SlotBlock> slot_blocks;
+    std::atomic<uint64_t> next_block{ 0 };
+
+    // Checkpointing: one journal record per finished chunk. Optimized dumps record the chunk's page
+    // references, digests and the slots it wrote, which is enough to rebuild the page store.
+    bool journaling = false;
+    JobJournal journal;
+    std::vector<char> chunk_done;
+    size_t resumed_chunks = 0;
+
+    std::atomic<uint64_t> bytes_written{ 0 };
+    std::atomic<uint64_t> bytes_scanned{ 0 };
+    std::atomic<uint64_t> bytes_elided{ 0 };
+    std::atomic<uint64_t> bytes_from_base{ 0 };
+    std::atomic<bool> write_failed{ false };
+};
+
+// Runs every chunk of every job on one pool of `thread_count` workers, handing out chunks from a
+// single queue. `progress` is called with bytes processed and the total across all jobs. Workers
+// follow `limits` (may be null) for CPU share and priority.
+void RunDumpJobs(const std::vector<BinaryDumpJob*>& jobs, int thread_count, ResourceLimits* limits, const std::function<void(uint64_t, uint64_t)>& progress);
+
+// Splits regions into consecutive segments of at most `segment_size` bytes of memory each. Regions
+// larger than a segment are cut at page boundaries.
+std::vector<std::vector<MEMORY_BASIC_INFORMATION>> SplitDumpSegments(const std::vector<MEMORY_BASIC_INFORMATION>& regions, uint64_t segment_size);
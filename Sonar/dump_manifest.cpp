@@ -0,0 +1,84 @@
+#include "dump_manifest.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace DumpManifest {
+
+    std::string SegmentPath(const std::string& manifest_path, size_t index) {
+        std::filesystem::path path(manifest_path);
+        char suffix[32];
+        snprintf(suffix, sizeof(suffix), ".seg%04zu", index);
+        std::filesystem::path segment = path.parent_path() / (path.stem().string() + suffix + path.extension().string());
+        return segment.string();
+    }
+
+    bool IsManifest(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        char magic[16] = {};
+        in.read(magic, (std::streamsize)std::strlen(kMagic));
+        return in.gcount() == (std::streamsize)std::strlen(kMagic) && std::memcmp(magic, kMagic, std::strlen(kMagic)) == 0;
+    }
+
+    bool Save(const std::string& path, const Manifest& manifest, std::string& error) {
+        std::ofstream out(path, std::ios::out | std::ios::trunc);
+        if (!out.is_open()) {
+            error = "Could not create segment manifest " + path;
+            return false;
+        }
+        out << kMagic << ' ' << kVersion << '\n';
+        out << "pid " << manifest.process_id << '\n';
+        for (const auto& segment : manifest.segments) {
+            out << "segment " << std::hex << segment.first_address << ' ' << segment.end_address << std::dec
+                << ' ' << segment.first_page << ' ' << segment.page_count << std::hex
+                << ' ' << segment.dump_id[0] << ' ' << segment.dump_id[1] << std::dec << ' ' << segment.file_name << '\n';
+        }
+        out.close();
+        if (!out) {
+            error = "Failed while writing segment manifest " + path;
+            return false;
+        }
+        return true;
+    }
+
+    bool Load(const std::string& path, Manifest& manifest, std::string& error) {
+        std::ifstream in(path);
+        std::string magic;
+        uint32_t version = 0;
+        if (!(in >> magic >> version) || magic != kMagic) {
+            error = path + " is not a segment manifest.";
+            return false;
+        }
+        if (version == 0 || version > kVersion) {
+            error = "Unsupported segment manifest version in " + path;
+            return false;
+        }
+        manifest = Manifest();
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            std::string key;
+            if (!(fields >> key)) continue;
+            if (key == "pid") { fields >> manifest.process_id; continue; }
+            if (key != "segment") continue;
+            Segment segment;
+            fields >> std::hex >> segment.first_address >> segment.end_address >> std::dec
+                   >> segment.first_page >> segment.page_count >> std::hex >> segment.dump_id[0] >> segment.dump_id[1] >> std::ws;
+            // The file name is the rest of the line, so it may contain spaces.
+            std::getline(fields, segment.file_name);
+            if (fields.fail() || segment.file_name.empty()) {
+                error = "Malformed segment entry in " + path + ": " + line;
+                return false;
+            }
+            manifest.segments.push_back(segment);
+        }
+        if (manifest.segments.empty()) {
+            error = "Segment manifest " + path + " lists no segments.";
+            return false;
+        }
+        return true;
+    }
+
+} // namespace DumpManifest
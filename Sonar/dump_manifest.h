@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Manifest of a segmented dump. A segmented dump is a set of ordinary structured dumps, each
+// covering a consecutive slice of the address space with its own local region table, plus this
+// small text file that lists them in order:
+//
+//   SONAR-SEGMENTS 1
+//   pid <pid>
+//   segment <first address> <end address> <first page> <page count> <dump id> <dump id> <file>
+//
+// Addresses and dump ids are hexadecimal. Segment files are recorded by name only and resolved
+// next to the manifest, so the set can be moved as a whole. DumpReader opens a manifest as one
+// dump spanning every segment.
+namespace DumpManifest {
+
+    constexpr const char* kMagic = "SONAR-SEGMENTS";
+    constexpr uint32_t kVersion = 1;
+
+    struct Segment {
+        std::string file_name;
+        uint64_t first_address = 0;
+        uint64_t end_address = 0;
+        uint64_t first_page = 0;    // Page index of the segment's first page in the combined image.
+        uint64_t page_count = 0;
+        uint64_t dump_id[2] = {};
+    };
+
+    struct Manifest {
+        uint32_t process_id = 0;
+        std::vector<Segment> segments;
+    };
+
+    // Segment file for `index`: "dump.bin" becomes "dump.seg0000.bin".
+    std::string SegmentPath(const std::string& manifest_path, size_t index);
+
+    // True if the file starts with the manifest magic.
+    bool IsManifest(const std::string& path);
+
+    bool Save(const std::string& path, const Manifest& manifest, std::string& error);
+    bool Load(const std::string& path, Manifest& manifest, std::string& error);
+
+} // namespace DumpManifest
@@ -0,0 +1,231 @@
+#include "dump_reader.h"
+#include "dump_manifest.h"
+#include <algorithm>
+#include <filesystem>
+
+namespace {
+    // Longest chain of incremental dumps (and segments) followed before giving up.
+    constexpr size_t kMaxChainDepth = 64;
+}
+
+bool DumpReader::Open(const std::string& path, std::string& error) {
+    return Open(path, {}, error);
+}
+
+bool DumpReader::Open(const std::string& path, const std::vector<std::string>& chain, std::string& error) {
+    structured = false;
+    base.reset();
+    segments.clear();
+    segment_first_page.clear();
+    std::error_code path_error;
+    std::string key = std::filesystem::weakly_canonical(path, path_error).string();
+    if (path_error) key = std::filesystem::absolute(path, path_error).string();
+    if (std::find(chain.begin(), chain.end(), key) != chain.end()) {
+        error = "Error: " + path + " refers back to itself through its base dumps";
+        return false;
+    }
+    if (chain.size() >= kMaxChainDepth) {
+        error = "Error: The base dump chain of " + path + " is too long";
+        return false;
+    }
+    std::vector<std::string> inner = chain;
+    inner.push_back(key);
+    if (DumpManifest::IsManifest(path)) return OpenSegmented(path, inner, error);
+    if (!source.Open(path, error)) return false;
+    logical_size = source.Size();
+    if (logical_size < sizeof(DumpFormat::FileHeader)) return true;
+
+    if (source.ReadAt(0, reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header) || !DumpFormat::HasMagic(header.magic)) {
+        // Not a structured dump; treat it as a raw byte image.
+        return true;
+    }
+    if (header.version == 0 || header.version > DumpFormat::kVersion || header.page_size == 0) {
+        error = "Error: Unsupported structured dump version in " + path;
+        return false;
+    }
+
+    // Counts come from the file; check them against its size before allocating, so a truncated or
+    // corrupt dump is reported instead of failing the allocation.
+    const uint64_t file_size = source.Size();
+    auto fits = [&](uint64_t offset, uint64_t count, uint64_t entry_size) { return offset <= file_size && count <= (file_size - offset) / entry_size; };
+    if (!fits(header.region_table_offset, header.region_count, sizeof(DumpFormat::RegionEntry)) ||
+        !fits(header.page_table_offset, header.page_count, sizeof(uint64_t))) {
+        error = "Error: Structured dump tables are truncated in " + path;
+        return false;
+    }
+    if (header.page_count > UINT64_MAX / header.page_size) {
+        error = "Error: Structured dump image size overflows in " + path;
+        return false;
+    }
+    regions.resize((size_t)header.region_count);
+    page_table.resize((size_t)header.page_count);
+    const size_t region_bytes = regions.size() * sizeof(DumpFormat::RegionEntry);
+    const size_t page_table_bytes = page_table.size() * sizeof(uint64_t);
+    if (source.ReadAt(header.region_table_offset, reinterpret_cast<char*>(regions.data()), region_bytes) != region_bytes ||
+        source.ReadAt(header.page_table_offset, reinterpret_cast<char*>(page_table.data()), page_table_bytes) != page_table_bytes) {
+        error = "Error: Structured dump tables are truncated in " + path;
+        return false;
+    }
+
+    if ((header.flags & DumpFormat::FLAG_INCREMENTAL) && !OpenBase(path, inner, error)) return false;
+
+    region_index.clear();
+    region_index.reserve(regions.size());
+    for (size_t i = 0; i < regions.size(); ++i) region_index.push_back({ regions[i].base_address, i });
+    std::sort(region_index.begin(), region_index.end());
+
+    structured = true;
+    logical_size = header.page_count * header.page_size;
+    return true;
+}
+
+bool DumpReader::OpenBase(const std::string& path, const std::vector<std::string>& chain, std::string& error) {
+    std::string base_path((size_t)header.base_name_length, '\0');
+    if (source.ReadAt(header.base_name_offset, base_path.data(), base_path.size()) != base_path.size()) {
+        error = "Error: Base dump name is truncated in " + path;
+        return false;
+    }
+    // Prefer the recorded path; fall back to the same file name next to this dump, so a chain
+    // can be moved to another directory as a whole.
+    std::filesystem::path moved = std::filesystem::path(path).parent_path() / std::filesystem::path(base_path).filename();
+    base = std::make_unique<DumpReader>();
+    std::string base_error;
+    if (!base->Open(base_path, chain, base_error) && !base->Open(moved.string(), chain, base_error)) {
+        error = "Error: Could not open base dump " + base_path + " of incremental dump " + path + ". " + base_error;
+        return false;
+    }
+    const auto& base_header = base->Header();
+    if (!base->IsStructured() || base_header.dump_id[0] != header.base_id[0] || base_header.dump_id[1] != header.base_id[1] || base_header.page_size != header.page_size) {
+        error = "Error: " + base_path + " is not the base dump of " + path;
+        return false;
+    }
+    return true;
+}
+
+bool DumpReader::OpenSegmented(const std::string& path, const std::vector<std::string>& chain, std::string& error) {
+    DumpManifest::Manifest manifest;
+    if (!DumpManifest::Load(path, manifest, error)) return false;
+    const std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    regions.clear();
+    for (const auto& entry : manifest.segments) {
+        const std::string segment_path = (directory / entry.file_name).string();
+        auto segment = std::make_unique<DumpReader>();
+        std::string segment_error;
+        if (!segment->Open(segment_path, chain, segment_error)) {
+            error = "Error: Could not open segment " + segment_path + ". " + segment_error;
+            return false;
+        }
+        const auto& segment_header = segment->Header();
+        if (!segment->IsStructured() || segment_header.dump_id[0] != entry.dump_id[0] || segment_header.dump_id[1] != entry.dump_id[1] ||
+            segment_header.page_count != entry.page_count || (!segments.empty() && segment_header.page_size != header.page_size)) {
+            error = "Error: " + segment_path + " does not match its entry in " + path;
+            return false;
+        }
+        // Region tables are local to each segment; rebase their page indices into the combined image.
+        const uint64_t first_page = segment_first_page.empty() ? 0 : segment_first_page.back() + segments.back()->Header().page_count;
+        for (auto region : segment->Regions()) {
+            region.first_page += first_page;
+            regions.push_back(region);
+        }
+        if (segments.empty()) header = segment_header;
+        segment_first_page.push_back(first_page);
+        segments.push_back(std::move(segment));
+    }
+    header.flags &= ~DumpFormat::FLAG_INCREMENTAL;
+    header.region_count = regions.size();
+    header.page_count = segment_first_page.back() + segments.back()->Header().page_count;
+    if (header.page_count > UINT64_MAX / header.page_size) {
+        error = "Error: Segmented dump image size overflows in " + path;
+        return false;
+    }
+
+    region_index.clear();
+    region_index.reserve(regions.size());
+    for (size_t i = 0; i < regions.size(); ++i) region_index.push_back({ regions[i].base_address, i });
+    std::sort(region_index.begin(), region_index.end());
+
+    structured = true;
+    logical_size = header.page_count * header.page_size;
+    return true;
+}
+
+size_t DumpReader::SegmentFor(uint64_t page_index) const {
+    return (size_t)(std::upper_bound(segment_first_page.begin(), segment_first_page.end(), page_index) - segment_first_page.begin()) - 1;
+}
+
+uint64_t DumpReader::PageRef(uint64_t page_index) const {
+    if (segments.empty()) return page_table[page_index];
+    const size_t s = SegmentFor(page_index);
+    return segments[s]->PageRef(page_index - segment_first_page[s]);
+}
+
+bool DumpReader::ReadPage(uint64_t page_index, char* out) const {
+    if (!segments.empty()) {
+        const size_t s = SegmentFor(page_index);
+        return segments[s]->ReadPage(page_index - segment_first_page[s], out);
+    }
+    const uint64_t ref = page_table[page_index];
+    if (DumpFormat::PageRefKind(ref) == DumpFormat::PAGE_BASE) {
+        const uint64_t base_page = DumpFormat::PageRefPayload(ref);
+        if (!base || base_page >= base->Header().page_count) return false;
+        return base->ReadPage(base_page, out);
+    }
+    if (DumpFormat::PageRefKind(ref) == DumpFormat::PAGE_CONSTANT) {
+        std::fill(out, out + header.page_size, static_cast<char>(DumpFormat::PageRefPayload(ref)));
+        return true;
+    }
+    if (DumpFormat::PageRefKind(ref) != DumpFormat::PAGE_STORED) {
+        std::fill(out, out + header.page_size, 0);
+        return true;
+    }
+    return source.ReadAt(header.data_offset + DumpFormat::PageRefPayload(ref) * header.page_size, out, header.page_size) == header.page_size;
+}
+
+size_t DumpReader::Read(uint64_t offset, char* buffer, size_t size) const {
+    if (offset >= logical_size) return 0;
+    size = static_cast<size_t>(std::min<uint64_t>(size, logical_size - offset));
+
+    if (!structured) return source.ReadAt(offset, buffer, size);
+
+    thread_local std::vector<char> page;
+    size_t copied = 0;
+    while (copied < size) {
+        const uint64_t position = offset + copied;
+        const uint64_t page_index = position / header.page_size;
+        const size_t in_page = static_cast<size_t>(position % header.page_size);
+        const size_t take = std::min(size - copied, static_cast<size_t>(header.page_size) - in_page);
+        // Whole pages go straight into the caller's buffer.
+        if (take == header.page_size) {
+            if (!ReadPage(page_index, buffer + copied)) break;
+        }
+        else {
+            page.resize(header.page_size);
+            if (!ReadPage(page_index, page.data())) break;
+            std::copy(page.begin() + in_page, page.begin() + in_page + take, buffer + copied);
+        }
+        copied += take;
+    }
+    return copied;
+}
+
+const DumpFormat::RegionEntry* DumpReader::FindRegion(uint64_t address) const {
+    auto it = std::upper_bound(region_index.begin(), region_index.end(), address, [](uint64_t value, const auto& entry) { return value < entry.first; });
+    if (it == region_index.begin()) return nullptr;
+    const auto& region = regions[(it - 1)->second];
+    return (address - region.base_address < region.size) ? &region : nullptr;
+}
+
+size_t DumpReader::ReadAddress(uint64_t address, char* buffer, size_t size) const {
+    if (!structured) return 0;
+    size_t copied = 0;
+    while (copied < size) {
+        const DumpFormat::RegionEntry* region = FindRegion(address + copied);
+        if (!region) break;
+        const uint64_t in_region = address + copied - region->base_address;
+        const size_t take = (size_t)std::min<uint64_t>(size - copied, region->size - in_region);
+        const size_t got = Read(region->first_page * header.page_size + in_region, buffer + copied, take);
+        copied += got;
+        if (got != take) break;
+    }
+    return copied;
+}
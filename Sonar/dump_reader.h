@@ -0,0 +1,62 @@
+#pragma once
+
+#include "dump_format.h"
+#include "frame_file.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Reads Sonar binary dumps. Raw dumps are exposed as-is; structured (optimized) dumps are
+// reconstructed page by page, so callers always see the flat, region-concatenated image.
+// Compressed dumps are decompressed transparently, one frame at a time. Incremental dumps open
+// their base dump (and its base, and so on), so any snapshot in a chain reads as a full image.
+// Structured dumps can also be read by process address through an interval index over the region
+// table. The file is memory-mapped, so a point lookup costs a binary search and a memcpy (plus one
+// frame inflation on a cache miss for compressed dumps). A segment manifest opens as one dump whose
+// image, region table and page table span all of its segments. All read methods are thread-safe.
+class DumpReader {
+public:
+    bool Open(const std::string& path, std::string& error);
+
+    bool IsStructured() const { return structured; }
+    bool IsCompressed() const { return source.IsFramed(); }
+    bool IsSegmented() const { return !segments.empty(); }
+    uint64_t LogicalSize() const { return logical_size; }
+    const DumpFormat::FileHeader& Header() const { return header; }
+    const std::vector<DumpFormat::RegionEntry>& Regions() const { return regions; }
+    uint64_t PageRef(uint64_t page_index) const;
+    // The dump this one was taken against, or null for a full dump.
+    const DumpReader* Base() const { return base.get(); }
+
+    // Reads up to `size` bytes of the flat image starting at `offset`. Returns the number of bytes read.
+    size_t Read(uint64_t offset, char* buffer, size_t size) const;
+
+    // Structured dumps only: the region containing `address`, or null if it was not dumped.
+    const DumpFormat::RegionEntry* FindRegion(uint64_t address) const;
+    // Reads process memory at `address` as captured in the dump. Reads continue across adjacent
+    // regions and stop at the first address that was not dumped. Returns the number of bytes read.
+    size_t ReadAddress(uint64_t address, char* buffer, size_t size) const;
+
+private:
+    // `chain` holds the dumps that lead to this one through base or segment references, so a
+    // dump that (indirectly) names itself is rejected instead of opened forever.
+    bool Open(const std::string& path, const std::vector<std::string>& chain, std::string& error);
+    bool ReadPage(uint64_t page_index, char* out) const;
+    bool OpenBase(const std::string& path, const std::vector<std::string>& chain, std::string& error);
+    bool OpenSegmented(const std::string& path, const std::vector<std::string>& chain, std::string& error);
+    // Segmented dumps: the segment holding `page_index`.
+    size_t SegmentFor(uint64_t page_index) const;
+
+    DumpFileSource source;
+    bool structured = false;
+    uint64_t logical_size = 0;
+    DumpFormat::FileHeader header = {};
+    std::vector<DumpFormat::RegionEntry> regions;
+    std::vector<uint64_t> page_table;
+    std::vector<std::pair<uint64_t, size_t>> region_index;  // (base address, region) sorted by address.
+    std::unique_ptr<DumpReader> base;
+    std::vector<std::unique_ptr<DumpReader>> segments;
+    std::vector<uint64_t> segment_first_page;
+};
@@ -0,0 +1,276 @@
+#include "dump_writer.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+namespace {
+    // Handles are opened for overlapped I/O: a synchronous file object serializes every read and
+    // write through its lock, while overlapped requests at explicit offsets run concurrently. Each
+    // thread waits on its own event, created on first use.
+    struct IoEvent {
+        HANDLE event = CreateEventW(NULL, TRUE, FALSE, NULL);
+        ~IoEvent() { if (event) CloseHandle(event); }
+    };
+    thread_local IoEvent io_event;
+
+    OVERLAPPED MakeOverlapped(uint64_t offset) {
+        OVERLAPPED ov = {};
+        ov.Offset = (DWORD)(offset & 0xFFFFFFFFu);
+        ov.OffsetHigh = (DWORD)(offset >> 32);
+        ov.hEvent = io_event.event;
+        return ov;
+    }
+
+    // Completes a request issued with `ov`; `issued` is what ReadFile/WriteFile/DeviceIoControl returned.
+    bool FinishIo(HANDLE handle, OVERLAPPED& ov, BOOL issued, DWORD& transferred) {
+        if (!issued && GetLastError() != ERROR_IO_PENDING) return false;
+        return GetOverlappedResult(handle, &ov, &transferred, TRUE) != 0;
+    }
+}
+
+PositionalFile::~PositionalFile() { Close(); }
+
+bool PositionalFile::Open(const std::string& path, std::string& error) {
+    Close();
+    HANDLE h = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, NULL);
+    if (h == INVALID_HANDLE_VALUE) {
+        error = "Could not create " + path + " (error " + std::to_string(GetLastError()) + ")";
+        return false;
+    }
+    handle = h;
+    return true;
+}
+
+bool PositionalFile::OpenExisting(const std::string& path, std::string& error) {
+    Close();
+    HANDLE h = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, NULL);
+    if (h == INVALID_HANDLE_VALUE) {
+        error = "Could not open " + path + " (error " + std::to_string(GetLastError()) + ")";
+        return false;
+    }
+    handle = h;
+    return true;
+}
+
+bool PositionalFile::OpenForRead(const std::string& path, std::string& error) {
+    Close();
+    HANDLE h = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, NULL);
+    if (h == INVALID_HANDLE_VALUE) {
+        error = "Could not open " + path + " (error " + std::to_string(GetLastError()) + ")";
+        return false;
+    }
+    handle = h;
+    return true;
+}
+
+bool PositionalFile::IsOpen() const { return handle != nullptr; }
+
+bool PositionalFile::MakeSparse() {
+    OVERLAPPED ov = MakeOverlapped(0);
+    DWORD returned = 0;
+    sparse = FinishIo(handle, ov, DeviceIoControl(handle, FSCTL_SET_SPARSE, NULL, 0, NULL, 0, &returned, &ov), returned);
+    return sparse;
+}
+
+uint64_t PositionalFile::Size() const {
+    LARGE_INTEGER size;
+    if (!handle || !GetFileSizeEx(handle, &size)) return 0;
+    return (uint64_t)size.QuadPart;
+}
+
+bool PositionalFile::Preallocate(uint64_t size) {
+    FILE_END_OF_FILE_INFO end = {};
+    end.EndOfFile.QuadPart = (LONGLONG)size;
+    return SetFileInformationByHandle(handle, FileEndOfFileInfo, &end, sizeof(end)) != 0;
+}
+
+bool PositionalFile::WriteAt(uint64_t offset, const void* data, size_t size) {
+    if (write_limit) write_limit->Consume(size);
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        OVERLAPPED ov = MakeOverlapped(offset);
+        DWORD to_write = (DWORD)std::min<size_t>(size, 1u << 30);
+        DWORD written = 0;
+        if (!FinishIo(handle, ov, WriteFile(handle, bytes, to_write, NULL, &ov), written) || written == 0) return false;
+        bytes += written;
+        offset += written;
+        size -= written;
+    }
+    return true;
+}
+
+bool PositionalFile::ZeroRange(uint64_t offset, uint64_t size) {
+    if (size == 0) return true;
+    if (sparse) {
+        FILE_ZERO_DATA_INFORMATION range = {};
+        range.FileOffset.QuadPart = (LONGLONG)offset;
+        range.BeyondFinalZero.QuadPart = (LONGLONG)(offset + size);
+        OVERLAPPED ov = MakeOverlapped(0);
+        DWORD returned = 0;
+        if (FinishIo(handle, ov, DeviceIoControl(handle, FSCTL_SET_ZERO_DATA, &range, sizeof(range), NULL, 0, &returned, &ov), returned)) return true;
+    }
+    return WriteZeros(offset, size);
+}
+
+size_t PositionalFile::ReadAt(uint64_t offset, void* data, size_t size) const {
+    char* bytes = static_cast<char*>(data);
+    size_t total = 0;
+    while (total < size) {
+        OVERLAPPED ov = MakeOverlapped(offset);
+        DWORD to_read = (DWORD)std::min<size_t>(size - total, 1u << 30);
+        DWORD read = 0;
+        // Reading at or past the end fails with ERROR_HANDLE_EOF, which ends the loop like a short read.
+        if (!FinishIo(handle, ov, ReadFile(handle, bytes + total, to_read, NULL, &ov), read) || read == 0) break;
+        total += read;
+        offset += read;
+    }
+    return total;
+}
+
+bool PositionalFile::Truncate(uint64_t size) { return Preallocate(size); }
+
+void PositionalFile::Close() {
+    sparse = false;
+    if (handle) {
+        CloseHandle(handle);
+        handle = nullptr;
+    }
+}
+
+#else
+
+PositionalFile::~PositionalFile() { Close(); }
+
+bool PositionalFile::Open(const std::string& path, std::string& error) {
+    Close();
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        error = "Could not create " + path + " (" + std::strerror(errno) + ")";
+        return false;
+    }
+    return true;
+}
+
+bool PositionalFile::OpenExisting(const std::string& path, std::string& error) {
+    Close();
+    fd = ::open(path.c_str(), O_RDWR);
+    if (fd < 0) {
+        error = "Could not open " + path + " (" + std::strerror(errno) + ")";
+        return false;
+    }
+    return true;
+}
+
+bool PositionalFile::OpenForRead(const std::string& path, std::string& error) {
+    Close();
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "Could not open " + path + " (" + std::strerror(errno) + ")";
+        return false;
+    }
+    return true;
+}
+
+bool PositionalFile::IsOpen() const { return fd >= 0; }
+
+// Files are sparse by default here; this only stops Preallocate from allocating the holes.
+bool PositionalFile::MakeSparse() {
+    sparse = true;
+    return true;
+}
+
+uint64_t PositionalFile::Size() const {
+    struct stat st;
+    if (fd < 0 || ::fstat(fd, &st) != 0) return 0;
+    return (uint64_t)st.st_size;
+}
+
+bool PositionalFile::Preallocate(uint64_t size) {
+#if defined(__linux__)
+    if (!sparse && ::posix_fallocate(fd, 0, (off_t)size) == 0) return true;
+#endif
+    return ::ftruncate(fd, (off_t)size) == 0;
+}
+
+bool PositionalFile::WriteAt(uint64_t offset, const void* data, size_t size) {
+    if (write_limit) write_limit->Consume(size);
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::pwrite(fd, bytes, size, (off_t)offset);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        bytes += written;
+        offset += (uint64_t)written;
+        size -= (size_t)written;
+    }
+    return true;
+}
+
+bool PositionalFile::ZeroRange(uint64_t offset, uint64_t size) {
+    if (size == 0) return true;
+#if defined(__linux__)
+    if (sparse && ::fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, (off_t)offset, (off_t)size) == 0) return true;
+#endif
+    return WriteZeros(offset, size);
+}
+
+size_t PositionalFile::ReadAt(uint64_t offset, void* data, size_t size) const {
+    char* bytes = static_cast<char*>(data);
+    size_t total = 0;
+    while (total < size) {
+        ssize_t read = ::pread(fd, bytes + total, size - total, (off_t)(offset + total));
+        if (read < 0 && errno == EINTR) continue;
+        if (read <= 0) break;
+        total += (size_t)read;
+    }
+    return total;
+}
+
+bool PositionalFile::Truncate(uint64_t size) { return ::ftruncate(fd, (off_t)size) == 0; }
+
+void PositionalFile::Close() {
+    sparse = false;
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+#endif
+
+bool PositionalFile::WriteZeros(uint64_t offset, uint64_t size) {
+    static const std::vector<char> zeros(64 * 1024, 0);
+    while (size > 0) {
+        const size_t take = (size_t)std::min<uint64_t>(size, zeros.size());
+        if (!WriteAt(offset, zeros.data(), take)) return false;
+        offset += take;
+        size -= take;
+    }
+    return true;
+}
+
+std::vector<DumpChunk> PlanDumpChunks(const std::vector<DumpFormat::RegionEntry>& regions, uint32_t page_size, uint64_t chunk_size) {
+    chunk_size = std::max<uint64_t>(page_size, chunk_size / page_size * page_size);
+    std::vector<DumpChunk> chunks;
+    uint64_t flat_offset = 0;
+    for (size_t i = 0; i < regions.size(); ++i) {
+        const auto& region = regions[i];
+        for (uint64_t done = 0; done < region.size; done += chunk_size) {
+            const uint64_t size = std::min(chunk_size, region.size - done);
+            chunks.push_back({ i, region.base_address + done, size, flat_offset + done, region.first_page + done / page_size });
+        }
+        flat_offset += region.size;
+    }
+    return chunks;
+}
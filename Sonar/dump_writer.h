@@ -0,0 +1,65 @@
+#pragma once
+
+#include "dump_format.h"
+#include "throttle.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// File accessed at explicit offsets from many threads at once (overlapped WriteFile/ReadFile on a
+// handle opened with FILE_FLAG_OVERLAPPED on Windows, pwrite/pread elsewhere), so workers never
+// share a file position or a lock.
+class PositionalFile {
+public:
+    PositionalFile() = default;
+    ~PositionalFile();
+    PositionalFile(const PositionalFile&) = delete;
+    PositionalFile& operator=(const PositionalFile&) = delete;
+
+    // Creates (or truncates) the file for writing.
+    bool Open(const std::string& path, std::string& error);
+    // Opens an existing file for reading and writing, keeping its contents.
+    bool OpenExisting(const std::string& path, std::string& error);
+    // Opens an existing file read-only.
+    bool OpenForRead(const std::string& path, std::string& error);
+    bool IsOpen() const;
+    uint64_t Size() const;
+    // Marks the file sparse: ranges that are never written stay holes and take no disk space.
+    bool MakeSparse();
+    // Reserves `size` bytes up front so parallel writes land in an already-sized file. Sparse files
+    // are only extended, so unwritten ranges remain holes.
+    bool Preallocate(uint64_t size);
+    bool WriteAt(uint64_t offset, const void* data, size_t size);
+    // Makes [offset, offset + size) read back as zeros: sparse files get a hole, others are written.
+    bool ZeroRange(uint64_t offset, uint64_t size);
+    // Charges every write to `bucket` (may be null), which sleeps the writer when over its rate.
+    void SetWriteLimit(TokenBucket* bucket) { write_limit = bucket; }
+    // Returns the number of bytes read, which is short only at end of file or on error.
+    size_t ReadAt(uint64_t offset, void* data, size_t size) const;
+    bool Truncate(uint64_t size);
+    void Close();
+
+private:
+    bool WriteZeros(uint64_t offset, uint64_t size);
+
+    bool sparse = false;
+    TokenBucket* write_limit = nullptr;
+#ifdef _WIN32
+    void* handle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+// One unit of dump work: a slice of a region together with where it lands in the output.
+struct DumpChunk {
+    size_t region_index;
+    uint64_t address;
+    uint64_t size;
+    uint64_t flat_offset;   // Offset in the flat, region-concatenated image (and in raw dump files).
+    uint64_t first_page;    // Page table index of the chunk's first page.
+};
+
+// Splits the regions into page-aligned chunks of at most `chunk_size` bytes, in address order,
+// and assigns each its output position before any worker starts.
+std::vector<DumpChunk> PlanDumpChunks(const std::vector<DumpFormat::RegionEntry>& regions, uint32_t page_size, uint64_t chunk_size);
@@ -0,0 +1,108 @@
+#include "elf_core.h"
+#include <algorithm>
+#include <cstring>
+
+namespace ElfCore {
+
+    namespace {
+        // Windows PAGE_* protection values as stored in RegionEntry::protect.
+        constexpr uint32_t WIN_PAGE_READONLY = 0x02;
+        constexpr uint32_t WIN_PAGE_READWRITE = 0x04;
+        constexpr uint32_t WIN_PAGE_WRITECOPY = 0x08;
+        constexpr uint32_t WIN_PAGE_EXECUTE = 0x10;
+        constexpr uint32_t WIN_PAGE_EXECUTE_READ = 0x20;
+        constexpr uint32_t WIN_PAGE_EXECUTE_READWRITE = 0x40;
+        constexpr uint32_t WIN_PAGE_EXECUTE_WRITECOPY = 0x80;
+
+        uint32_t SegmentFlags(uint32_t protect) {
+            uint32_t flags = 0;
+            if (protect & (WIN_PAGE_READONLY | WIN_PAGE_READWRITE | WIN_PAGE_WRITECOPY | WIN_PAGE_EXECUTE_READ | WIN_PAGE_EXECUTE_READWRITE | WIN_PAGE_EXECUTE_WRITECOPY)) flags |= PF_R;
+            if (protect & (WIN_PAGE_READWRITE | WIN_PAGE_WRITECOPY | WIN_PAGE_EXECUTE_READWRITE | WIN_PAGE_EXECUTE_WRITECOPY)) flags |= PF_W;
+            if (protect & (WIN_PAGE_EXECUTE | WIN_PAGE_EXECUTE_READ | WIN_PAGE_EXECUTE_READWRITE | WIN_PAGE_EXECUTE_WRITECOPY)) flags |= PF_X;
+            return flags;
+        }
+
+        template <typename T>
+        void Append(std::vector<char>& out, const T& value) {
+            const char* bytes = reinterpret_cast<const char*>(&value);
+            out.insert(out.end(), bytes, bytes + sizeof(T));
+        }
+
+        // Notes are "name\0" and descriptor, each padded to 4 bytes.
+        void AppendNote(std::vector<char>& out, uint32_t type, const std::vector<char>& desc) {
+            static const char NAME[] = "CORE";
+            Append(out, Elf64_Nhdr{ (uint32_t)sizeof(NAME), (uint32_t)desc.size(), type });
+            out.insert(out.end(), NAME, NAME + sizeof(NAME));
+            out.resize(DumpFormat::AlignUp(out.size(), 4), 0);
+            out.insert(out.end(), desc.begin(), desc.end());
+            out.resize(DumpFormat::AlignUp(out.size(), 4), 0);
+        }
+    }
+
+    Layout Plan(const std::vector<DumpFormat::RegionEntry>& regions, const std::vector<MappedFile>& files, uint32_t process_id, const std::string& process_name) {
+        std::vector<char> notes;
+        PrPsInfo info = {};
+        info.pr_sname = 'R';
+        info.pr_pid = (int32_t)process_id;
+        std::strncpy(info.pr_fname, process_name.c_str(), sizeof(info.pr_fname) - 1);
+        std::strncpy(info.pr_psargs, process_name.c_str(), sizeof(info.pr_psargs) - 1);
+        std::vector<char> info_desc;
+        Append(info_desc, info);
+        AppendNote(notes, NT_PRPSINFO, info_desc);
+
+        // NT_FILE: count, page size, {start, end, file offset in pages}[count], then the NUL-terminated paths.
+        std::vector<char> file_desc;
+        Append(file_desc, (uint64_t)files.size());
+        Append(file_desc, (uint64_t)DumpFormat::kPageSize);
+        for (const auto& file : files) {
+            Append(file_desc, file.start);
+            Append(file_desc, file.end);
+            Append(file_desc, file.file_offset / DumpFormat::kPageSize);
+        }
+        for (const auto& file : files) { file_desc.insert(file_desc.end(), file.path.c_str(), file.path.c_str() + file.path.size() + 1); }
+        AppendNote(notes, NT_FILE, file_desc);
+
+        const size_t phnum = 1 + regions.size();
+        const bool extended_count = phnum >= PN_XNUM;
+        const uint64_t shdr_offset = sizeof(Elf64_Ehdr) + phnum * sizeof(Elf64_Phdr);
+        const uint64_t notes_offset = shdr_offset + (extended_count ? sizeof(Elf64_Shdr) : 0);
+        Layout layout;
+        layout.data_offset = DumpFormat::AlignUp(notes_offset + notes.size(), DumpFormat::kPageSize);
+
+        Elf64_Ehdr ehdr = {};
+        const unsigned char ident[] = { 0x7f, 'E', 'L', 'F', 2 /* ELFCLASS64 */, 1 /* ELFDATA2LSB */, 1 /* EV_CURRENT */ };
+        std::copy(std::begin(ident), std::end(ident), ehdr.e_ident);
+        ehdr.e_type = ET_CORE;
+        ehdr.e_machine = EM_X86_64;
+        ehdr.e_version = 1;
+        ehdr.e_phoff = sizeof(Elf64_Ehdr);
+        ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+        ehdr.e_phentsize = sizeof(Elf64_Phdr);
+        ehdr.e_phnum = extended_count ? PN_XNUM : (uint16_t)phnum;
+        if (extended_count) {
+            ehdr.e_shoff = shdr_offset;
+            ehdr.e_shentsize = sizeof(Elf64_Shdr);
+            ehdr.e_shnum = 1;
+        }
+
+        layout.headers.reserve((size_t)layout.data_offset);
+        Append(layout.headers, ehdr);
+        Append(layout.headers, Elf64_Phdr{ PT_NOTE, 0, notes_offset, 0, 0, notes.size(), 0, 4 });
+        uint64_t flat_offset = 0;
+        for (const auto& region : regions) {
+            Append(layout.headers, Elf64_Phdr{ PT_LOAD, SegmentFlags(region.protect), layout.data_offset + flat_offset, region.base_address, 0, region.size, region.size, DumpFormat::kPageSize });
+            flat_offset += region.size;
+        }
+        if (extended_count) {
+            Elf64_Shdr shdr = {};
+            shdr.sh_info = (uint32_t)phnum;
+            Append(layout.headers, shdr);
+        }
+        layout.headers.insert(layout.headers.end(), notes.begin(), notes.end());
+        layout.headers.resize((size_t)layout.data_offset, 0);
+
+        layout.file_size = layout.data_offset + flat_offset;
+        return layout;
+    }
+
+} // namespace ElfCore
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "dump_format.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ELF64 core-file layout for binary dumps, so they open directly in gdb, lldb and readelf.
+//
+//   Elf64_Ehdr | Elf64_Phdr[1 + region_count] | [Elf64_Shdr] | notes (NT_PRPSINFO, NT_FILE) | region data
+//
+// The first program header is PT_NOTE; every dumped region gets one PT_LOAD. With PN_XNUM or more
+// program headers, a single section header carries the real count. Region data is the
+// flat, region-concatenated image starting at a page-aligned offset, so a raw dump's chunk plan
+// applies unchanged: chunk data lands at data_offset + flat_offset.
+namespace ElfCore {
+
+#pragma pack(push, 1)
+    struct Elf64_Ehdr {
+        unsigned char e_ident[16];
+        uint16_t e_type;
+        uint16_t e_machine;
+        uint32_t e_version;
+        uint64_t e_entry;
+        uint64_t e_phoff;
+        uint64_t e_shoff;
+        uint32_t e_flags;
+        uint16_t e_ehsize;
+        uint16_t e_phentsize;
+        uint16_t e_phnum;
+        uint16_t e_shentsize;
+        uint16_t e_shnum;
+        uint16_t e_shstrndx;
+    };
+
+    struct Elf64_Phdr {
+        uint32_t p_type;
+        uint32_t p_flags;
+        uint64_t p_offset;
+        uint64_t p_vaddr;
+        uint64_t p_paddr;
+        uint64_t p_filesz;
+        uint64_t p_memsz;
+        uint64_t p_align;
+    };
+
+    struct Elf64_Shdr {
+        uint32_t sh_name;
+        uint32_t sh_type;
+        uint64_t sh_flags;
+        uint64_t sh_addr;
+        uint64_t sh_offset;
+        uint64_t sh_size;
+        uint32_t sh_link;
+        uint32_t sh_info;
+        uint64_t sh_addralign;
+        uint64_t sh_entsize;
+    };
+
+    struct Elf64_Nhdr {
+        uint32_t n_namesz;
+        uint32_t n_descsz;
+        uint32_t n_type;
+    };
+
+    // x86-64 layout of the Linux elf_prpsinfo note.
+    struct PrPsInfo {
+        char pr_state;
+        char pr_sname;
+        char pr_zomb;
+        char pr_nice;
+        uint32_t pad;
+        uint64_t pr_flag;
+        uint32_t pr_uid;
+        uint32_t pr_gid;
+        int32_t pr_pid;
+        int32_t pr_ppid;
+        int32_t pr_pgrp;
+        int32_t pr_sid;
+        char pr_fname[16];
+        char pr_psargs[80];
+    };
+#pragma pack(pop)
+
+    // Sizes fixed by the ELF64 format and the x86-64 Linux core note.
+    static_assert(sizeof(Elf64_Ehdr) == 64, "Elf64_Ehdr is 64 bytes");
+    static_assert(sizeof(Elf64_Phdr) == 56, "Elf64_Phdr is 56 bytes");
+    static_assert(sizeof(Elf64_Shdr) == 64, "Elf64_Shdr is 64 bytes");
+    static_assert(sizeof(Elf64_Nhdr) == 12, "Elf64_Nhdr is 12 bytes");
+    static_assert(sizeof(PrPsInfo) == 136, "elf_prpsinfo is 136 bytes on x86-64");
+
+    constexpr uint16_t ET_CORE = 4;
+    constexpr uint16_t EM_X86_64 = 62;
+    constexpr uint16_t PN_XNUM = 0xffff;
+    constexpr uint32_t PT_LOAD = 1;
+    constexpr uint32_t PT_NOTE = 4;
+    constexpr uint32_t PF_X = 1;
+    constexpr uint32_t PF_W = 2;
+    constexpr uint32_t PF_R = 4;
+    constexpr uint32_t NT_PRPSINFO = 3;
+    constexpr uint32_t NT_FILE = 0x46494c45;
+
+    // A file mapped into the process (loaded module or mapped view), reported in the NT_FILE note.
+    struct MappedFile {
+        uint64_t start;
+        uint64_t end;
+        uint64_t file_offset;   // In bytes; must be a multiple of the page size.
+        std::string path;
+    };
+
+    struct Layout {
+        std::vector<char> headers;  // Everything before data_offset, ready to write at offset 0.
+        uint64_t data_offset = 0;   // File offset of the first region's data.
+        uint64_t file_size = 0;
+    };
+
+    // Builds the ELF header, program headers and notes for the given regions. Region protections
+    // are Windows PAGE_* values and are mapped to PF_R/PF_W/PF_X.
+    Layout Plan(const std::vector<DumpFormat::RegionEntry>& regions, const std::vector<MappedFile>& files, uint32_t process_id, const std::string& process_name);
+
+} // namespace ElfCore
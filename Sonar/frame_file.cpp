@@ -0,0 +1,196 @@
+#include "frame_file.h"
+#include "block_codec.h"
+#include <algorithm>
+#include <cstring>
+
+bool FrameWriter::Open(const std::string& path, std::string& error) {
+    next_offset = sizeof(DumpFormat::FramedHeader);
+    index.clear();
+    return file.Open(path, error);
+}
+
+bool FrameWriter::WriteFrame(uint64_t logical_offset, const char* data, size_t size) {
+    thread_local std::vector<char> scratch;
+    scratch.resize(BlockCodec::CompressBound(size));
+    size_t stored_size = BlockCodec::Compress(data, size, scratch.data(), scratch.size());
+    const char* payload = scratch.data();
+    uint32_t flags = 0;
+    if (stored_size == 0 || stored_size >= size) {
+        payload = data;
+        stored_size = size;
+        flags |= DumpFormat::FRAME_STORED_RAW;
+    }
+    const uint64_t file_offset = next_offset.fetch_add(stored_size);
+    if (!file.WriteAt(file_offset, payload, stored_size)) return false;
+    std::lock_guard<std::mutex> lock(index_mutex);
+    index.push_back({ logical_offset, file_offset, (uint32_t)stored_size, (uint32_t)size, flags, 0 });
+    return true;
+}
+
+bool FrameWriter::Finish(uint64_t logical_size) {
+    std::sort(index.begin(), index.end(), [](const auto& a, const auto& b) { return a.logical_offset < b.logical_offset; });
+    DumpFormat::FramedHeader header = {};
+    std::copy(std::begin(DumpFormat::kFramedMagic), std::end(DumpFormat::kFramedMagic), header.magic);
+    header.version = DumpFormat::kFramedVersion;
+    header.codec = DumpFormat::kCodecLZ4Block;
+    header.frame_size = DumpFormat::kFrameSize;
+    header.logical_size = logical_size;
+    header.frame_count = index.size();
+    header.index_offset = next_offset.load();
+    const size_t index_bytes = index.size() * sizeof(DumpFormat::FrameIndexEntry);
+    bool ok = file.WriteAt(header.index_offset, index.data(), index_bytes) && file.WriteAt(0, &header, sizeof(header));
+    next_offset += index_bytes;
+    file.Close();
+    return ok;
+}
+
+namespace {
+    std::atomic<uint64_t> next_source_id{ 1 };
+
+    // The last frame each reader thread used. Sequential readers touch a frame many times in a row
+    // (e.g. page-sized reads), so this skips the shared cache and its lock for almost every call.
+    struct LastFrame {
+        uint64_t source_id = 0;
+        size_t frame = SIZE_MAX;
+        std::shared_ptr<const std::vector<char>> data;
+    };
+    thread_local LastFrame last_frame;
+}
+
+bool DumpFileSource::Open(const std::string& path, std::string& error) {
+    framed = false;
+    index.clear();
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        cache.clear();
+        cache_order.clear();
+    }
+    if (!file.OpenForRead(path, error)) return false;
+    source_id = next_source_id++;
+    // Mapping can fail (empty file, address space); positional reads still work then.
+    std::string map_error;
+    if (!map.Open(path, map_error)) map.Close();
+    stored_size = map.IsOpen() ? map.Size() : file.Size();
+    logical_size = stored_size;
+
+    DumpFormat::FramedHeader header = {};
+    if (logical_size < sizeof(header) || ReadStored(0, reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header) || !DumpFormat::HasFramedMagic(header.magic)) {
+        return true;
+    }
+    if (header.version != DumpFormat::kFramedVersion || header.codec != DumpFormat::kCodecLZ4Block) {
+        error = "Unsupported compressed dump format in " + path;
+        return false;
+    }
+    // The index must fit in the file before it is allocated, and every entry must describe a frame
+    // of at most kFrameSize bytes stored inside the file, so a corrupt index cannot cause huge
+    // allocations or reads past the end.
+    if (header.index_offset > stored_size || header.frame_count > (stored_size - header.index_offset) / sizeof(DumpFormat::FrameIndexEntry)) {
+        error = "Compressed dump frame index is truncated in " + path;
+        return false;
+    }
+    index.resize((size_t)header.frame_count);
+    const size_t index_bytes = index.size() * sizeof(DumpFormat::FrameIndexEntry);
+    if (ReadStored(header.index_offset, reinterpret_cast<char*>(index.data()), index_bytes) != index_bytes) {
+        error = "Compressed dump frame index is truncated in " + path;
+        return false;
+    }
+    for (const auto& entry : index) {
+        const uint64_t span = (entry.flags & DumpFormat::FRAME_STORED_RAW) ? entry.logical_size : entry.stored_size;
+        if (entry.logical_size > DumpFormat::kFrameSize || entry.logical_offset > UINT64_MAX - entry.logical_size || entry.file_offset > stored_size || span > stored_size - entry.file_offset) {
+            error = "Compressed dump frame index is corrupt in " + path;
+            return false;
+        }
+    }
+    framed = true;
+    logical_size = header.logical_size;
+    return true;
+}
+
+size_t DumpFileSource::ReadStored(uint64_t offset, char* buffer, size_t size) const {
+    if (!map.IsOpen()) return file.ReadAt(offset, buffer, size);
+    if (offset >= stored_size) return 0;
+    size = (size_t)std::min<uint64_t>(size, stored_size - offset);
+    std::memcpy(buffer, map.Data() + offset, size);
+    return size;
+}
+
+DumpFileSource::FramePtr DumpFileSource::LoadFrame(size_t frame) const {
+    const auto& entry = index[frame];
+    auto out = std::make_shared<std::vector<char>>(entry.logical_size);
+    if (entry.flags & DumpFormat::FRAME_STORED_RAW) {
+        if (ReadStored(entry.file_offset, out->data(), entry.logical_size) != entry.logical_size) return nullptr;
+        return out;
+    }
+    // Mapped files decompress straight from the mapping; otherwise the compressed bytes are read first.
+    const char* compressed = nullptr;
+    thread_local std::vector<char> scratch;
+    if (map.IsOpen() && entry.file_offset + entry.stored_size <= stored_size) {
+        compressed = map.Data() + entry.file_offset;
+    }
+    else {
+        scratch.resize(entry.stored_size);
+        if (ReadStored(entry.file_offset, scratch.data(), entry.stored_size) != entry.stored_size) return nullptr;
+        compressed = scratch.data();
+    }
+    if (!BlockCodec::Decompress(compressed, entry.stored_size, out->data(), out->size())) return nullptr;
+    return out;
+}
+
+DumpFileSource::FramePtr DumpFileSource::GetFrame(size_t frame) const {
+    if (last_frame.source_id == source_id && last_frame.frame == frame) return last_frame.data;
+    FramePtr data;
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto it = cache.find(frame);
+        if (it != cache.end()) {
+            cache_order.splice(cache_order.begin(), cache_order, it->second.second);
+            data = it->second.first;
+        }
+    }
+    if (!data) {
+        // Inflate outside the lock; if two threads race on the same frame, both results are identical.
+        data = LoadFrame(frame);
+        if (!data) return nullptr;
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        if (cache.find(frame) == cache.end()) {
+            cache_order.push_front(frame);
+            cache[frame] = { data, cache_order.begin() };
+            if (cache.size() > FRAME_CACHE_CAPACITY) {
+                cache.erase(cache_order.back());
+                cache_order.pop_back();
+            }
+        }
+    }
+    last_frame = { source_id, frame, data };
+    return data;
+}
+
+size_t DumpFileSource::ReadAt(uint64_t offset, char* buffer, size_t size) const {
+    if (offset >= logical_size) return 0;
+    size = (size_t)std::min<uint64_t>(size, logical_size - offset);
+    if (!framed) return ReadStored(offset, buffer, size);
+
+    // First frame that could contain `offset`.
+    auto it = std::upper_bound(index.begin(), index.end(), offset, [](uint64_t value, const auto& entry) { return value < entry.logical_offset; });
+    size_t frame = (it == index.begin()) ? 0 : (size_t)(it - index.begin()) - 1;
+    size_t copied = 0;
+    while (copied < size) {
+        const uint64_t position = offset + copied;
+        while (frame < index.size() && index[frame].logical_offset + index[frame].logical_size <= position) ++frame;
+        if (frame >= index.size() || index[frame].logical_offset > position) {
+            // Not covered by any frame: zero-fill up to the next frame (or the end of the request).
+            uint64_t gap_end = (frame < index.size()) ? index[frame].logical_offset : offset + size;
+            size_t take = (size_t)std::min<uint64_t>(size - copied, gap_end - position);
+            std::fill(buffer + copied, buffer + copied + take, 0);
+            copied += take;
+            continue;
+        }
+        FramePtr data = GetFrame(frame);
+        if (!data) break;
+        const size_t in_frame = (size_t)(position - index[frame].logical_offset);
+        const size_t take = std::min(size - copied, data->size() - in_frame);
+        std::memcpy(buffer + copied, data->data() + in_frame, take);
+        copied += take;
+    }
+    return copied;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "dump_format.h"
+#include "dump_writer.h"
+#include "mapped_file.h"
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Writes the framed (compressed) dump container. WriteFrame is thread-safe: each caller compresses
+// its own frame, claims an output range with an atomic cursor and writes it positionally.
+class FrameWriter {
+public:
+    bool Open(const std::string& path, std::string& error);
+    // Compresses and stores the logical bytes [logical_offset, logical_offset + size). size <= kFrameSize.
+    bool WriteFrame(uint64_t logical_offset, const char* data, size_t size);
+    // Writes the frame index and header. `logical_size` is the size of the uncompressed stream.
+    bool Finish(uint64_t logical_size);
+    uint64_t BytesWritten() const { return next_offset.load(); }
+    void SetWriteLimit(TokenBucket* bucket) { file.SetWriteLimit(bucket); }
+
+private:
+    PositionalFile file;
+    std::atomic<uint64_t> next_offset{ sizeof(DumpFormat::FramedHeader) };
+    std::mutex index_mutex;
+    std::vector<DumpFormat::FrameIndexEntry> index;
+};
+
+// Random-access view of a dump file's logical bytes. The file is memory-mapped when possible (with
+// positional reads as the fallback). Framed files are decompressed frame by frame on demand and
+// recent frames are kept in a small LRU cache shared by all reader threads. ReadAt is thread-safe.
+class DumpFileSource {
+public:
+    bool Open(const std::string& path, std::string& error);
+    bool IsFramed() const { return framed; }
+    bool IsMapped() const { return map.IsOpen(); }
+    uint64_t Size() const { return logical_size; }
+    // Reads up to `size` logical bytes at `offset`. Gaps between frames read back as zeros.
+    size_t ReadAt(uint64_t offset, char* buffer, size_t size) const;
+
+private:
+    typedef std::shared_ptr<const std::vector<char>> FramePtr;
+    static constexpr size_t FRAME_CACHE_CAPACITY = 16;
+
+    size_t ReadStored(uint64_t offset, char* buffer, size_t size) const;
+    FramePtr LoadFrame(size_t frame) const;
+    FramePtr GetFrame(size_t frame) const;
+
+    PositionalFile file;
+    MappedFile map;
+    bool framed = false;
+    uint64_t stored_size = 0;
+    uint64_t logical_size = 0;
+    uint64_t source_id = 0;
+    std::vector<DumpFormat::FrameIndexEntry> index;
+
+    mutable std::mutex cache_mutex;
+    mutable std::list<size_t> cache_order;  // Most recently used first.
+    mutable std::unordered_map<size_t, std::pair<FramePtr, std::list<size_t>::iterator>> cache;
+};
@@ -0,0 +1,208 @@
+#include "front_coded.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    const char kMagic[8] = { 'S', 'O', 'N', 'A', 'R', 'F', 'C', 'D' };
+    constexpr uint32_t kVersion = 1;
+    constexpr size_t kWriteBufferSize = 1024 * 1024;
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t block_strings;
+        uint64_t string_count;
+        uint64_t block_count;
+        uint64_t data_size;
+        uint64_t index_offset;      // block_offsets, then key_offsets, then the keys.
+        uint64_t keys_size;
+    };
+
+    void PutVarint(std::vector<char>& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back((char)(uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((char)(uint8_t)value);
+    }
+    bool GetVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && p < end; shift += 7) {
+            const uint8_t byte = *p++;
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+}
+
+namespace FrontCoded {
+
+    bool IsFrontCoded(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        char magic[sizeof(kMagic)] = {};
+        return file.read(magic, sizeof(magic)) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+    }
+
+    uint64_t DataOffset() { return sizeof(FileHeader); }
+
+    void BlockIndex::Append(const BlockIndex& other, uint64_t data_offset) {
+        const uint64_t key_base = keys.size();
+        for (uint64_t offset : other.block_offsets) block_offsets.push_back(data_offset + offset);
+        for (uint64_t offset : other.key_offsets) key_offsets.push_back(key_base + offset);
+        keys += other.keys;
+        string_count += other.string_count;
+    }
+
+    bool BlockEncoder::Add(std::string_view text) {
+        scratch.clear();
+        if (block_strings == kBlockStrings || index.block_offsets.empty()) {
+            index.block_offsets.push_back(data_size);
+            index.key_offsets.push_back(index.keys.size());
+            index.keys.append(text.data(), text.size());
+            block_strings = 0;
+            PutVarint(scratch, text.size());
+            scratch.insert(scratch.end(), text.begin(), text.end());
+        }
+        else {
+            const size_t limit = std::min(previous.size(), text.size());
+            size_t shared = 0;
+            while (shared < limit && previous[shared] == text[shared]) ++shared;
+            PutVarint(scratch, shared);
+            PutVarint(scratch, text.size() - shared);
+            scratch.insert(scratch.end(), text.begin() + shared, text.end());
+        }
+        previous.assign(text.data(), text.size());
+        ++block_strings;
+        ++index.string_count;
+        data_size += scratch.size();
+        return sink(scratch.data(), scratch.size());
+    }
+
+    bool WriteIndex(PositionalFile& file, const BlockIndex& index, uint64_t data_size, std::string& error) {
+        FileHeader header = {};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.block_strings = (uint32_t)kBlockStrings;
+        header.string_count = index.string_count;
+        header.block_count = index.block_offsets.size();
+        header.data_size = data_size;
+        // The offset tables are 64-bit; keep them aligned for the mapped reader.
+        header.index_offset = (DataOffset() + data_size + 7) & ~7ULL;
+        header.keys_size = index.keys.size();
+        std::vector<uint64_t> block_offsets = index.block_offsets;
+        std::vector<uint64_t> key_offsets = index.key_offsets;
+        block_offsets.push_back(data_size);
+        key_offsets.push_back(index.keys.size());
+        const uint64_t key_offsets_offset = header.index_offset + block_offsets.size() * sizeof(uint64_t);
+        const uint64_t keys_offset = key_offsets_offset + key_offsets.size() * sizeof(uint64_t);
+        const uint64_t padding = 0;
+        const bool ok = file.WriteAt(DataOffset() + data_size, &padding, (size_t)(header.index_offset - DataOffset() - data_size)) &&
+                        file.WriteAt(header.index_offset, block_offsets.data(), block_offsets.size() * sizeof(uint64_t)) &&
+                        file.WriteAt(key_offsets_offset, key_offsets.data(), key_offsets.size() * sizeof(uint64_t)) &&
+                        file.WriteAt(keys_offset, index.keys.data(), index.keys.size()) &&
+                        file.WriteAt(0, &header, sizeof(header));
+        if (!ok) { error = "Could not write the front-coded index"; return false; }
+        return true;
+    }
+
+    Writer::Writer() : encoder([this](const char* bytes, size_t size) {
+        if (buffer.size() + size > kWriteBufferSize && !Flush()) return false;
+        buffer.insert(buffer.end(), bytes, bytes + size);
+        return true;
+    }) {}
+
+    bool Writer::Flush() {
+        if (buffer.empty()) return true;
+        if (!file.WriteAt(DataOffset() + offset, buffer.data(), buffer.size())) return false;
+        offset += buffer.size();
+        buffer.clear();
+        return true;
+    }
+
+    bool Writer::Open(const std::string& output_path, std::string& error) {
+        path = output_path;
+        buffer.reserve(kWriteBufferSize);
+        std::string file_error;
+        if (!file.Open(path, file_error)) { error = "Failed to create final output file: " + file_error; return false; }
+        return true;
+    }
+
+    bool Writer::Finish(std::string& error) {
+        if (!Flush()) { error = "Failed while writing output file: " + path; return false; }
+        if (!WriteIndex(file, encoder.Index(), encoder.DataSize(), error)) return false;
+        bytes_written = file.Size();
+        file.Close();
+        return true;
+    }
+
+    bool Reader::Open(const std::string& path, std::string& error) {
+        if (!file.Open(path, error)) return false;
+        FileHeader header;
+        if (file.Size() < sizeof(header)) { error = "Front-coded dump is truncated: " + path; file.Close(); return false; }
+        std::memcpy(&header, file.Data(), sizeof(header));
+        auto fits = [&](uint64_t offset, uint64_t bytes) { return offset <= file.Size() && bytes <= file.Size() - offset; };
+        const uint64_t table_size = (header.block_count + 1) * sizeof(uint64_t);
+        bool valid = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.version == kVersion && header.block_count < file.Size() &&
+                     fits(DataOffset(), header.data_size) && header.index_offset % 8 == 0 && fits(header.index_offset, table_size * 2) &&
+                     fits(header.index_offset + table_size * 2, header.keys_size);
+        if (valid) {
+            block_offsets = reinterpret_cast<const uint64_t*>(file.Data() + header.index_offset);
+            key_offsets = block_offsets + header.block_count + 1;
+            valid = block_offsets[header.block_count] == header.data_size && key_offsets[header.block_count] == header.keys_size;
+            for (uint64_t b = 0; valid && b < header.block_count; ++b) valid = block_offsets[b] < block_offsets[b + 1] && key_offsets[b] <= key_offsets[b + 1];
+        }
+        if (!valid) { error = "Not a valid front-coded dump: " + path; file.Close(); return false; }
+        string_count = header.string_count;
+        block_count = header.block_count;
+        data = reinterpret_cast<const uint8_t*>(file.Data() + DataOffset());
+        keys = file.Data() + header.index_offset + table_size * 2;
+        return true;
+    }
+
+    std::string_view Reader::Key(uint64_t block) const { return std::string_view(keys + key_offsets[block], (size_t)(key_offsets[block + 1] - key_offsets[block])); }
+
+    bool Reader::Contains(std::string_view text) const {
+        // The last block whose first string is not above `text` is the only one that can hold it.
+        uint64_t low = 0, high = block_count;
+        while (low < high) {
+            const uint64_t mid = low + (high - low) / 2;
+            if (Key(mid) <= text) low = mid + 1;
+            else high = mid;
+        }
+        if (low == 0) return false;
+        Cursor cursor(*this, low - 1);
+        while (cursor.Next()) {
+            if (cursor.Current() >= text) return cursor.Current() == text;
+        }
+        return false;
+    }
+
+    Reader::Cursor::Cursor(const Reader& source, uint64_t first_block) : reader(source), block(first_block) {}
+
+    bool Reader::Cursor::Next() {
+        if (!started || pos == block_end) {
+            if (started) ++block;
+            started = true;
+            if (block >= reader.block_count) return false;
+            pos = reader.data + reader.block_offsets[block];
+            block_end = reader.data + reader.block_offsets[block + 1];
+            uint64_t length = 0;
+            if (!GetVarint(pos, block_end, length) || length > (uint64_t)(block_end - pos)) { block = reader.block_count; pos = block_end; return false; }
+            current.assign(reinterpret_cast<const char*>(pos), (size_t)length);
+            pos += length;
+            return true;
+        }
+        uint64_t shared = 0, suffix = 0;
+        if (!GetVarint(pos, block_end, shared) || !GetVarint(pos, block_end, suffix) || shared > current.size() || suffix > (uint64_t)(block_end - pos)) {
+            block = reader.block_count;
+            pos = block_end;
+            return false;
+        }
+        current.resize((size_t)shared);
+        current.append(reinterpret_cast<const char*>(pos), (size_t)suffix);
+        pos += suffix;
+        return true;
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "dump_writer.h"
+#include "mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Sorted text dump with front coding: each string stores only the part that differs from the one
+// before it. Strings are grouped into blocks of up to kBlockStrings, and a block starts with a full
+// string so it decodes on its own:
+//
+//   Header | blocks | padding to 8 | block_offsets[block_count + 1] | key_offsets[block_count + 1] | keys
+//
+//   block: varint length, bytes | { varint shared_prefix, varint suffix_length, suffix }...
+//
+// The keys are the first string of every block, so a membership query binary-searches the keys and
+// decodes one block. Strings are unique and in byte order, which lets two dumps be diffed with a
+// single merge-join pass.
+namespace FrontCoded {
+
+    constexpr size_t kBlockStrings = 64;
+
+    // True when the file at `path` starts with a front-coded header.
+    bool IsFrontCoded(const std::string& path);
+    // Where block data starts in a file.
+    uint64_t DataOffset();
+
+    // Block index for a stretch of block data. Pieces encoded in parallel are joined with Append().
+    struct BlockIndex {
+        std::vector<uint64_t> block_offsets;    // Relative to the start of the block data.
+        std::vector<uint64_t> key_offsets;      // Start of each block's key in `keys`.
+        std::string keys;
+        uint64_t string_count = 0;
+
+        // Appends `other`, whose block data follows this one's at `data_offset`.
+        void Append(const BlockIndex& other, uint64_t data_offset);
+    };
+
+    // Front-codes strings given in sorted order without duplicates; `output` receives the encoded
+    // bytes in order.
+    class BlockEncoder {
+    public:
+        explicit BlockEncoder(std::function<bool(const char*, size_t)> output) : sink(std::move(output)) {}
+        bool Add(std::string_view text);
+        uint64_t DataSize() const { return data_size; }
+        const BlockIndex& Index() const { return index; }
+
+    private:
+        std::function<bool(const char*, size_t)> sink;
+        BlockIndex index;
+        std::string previous;
+        size_t block_strings = 0;
+        uint64_t data_size = 0;
+        std::vector<char> scratch;
+    };
+
+    // Completes a file whose `data_size` bytes of block data are already at DataOffset(): writes the
+    // index after the data, then the header.
+    bool WriteIndex(PositionalFile& file, const BlockIndex& index, uint64_t data_size, std::string& error);
+
+    // Writes a whole file from strings given in sorted order without duplicates.
+    class Writer {
+    public:
+        Writer();
+        bool Open(const std::string& path, std::string& error);
+        void SetWriteLimit(TokenBucket* limit) { file.SetWriteLimit(limit); }
+        bool Add(std::string_view text) { return encoder.Add(text); }
+        bool Finish(std::string& error);
+        uint64_t BytesWritten() const { return bytes_written; }
+
+    private:
+        bool Flush();
+
+        PositionalFile file;
+        std::string path;
+        std::vector<char> buffer;
+        uint64_t offset = 0;
+        BlockEncoder encoder;
+        uint64_t bytes_written = 0;
+    };
+
+    // Memory-mapped front-coded dump.
+    class Reader {
+    public:
+        bool Open(const std::string& path, std::string& error);
+        bool IsOpen() const { return file.IsOpen(); }
+        uint64_t StringCount() const { return string_count; }
+        bool Contains(std::string_view text) const;
+
+        // Decodes the strings in order, from the first string of `first_block`.
+        class Cursor {
+        public:
+            explicit Cursor(const Reader& source, uint64_t first_block = 0);
+            // Advances to the next string; false at the end (or at corrupt data).
+            bool Next();
+            std::string_view Current() const { return current; }
+
+        private:
+            const Reader& reader;
+            uint64_t block;
+            const uint8_t* pos = nullptr;
+            const uint8_t* block_end = nullptr;
+            bool started = false;
+            std::string current;
+        };
+
+    private:
+        std::string_view Key(uint64_t block) const;
+
+        MappedFile file;
+        uint64_t string_count = 0;
+        uint64_t block_count = 0;
+        const uint8_t* data = nullptr;
+        const uint64_t* block_offsets = nullptr;
+        const uint64_t* key_offsets = nullptr;
+        const char* keys = nullptr;
+    };
+}
@@ -0,0 +1,79 @@
+#include "job_journal.h"
+#include <cstring>
+#include <filesystem>
+
+namespace {
+    const char kJournalMagic[8] = { 'S', 'O', 'N', 'A', 'R', 'J', 'N', 'L' };
+    constexpr uint32_t kJournalVersion = 1;
+    // Guards replay against a corrupt size field; no unit records more than this.
+    constexpr uint32_t kMaxRecordSize = 64u * 1024 * 1024;
+
+    uint32_t Checksum(const char* payload, size_t size) { return (uint32_t)Hash128::Compute(payload, size).lo; }
+}
+
+bool JobJournal::Open(const std::string& journal_path, const Hash128::Digest& identity, uint64_t unit_count, std::vector<char>& extra,
+                      const std::function<void(uint64_t unit, const char* payload, size_t size)>& replay, std::string& error) {
+    path = journal_path;
+    resumed = false;
+    std::string open_error;
+    if (file.OpenExisting(path, open_error)) {
+        JournalHeader header = {};
+        const uint64_t size = file.Size();
+        if (file.ReadAt(0, &header, sizeof(header)) == sizeof(header) && std::memcmp(header.magic, kJournalMagic, sizeof(kJournalMagic)) == 0 &&
+            header.version == kJournalVersion && header.identity == identity && header.unit_count == unit_count && sizeof(header) + header.extra_size <= size) {
+            extra.assign(header.extra_size, 0);
+            file.ReadAt(sizeof(header), extra.data(), extra.size());
+            uint64_t offset = sizeof(header) + header.extra_size;
+            std::vector<char> payload;
+            RecordHeader record;
+            while (offset + sizeof(record) <= size && file.ReadAt(offset, &record, sizeof(record)) == sizeof(record)) {
+                if (record.unit >= unit_count || record.size > kMaxRecordSize || offset + sizeof(record) + record.size > size) break;
+                payload.resize(record.size);
+                if (file.ReadAt(offset + sizeof(record), payload.data(), payload.size()) != payload.size() || Checksum(payload.data(), payload.size()) != record.checksum) break;
+                replay(record.unit, payload.data(), payload.size());
+                offset += sizeof(record) + record.size;
+            }
+            // Anything after the last complete record is a torn append; new records overwrite it.
+            end_offset = offset;
+            file.Truncate(end_offset);
+            resumed = true;
+            return true;
+        }
+        file.Close();
+    }
+
+    if (!file.Open(path, open_error)) {
+        error = "Could not create checkpoint journal: " + open_error;
+        return false;
+    }
+    JournalHeader header = {};
+    std::memcpy(header.magic, kJournalMagic, sizeof(kJournalMagic));
+    header.version = kJournalVersion;
+    header.extra_size = (uint32_t)extra.size();
+    header.identity = identity;
+    header.unit_count = unit_count;
+    if (!file.WriteAt(0, &header, sizeof(header)) || !file.WriteAt(sizeof(header), extra.data(), extra.size())) {
+        error = "Could not write checkpoint journal " + path;
+        return false;
+    }
+    end_offset = sizeof(header) + extra.size();
+    return true;
+}
+
+bool JobJournal::Record(uint64_t unit, const void* payload, size_t size) {
+    if (!file.IsOpen()) return false;
+    std::vector<char> record(sizeof(RecordHeader) + size);
+    const RecordHeader header = { unit, (uint32_t)size, Checksum(static_cast<const char*>(payload), size) };
+    std::memcpy(record.data(), &header, sizeof(header));
+    if (size > 0) std::memcpy(record.data() + sizeof(header), payload, size);
+    std::lock_guard<std::mutex> lock(append_mutex);
+    if (!file.WriteAt(end_offset, record.data(), record.size())) return false;
+    end_offset += record.size();
+    return true;
+}
+
+void JobJournal::Remove() {
+    file.Close();
+    std::error_code ignored;
+    if (!path.empty()) std::filesystem::remove(path, ignored);
+}
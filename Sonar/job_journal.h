@@ -0,0 +1,77 @@
+#pragma once
+
+#include "dump_writer.h"
+#include "hash128.hpp"
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Checkpoint journal for long-running dumps and scans. A job is a fixed list of units (dump chunks,
+// scan regions); each completed unit appends one record with whatever the job needs to restore it
+// (page references, scan hits). Records are written only after the unit's own output, so every
+// recorded unit is complete once the process stops. Nothing is flushed, so this does not hold
+// across a power loss.
+//
+//   JournalHeader | extra[extra_size] | { RecordHeader | payload }...
+//
+// The header carries a digest of the job's identity (targets, region layout, options). A restarted
+// job with the same identity replays the records and skips those units; any other journal is
+// discarded. A torn record at the end (the job died mid-append) is ignored.
+class JobJournal {
+public:
+    static std::string PathFor(const std::string& output_path) { return output_path + ".journal"; }
+
+    // Opens the journal at `path`. If it exists and matches `identity` and `unit_count`, each record
+    // is passed to `replay`, `extra` is replaced by the stored value and new records are appended
+    // after the last complete one. Otherwise a fresh journal is started with `extra` in its header.
+    bool Open(const std::string& path, const Hash128::Digest& identity, uint64_t unit_count, std::vector<char>& extra,
+              const std::function<void(uint64_t unit, const char* payload, size_t size)>& replay, std::string& error);
+    bool Resumed() const { return resumed; }
+
+    // Appends the record for a finished unit. Thread-safe.
+    bool Record(uint64_t unit, const void* payload, size_t size);
+    // Deletes the journal once the job has completed.
+    void Remove();
+
+private:
+    struct JournalHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t extra_size;
+        Hash128::Digest identity;
+        uint64_t unit_count;
+    };
+    struct RecordHeader {
+        uint64_t unit;
+        uint32_t size;
+        uint32_t checksum;      // Low bits of the payload's hash, to reject a torn tail.
+    };
+
+    std::string path;
+    PositionalFile file;
+    std::mutex append_mutex;
+    uint64_t end_offset = 0;
+    bool resumed = false;
+};
+
+// Builds a journal identity from the fields that must match for a restarted job to reuse it.
+class JournalIdentity {
+public:
+    template <typename T>
+    JournalIdentity& Add(const T& value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(T));
+        return *this;
+    }
+    JournalIdentity& Add(const std::string& value) {
+        Add((uint64_t)value.size());
+        data.insert(data.end(), value.begin(), value.end());
+        return *this;
+    }
+    Hash128::Digest Digest() const { return Hash128::Compute(data.data(), data.size()); }
+
+private:
+    std::vector<char> data;
+};
@@ -0,0 +1,89 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() { Close(); }
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& path, std::string& error) {
+    Close();
+    HANDLE h = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE) {
+        error = "Could not open " + path + " (error " + std::to_string(GetLastError()) + ")";
+        return false;
+    }
+    file = h;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(h, &file_size) || file_size.QuadPart == 0) {
+        error = "Cannot map empty file " + path;
+        Close();
+        return false;
+    }
+    mapping = CreateFileMappingA(h, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping) data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!data) {
+        error = "Could not map " + path + " (error " + std::to_string(GetLastError()) + ")";
+        Close();
+        return false;
+    }
+    size = (uint64_t)file_size.QuadPart;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data) UnmapViewOfFile(data);
+    if (mapping) CloseHandle(mapping);
+    if (file) CloseHandle(file);
+    data = nullptr;
+    mapping = nullptr;
+    file = nullptr;
+    size = 0;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& path, std::string& error) {
+    Close();
+    fd = ::open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || ::fstat(fd, &st) != 0) {
+        error = "Could not open " + path + " (" + std::strerror(errno) + ")";
+        Close();
+        return false;
+    }
+    if (st.st_size == 0) {
+        error = "Cannot map empty file " + path;
+        Close();
+        return false;
+    }
+    void* view = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        error = "Could not map " + path + " (" + std::strerror(errno) + ")";
+        Close();
+        return false;
+    }
+    data = static_cast<const char*>(view);
+    size = (uint64_t)st.st_size;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data) ::munmap(const_cast<char*>(data), (size_t)size);
+    if (fd >= 0) ::close(fd);
+    data = nullptr;
+    fd = -1;
+    size = 0;
+}
+
+#endif
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file. Dump readers use it so a lookup in a large dump is a
+// memcpy from the page cache instead of a system call.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path, std::string& error);
+    bool IsOpen() const { return data != nullptr; }
+    const char* Data() const { return data; }
+    uint64_t Size() const { return size; }
+    void Close();
+
+private:
+    const char* data = nullptr;
+    uint64_t size = 0;
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+};
@@ -0,0 +1,99 @@
+#include "minidump.h"
+#include <cstring>
+
+namespace Minidump {
+
+    namespace {
+        template <typename T>
+        uint32_t Append(std::vector<char>& out, const T& value) {
+            const uint32_t rva = (uint32_t)out.size();
+            const char* bytes = reinterpret_cast<const char*>(&value);
+            out.insert(out.end(), bytes, bytes + sizeof(T));
+            return rva;
+        }
+
+        template <typename T>
+        void Patch(std::vector<char>& out, uint32_t rva, const T& value) { std::memcpy(out.data() + rva, &value, sizeof(T)); }
+
+        // MINIDUMP_STRING: byte length (without the terminator), then NUL-terminated UTF-16.
+        uint32_t AppendString(std::vector<char>& out, const std::u16string& text) {
+            out.resize(DumpFormat::AlignUp(out.size(), 4), 0);
+            const uint32_t rva = Append(out, (uint32_t)(text.size() * sizeof(char16_t)));
+            const char* bytes = reinterpret_cast<const char*>(text.c_str());
+            out.insert(out.end(), bytes, bytes + (text.size() + 1) * sizeof(char16_t));
+            return rva;
+        }
+    }
+
+    Layout Plan(const std::vector<DumpFormat::RegionEntry>& regions, const std::vector<Module>& modules, const SystemInfo& system, uint32_t time_date_stamp) {
+        const uint32_t STREAM_COUNT = 3;
+        Layout layout;
+        std::vector<char>& out = layout.headers;
+
+        Header header = {};
+        header.signature = kSignature;
+        header.version = kVersion;
+        header.number_of_streams = STREAM_COUNT;
+        header.time_date_stamp = time_date_stamp;
+        header.flags = kWithFullMemory;
+        Append(out, header);
+        header.stream_directory_rva = (uint32_t)out.size();
+        Patch(out, 0, header);
+        const uint32_t directory_rva = header.stream_directory_rva;
+        for (uint32_t i = 0; i < STREAM_COUNT; ++i) Append(out, Directory{});
+
+        SystemInfoRecord info = {};
+        info.processor_architecture = system.processor_architecture;
+        info.processor_level = system.processor_level;
+        info.processor_revision = system.processor_revision;
+        info.number_of_processors = system.number_of_processors;
+        info.product_type = system.product_type;
+        info.major_version = system.major_version;
+        info.minor_version = system.minor_version;
+        info.build_number = system.build_number;
+        info.platform_id = 2;                           // VER_PLATFORM_WIN32_NT
+        const uint32_t system_rva = Append(out, info);
+
+        out.resize(DumpFormat::AlignUp(out.size(), 4), 0);
+        const uint32_t module_list_rva = Append(out, (uint32_t)modules.size());
+        std::vector<uint32_t> module_rvas;
+        for (const auto& module : modules) {
+            ModuleRecord record = {};
+            record.base_of_image = module.base;
+            record.size_of_image = module.size;
+            record.checksum = module.checksum;
+            record.time_date_stamp = module.time_date_stamp;
+            module_rvas.push_back(Append(out, record));
+        }
+        const uint32_t module_list_size = (uint32_t)out.size() - module_list_rva;
+
+        out.resize(DumpFormat::AlignUp(out.size(), 8), 0);
+        const uint32_t memory_list_rva = Append(out, (uint64_t)regions.size());
+        const uint32_t base_rva_position = Append(out, (uint64_t)0);
+        for (const auto& region : regions) Append(out, MemoryDescriptor64{ region.base_address, region.size });
+        const uint32_t memory_list_size = (uint32_t)out.size() - memory_list_rva;
+
+        // Strings go last so the fixed-size records above stay contiguous.
+        info.csd_version_rva = AppendString(out, u"");
+        Patch(out, system_rva, info);
+        for (size_t i = 0; i < modules.size(); ++i) {
+            ModuleRecord record;
+            std::memcpy(&record, out.data() + module_rvas[i], sizeof(record));
+            record.module_name_rva = AppendString(out, modules[i].path);
+            Patch(out, module_rvas[i], record);
+        }
+
+        Patch(out, directory_rva, Directory{ kSystemInfoStream, { (uint32_t)sizeof(SystemInfoRecord), system_rva } });
+        Patch(out, directory_rva + sizeof(Directory), Directory{ kModuleListStream, { module_list_size, module_list_rva } });
+        Patch(out, directory_rva + 2 * sizeof(Directory), Directory{ kMemory64ListStream, { memory_list_size, memory_list_rva } });
+
+        layout.data_offset = DumpFormat::AlignUp(out.size(), DumpFormat::kPageSize);
+        Patch(out, base_rva_position, layout.data_offset);
+        out.resize((size_t)layout.data_offset, 0);
+
+        layout.file_size = layout.data_offset;
+        for (const auto& region : regions) layout.file_size += region.size;
+        return layout;
+    }
+
+} // namespace Minidump
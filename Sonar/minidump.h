@@ -0,0 +1,121 @@
+#pragma once
+
+#include "dump_format.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Minidump (MDMP) layout for binary dumps, readable by WinDbg and other minidump tooling. Built
+// from the documented structures only, so it does not need dbghelp.
+//
+//   MINIDUMP_HEADER | MINIDUMP_DIRECTORY[] | SystemInfo | ModuleList | Memory64List | strings | memory
+//
+// Memory64ListStream describes every region with one descriptor; their data is stored back to back
+// from BaseRva in region order. That blob is exactly the flat, region-concatenated image, so the
+// dump workers stream chunks into it at data_offset + flat_offset in one pass.
+namespace Minidump {
+
+#pragma pack(push, 1)
+    struct Header {
+        uint32_t signature;
+        uint32_t version;
+        uint32_t number_of_streams;
+        uint32_t stream_directory_rva;
+        uint32_t checksum;
+        uint32_t time_date_stamp;
+        uint64_t flags;
+    };
+
+    struct LocationDescriptor {
+        uint32_t data_size;
+        uint32_t rva;
+    };
+
+    struct Directory {
+        uint32_t stream_type;
+        LocationDescriptor location;
+    };
+
+    struct SystemInfoRecord {
+        uint16_t processor_architecture;
+        uint16_t processor_level;
+        uint16_t processor_revision;
+        uint8_t number_of_processors;
+        uint8_t product_type;
+        uint32_t major_version;
+        uint32_t minor_version;
+        uint32_t build_number;
+        uint32_t platform_id;
+        uint32_t csd_version_rva;
+        uint16_t suite_mask;
+        uint16_t reserved2;
+        uint8_t cpu[24];
+    };
+
+    struct VsFixedFileInfo {
+        uint32_t fields[13];
+    };
+
+    struct ModuleRecord {
+        uint64_t base_of_image;
+        uint32_t size_of_image;
+        uint32_t checksum;
+        uint32_t time_date_stamp;
+        uint32_t module_name_rva;
+        VsFixedFileInfo version_info;
+        LocationDescriptor cv_record;
+        LocationDescriptor misc_record;
+        uint64_t reserved0;
+        uint64_t reserved1;
+    };
+
+    struct MemoryDescriptor64 {
+        uint64_t start_of_memory_range;
+        uint64_t data_size;
+    };
+#pragma pack(pop)
+
+    // Sizes fixed by the minidump format (dbghelp.h).
+    static_assert(sizeof(Header) == 32, "MINIDUMP_HEADER is 32 bytes");
+    static_assert(sizeof(LocationDescriptor) == 8, "MINIDUMP_LOCATION_DESCRIPTOR is 8 bytes");
+    static_assert(sizeof(Directory) == 12, "MINIDUMP_DIRECTORY is 12 bytes");
+    static_assert(sizeof(SystemInfoRecord) == 56, "MINIDUMP_SYSTEM_INFO is 56 bytes");
+    static_assert(sizeof(VsFixedFileInfo) == 52, "VS_FIXEDFILEINFO is 52 bytes");
+    static_assert(sizeof(ModuleRecord) == 108, "MINIDUMP_MODULE is 108 bytes");
+    static_assert(sizeof(MemoryDescriptor64) == 16, "MINIDUMP_MEMORY_DESCRIPTOR64 is 16 bytes");
+
+    constexpr uint32_t kSignature = 0x504d444d;         // "MDMP"
+    constexpr uint32_t kVersion = 0xa793;               // MINIDUMP_VERSION
+    constexpr uint64_t kWithFullMemory = 0x00000002;    // MiniDumpWithFullMemory
+    constexpr uint32_t kModuleListStream = 4;
+    constexpr uint32_t kSystemInfoStream = 7;
+    constexpr uint32_t kMemory64ListStream = 9;
+
+    struct SystemInfo {
+        uint16_t processor_architecture = 9;            // PROCESSOR_ARCHITECTURE_AMD64
+        uint16_t processor_level = 0;
+        uint16_t processor_revision = 0;
+        uint8_t number_of_processors = 0;
+        uint8_t product_type = 1;                       // VER_NT_WORKSTATION
+        uint32_t major_version = 0;
+        uint32_t minor_version = 0;
+        uint32_t build_number = 0;
+    };
+
+    struct Module {
+        uint64_t base;
+        uint32_t size;
+        uint32_t checksum;
+        uint32_t time_date_stamp;
+        std::u16string path;
+    };
+
+    struct Layout {
+        std::vector<char> headers;  // Everything before data_offset, ready to write at offset 0.
+        uint64_t data_offset = 0;   // BaseRva of the Memory64 data blob.
+        uint64_t file_size = 0;
+    };
+
+    Layout Plan(const std::vector<DumpFormat::RegionEntry>& regions, const std::vector<Module>& modules, const SystemInfo& system, uint32_t time_date_stamp);
+
+} // namespace Minidump
@@ -0,0 +1,98 @@
+#include "page_hashes.h"
+#include "dump_reader.h"
+#include "dump_writer.h"
+#include <algorithm>
+
+bool PageHashIndex::Save(const std::string& dump_path, const uint64_t dump_id[2], const std::vector<DumpFormat::RegionEntry>& regions,
+                         const std::vector<Hash128::Digest>& digests, std::string& error) {
+    DumpFormat::PageHashHeader header = {};
+    std::memcpy(header.magic, DumpFormat::kPageHashMagic, sizeof(header.magic));
+    header.version = DumpFormat::kPageHashVersion;
+    header.page_size = DumpFormat::kPageSize;
+    header.dump_id[0] = dump_id[0];
+    header.dump_id[1] = dump_id[1];
+    header.region_count = regions.size();
+    header.page_count = digests.size();
+    header.region_table_offset = sizeof(header);
+    header.digest_offset = header.region_table_offset + regions.size() * sizeof(DumpFormat::RegionEntry);
+
+    PositionalFile file;
+    if (!file.Open(SidecarPath(dump_path), error)) return false;
+    if (!file.WriteAt(0, &header, sizeof(header)) ||
+        !file.WriteAt(header.region_table_offset, regions.data(), regions.size() * sizeof(DumpFormat::RegionEntry)) ||
+        !file.WriteAt(header.digest_offset, digests.data(), digests.size() * sizeof(Hash128::Digest))) {
+        error = "Failed to write " + SidecarPath(dump_path);
+        return false;
+    }
+    return true;
+}
+
+bool PageHashIndex::LoadSidecar(const std::string& path) {
+    PositionalFile file;
+    std::string ignored;
+    if (!file.OpenForRead(path, ignored)) return false;
+    DumpFormat::PageHashHeader header = {};
+    if (file.ReadAt(0, &header, sizeof(header)) != sizeof(header) || !DumpFormat::HasPageHashMagic(header.magic) ||
+        header.version != DumpFormat::kPageHashVersion || header.page_size != DumpFormat::kPageSize) {
+        return false;
+    }
+    // Counts come from the file; check them against its size before allocating, so a truncated or
+    // corrupt sidecar falls back to rehashing instead of failing the allocation.
+    const uint64_t file_size = file.Size();
+    auto fits = [&](uint64_t offset, uint64_t count, uint64_t entry_size) { return offset <= file_size && count <= (file_size - offset) / entry_size; };
+    if (!fits(header.region_table_offset, header.region_count, sizeof(DumpFormat::RegionEntry)) ||
+        !fits(header.digest_offset, header.page_count, sizeof(Hash128::Digest))) {
+        return false;
+    }
+    regions.resize((size_t)header.region_count);
+    digests.resize((size_t)header.page_count);
+    const size_t region_bytes = regions.size() * sizeof(DumpFormat::RegionEntry);
+    const size_t digest_bytes = digests.size() * sizeof(Hash128::Digest);
+    if (file.ReadAt(header.region_table_offset, regions.data(), region_bytes) != region_bytes ||
+        file.ReadAt(header.digest_offset, digests.data(), digest_bytes) != digest_bytes) {
+        return false;
+    }
+    dump_id[0] = header.dump_id[0];
+    dump_id[1] = header.dump_id[1];
+    page_size = header.page_size;
+    return true;
+}
+
+bool PageHashIndex::Load(const std::string& dump_path, std::string& error) {
+    DumpReader reader;
+    if (!reader.Open(dump_path, error)) return false;
+    if (!reader.IsStructured() || reader.Header().page_size != DumpFormat::kPageSize) {
+        error = "Error: " + dump_path + " is not an optimized dump and cannot be used as a base.";
+        return false;
+    }
+    const auto& header = reader.Header();
+    if (LoadSidecar(SidecarPath(dump_path)) && dump_id[0] == header.dump_id[0] && dump_id[1] == header.dump_id[1]) return true;
+
+    // No usable sidecar: hash the dump's pages the same way the dumper does.
+    dump_id[0] = header.dump_id[0];
+    dump_id[1] = header.dump_id[1];
+    page_size = header.page_size;
+    regions = reader.Regions();
+    digests.assign(header.page_count, Hash128::Digest{});
+    std::vector<char> page(page_size);
+    for (uint64_t i = 0; i < header.page_count; ++i) {
+        const auto kind = DumpFormat::PageRefKind(reader.PageRef(i));
+        if (kind != DumpFormat::PAGE_STORED && kind != DumpFormat::PAGE_BASE) continue;
+        if (reader.Read(i * page_size, page.data(), page.size()) != page.size()) {
+            error = "Error: Could not read page data from " + dump_path;
+            return false;
+        }
+        digests[i] = Hash128::Compute(page.data(), page.size());
+    }
+    return true;
+}
+
+bool PageHashIndex::FindPage(uint64_t address, uint64_t& page_index) const {
+    // Region tables are written in ascending address order.
+    auto it = std::upper_bound(regions.begin(), regions.end(), address, [](uint64_t value, const auto& region) { return value < region.base_address; });
+    if (it == regions.begin()) return false;
+    const auto& region = *(it - 1);
+    if (address - region.base_address >= region.size) return false;
+    page_index = region.first_page + (address - region.base_address) / page_size;
+    return page_index < digests.size();
+}
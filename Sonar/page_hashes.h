@@ -0,0 +1,35 @@
+#pragma once
+
+#include "dump_format.h"
+#include "hash128.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-page content hashes of a structured dump, looked up by address. Incremental dumps use the
+// base dump's hashes to decide which pages changed without reading the base dump's page data.
+class PageHashIndex {
+public:
+    static std::string SidecarPath(const std::string& dump_path) { return dump_path + ".pagehash"; }
+
+    // Writes the sidecar for a dump. Digests are indexed like the dump's page table.
+    static bool Save(const std::string& dump_path, const uint64_t dump_id[2], const std::vector<DumpFormat::RegionEntry>& regions,
+                     const std::vector<Hash128::Digest>& digests, std::string& error);
+
+    // Loads the hashes of a structured dump from its sidecar. If the sidecar is missing or belongs
+    // to a different dump, the hashes are rebuilt by reading the dump.
+    bool Load(const std::string& dump_path, std::string& error);
+
+    const uint64_t* DumpId() const { return dump_id; }
+    // Finds the page covering `address`. Returns false if the dump has no page there.
+    bool FindPage(uint64_t address, uint64_t& page_index) const;
+    const Hash128::Digest& PageDigest(uint64_t page_index) const { return digests[page_index]; }
+
+private:
+    bool LoadSidecar(const std::string& path);
+
+    uint64_t dump_id[2] = {};
+    uint32_t page_size = DumpFormat::kPageSize;
+    std::vector<DumpFormat::RegionEntry> regions;
+    std::vector<Hash128::Digest> digests;
+};
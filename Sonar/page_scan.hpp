@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SONAR_PAGE_SCAN_SSE2 1
+#endif
+
+// Detects pages whose bytes all share one value (zero pages, 0xFF guard fills, ...). The dumper
+// runs this on every page before hashing, so it has to cost little more than reading the page.
+namespace PageScan {
+
+    // Returns true if all `size` bytes equal data[0], and reports that byte in `value`.
+    inline bool IsConstant(const void* data, size_t size, uint8_t& value) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        if (size == 0) return false;
+        value = bytes[0];
+        size_t i = 0;
+#ifdef SONAR_PAGE_SCAN_SSE2
+        // XOR every 64-byte block against the fill pattern and OR the differences together; check
+        // the accumulator once per block so a mismatch still exits early.
+        const __m128i pattern = _mm_set1_epi8(static_cast<char>(value));
+        for (; i + 64 <= size; i += 64) {
+            __m128i diff = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i)), pattern);
+            diff = _mm_or_si128(diff, _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i + 16)), pattern));
+            diff = _mm_or_si128(diff, _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i + 32)), pattern));
+            diff = _mm_or_si128(diff, _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i + 48)), pattern));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) != 0xFFFF) return false;
+        }
+#else
+        const uint64_t pattern = 0x0101010101010101ULL * value;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, bytes + i, sizeof(word));
+            if (word != pattern) return false;
+        }
+#endif
+        for (; i < size; ++i) {
+            if (bytes[i] != value) return false;
+        }
+        return true;
+    }
+
+} // namespace PageScan
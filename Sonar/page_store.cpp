@@ -0,0 +1,19 @@
+#include "page_store.h"
+
+PageStore::PageStore(size_t shard_count) {
+    // Round up to a power of two so the shard can be picked with a mask.
+    size_t count = 1;
+    while (count < shard_count) count <<= 1;
+    shards = std::make_unique<Shard[]>(count);
+    shard_mask = count - 1;
+}
+
+std::pair<uint64_t, bool> PageStore::Intern(const Hash128::Digest& digest) {
+    return Intern(digest, [this]() { return next_slot.fetch_add(1); });
+}
+
+void PageStore::Restore(const Hash128::Digest& digest, uint64_t slot) {
+    Shard& shard = ShardFor(digest);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.slots.emplace(digest, slot).second) ++stored_count;
+}
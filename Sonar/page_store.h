@@ -0,0 +1,55 @@
+#pragma once
+
+#include "hash128.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+// Content-addressed index of unique pages, sharded so concurrent dump workers rarely contend.
+// Each distinct page hash is assigned a stable slot in the dump's data section.
+class PageStore {
+public:
+    explicit PageStore(size_t shard_count = 64);
+
+    // Returns the slot holding this content and whether the caller is the first to see it
+    // (and therefore responsible for writing the page data).
+    std::pair<uint64_t, bool> Intern(const Hash128::Digest& digest);
+
+    // Same, but new content gets its slot from `allocate()` (called under the shard lock) instead of
+    // the shared counter. Compressed dumps use this to hand each worker its own run of slots.
+    template <typename Allocate>
+    std::pair<uint64_t, bool> Intern(const Hash128::Digest& digest, Allocate&& allocate) {
+        Shard& shard = ShardFor(digest);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.slots.find(digest);
+        if (it != shard.slots.end()) return { it->second, false };
+        uint64_t slot = allocate();
+        shard.slots.emplace(digest, slot);
+        ++stored_count;
+        return { slot, true };
+    }
+
+    uint64_t StoredCount() const { return stored_count.load(); }
+    // Resuming an interrupted dump: registers content the earlier run already stored at `slot`.
+    void Restore(const Hash128::Digest& digest, uint64_t slot);
+    // Slots handed out by Intern(digest), including any an interrupted run left unused.
+    uint64_t SlotCount() const { return next_slot.load(); }
+    void SetSlotCount(uint64_t count) { next_slot = count; }
+
+private:
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<Hash128::Digest, uint64_t, Hash128::DigestHasher> slots;
+    };
+
+    // The low half feeds the per-shard hash map, so select the shard from the high half.
+    Shard& ShardFor(const Hash128::Digest& digest) { return shards[static_cast<size_t>(digest.hi) & shard_mask]; }
+
+    std::unique_ptr<Shard[]> shards;
+    size_t shard_mask;
+    std::atomic<uint64_t> next_slot{ 0 };
+    std::atomic<uint64_t> stored_count{ 0 };
+};
@@ -0,0 +1,225 @@
+#include "provenance.h"
+#include "dump_writer.h"
+#include "string_scan.hpp"
+#include "string_set.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const char kMagic[8] = { 'S', 'O', 'N', 'A', 'R', 'P', 'R', 'V' };
+    constexpr uint32_t kVersion = 1;
+
+    struct SidecarHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t max_addresses;
+        uint64_t string_count;
+        uint64_t hashes_offset;
+        uint64_t encodings_offset;
+        uint64_t counts_offset;
+        uint64_t address_offsets_offset;
+        uint64_t address_data_offset;
+        uint64_t address_data_size;
+    };
+
+    // Payload: count, encoding mask, number of addresses, then the addresses (ascending).
+    struct PayloadHeader {
+        uint32_t count;
+        uint8_t encodings;
+        uint8_t address_count;
+        uint16_t reserved;
+    };
+
+    // Payloads sit in front of unaligned strings, so they are only accessed through memcpy.
+    PayloadHeader ReadHeader(const char* payload) {
+        PayloadHeader header;
+        std::memcpy(&header, payload, sizeof(header));
+        return header;
+    }
+    uint64_t ReadAddress(const char* payload, size_t i) {
+        uint64_t address;
+        std::memcpy(&address, payload + sizeof(PayloadHeader) + i * sizeof(uint64_t), sizeof(address));
+        return address;
+    }
+    void WriteAddress(char* payload, size_t i, uint64_t address) { std::memcpy(payload + sizeof(PayloadHeader) + i * sizeof(uint64_t), &address, sizeof(address)); }
+
+    // Keeps the lowest `max_addresses` addresses, ascending and without repeats.
+    void InsertAddress(char* payload, PayloadHeader& header, size_t max_addresses, uint64_t address) {
+        size_t pos = 0;
+        while (pos < header.address_count && ReadAddress(payload, pos) < address) ++pos;
+        if (pos < header.address_count && ReadAddress(payload, pos) == address) return;
+        if (pos >= max_addresses) return;
+        const size_t last = std::min<size_t>(header.address_count, max_addresses - 1);
+        for (size_t i = last; i > pos; --i) WriteAddress(payload, i, ReadAddress(payload, i - 1));
+        WriteAddress(payload, pos, address);
+        header.address_count = (uint8_t)std::min<size_t>(header.address_count + 1, max_addresses);
+    }
+
+    void PutVarint(std::vector<uint8_t>& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((uint8_t)value);
+    }
+    bool GetVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && p < end; shift += 7) {
+            const uint8_t byte = *p++;
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+}
+
+namespace Provenance {
+
+    std::string EncodingNames(uint8_t encodings) {
+        std::string names;
+        for (size_t e = 0; e < StringScan::kEncodingCount; ++e) {
+            const StringScan::Encoding encoding = (StringScan::Encoding)(1u << e);
+            if (!(encodings & encoding)) continue;
+            if (!names.empty()) names += ", ";
+            names += StringScan::EncodingName(encoding);
+        }
+        return names;
+    }
+
+    size_t PayloadSize(size_t max_addresses) { return sizeof(PayloadHeader) + max_addresses * sizeof(uint64_t); }
+
+    void AddOccurrence(char* payload, size_t max_addresses, uint8_t encoding, uint64_t address) {
+        PayloadHeader header = ReadHeader(payload);
+        if (header.count != UINT32_MAX) ++header.count;
+        header.encodings |= encoding;
+        InsertAddress(payload, header, max_addresses, address);
+        std::memcpy(payload, &header, sizeof(header));
+    }
+
+    void MergePayload(char* kept, const char* duplicate, size_t max_addresses) {
+        PayloadHeader header = ReadHeader(kept);
+        const PayloadHeader other = ReadHeader(duplicate);
+        header.count = (uint32_t)std::min<uint64_t>((uint64_t)header.count + other.count, UINT32_MAX);
+        header.encodings |= other.encodings;
+        for (size_t i = 0; i < other.address_count; ++i) InsertAddress(kept, header, max_addresses, ReadAddress(duplicate, i));
+        std::memcpy(kept, &header, sizeof(header));
+    }
+
+    void DecodePayload(const char* payload, size_t max_addresses, Record& record) {
+        const PayloadHeader header = ReadHeader(payload);
+        record.count = header.count;
+        record.encodings = header.encodings;
+        record.addresses.clear();
+        for (size_t i = 0; i < header.address_count && i < max_addresses; ++i) record.addresses.push_back(ReadAddress(payload, i));
+    }
+
+    void Writer::Add(uint64_t hash, const char* payload) {
+        const PayloadHeader header = ReadHeader(payload);
+        const size_t address_count = std::min<size_t>(header.address_count, max_addresses);
+        rows.push_back({ hash, addresses.size(), header.count, header.encodings, (uint8_t)address_count });
+        for (size_t i = 0; i < address_count; ++i) addresses.push_back(ReadAddress(payload, i));
+    }
+
+    bool Writer::Save(const std::string& dump_path, std::string& error) {
+        std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.hash < b.hash; });
+        const uint64_t count = rows.size();
+        std::vector<uint64_t> hashes;
+        std::vector<uint8_t> encodings;
+        std::vector<uint32_t> counts;
+        std::vector<uint64_t> address_offsets;
+        std::vector<uint8_t> address_data;
+        hashes.reserve(count);
+        encodings.reserve(count);
+        counts.reserve(count);
+        address_offsets.reserve(count + 1);
+        for (const Row& row : rows) {
+            hashes.push_back(row.hash);
+            encodings.push_back(row.encodings);
+            counts.push_back(row.count);
+            address_offsets.push_back(address_data.size());
+            PutVarint(address_data, row.address_count);
+            uint64_t previous = 0;
+            for (size_t a = 0; a < row.address_count; ++a) {
+                const uint64_t address = addresses[row.address_first + a];
+                PutVarint(address_data, address - previous);
+                previous = address;
+            }
+        }
+        address_offsets.push_back(address_data.size());
+        rows.clear();
+        addresses.clear();
+
+        // Columns are laid out in order, the 64-bit ones first so they stay aligned when mapped.
+        SidecarHeader header = {};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.max_addresses = (uint32_t)max_addresses;
+        header.string_count = count;
+        header.hashes_offset = sizeof(SidecarHeader);
+        header.address_offsets_offset = header.hashes_offset + count * sizeof(uint64_t);
+        header.counts_offset = header.address_offsets_offset + (count + 1) * sizeof(uint64_t);
+        header.encodings_offset = header.counts_offset + count * sizeof(uint32_t);
+        header.address_data_offset = header.encodings_offset + count;
+        header.address_data_size = address_data.size();
+
+        PositionalFile file;
+        std::string file_error;
+        const std::string path = SidecarPath(dump_path);
+        if (!file.Open(path, file_error)) { error = "Could not create provenance sidecar: " + file_error; return false; }
+        const bool ok = file.WriteAt(0, &header, sizeof(header)) &&
+                        file.WriteAt(header.hashes_offset, hashes.data(), hashes.size() * sizeof(uint64_t)) &&
+                        file.WriteAt(header.address_offsets_offset, address_offsets.data(), address_offsets.size() * sizeof(uint64_t)) &&
+                        file.WriteAt(header.counts_offset, counts.data(), counts.size() * sizeof(uint32_t)) &&
+                        file.WriteAt(header.encodings_offset, encodings.data(), encodings.size()) &&
+                        file.WriteAt(header.address_data_offset, address_data.data(), address_data.size());
+        if (!ok) { error = "Could not write provenance sidecar " + path; return false; }
+        return true;
+    }
+
+    bool Index::Open(const std::string& dump_path, std::string& error) {
+        const std::string path = SidecarPath(dump_path);
+        if (!file.Open(path, error)) return false;
+        SidecarHeader header;
+        if (file.Size() < sizeof(header)) { error = "Provenance sidecar is truncated: " + path; file.Close(); return false; }
+        std::memcpy(&header, file.Data(), sizeof(header));
+        const uint64_t count = header.string_count;
+        auto fits = [&](uint64_t offset, uint64_t bytes) { return offset <= file.Size() && bytes <= file.Size() - offset; };
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion || count > file.Size() ||
+            !fits(header.hashes_offset, count * sizeof(uint64_t)) || !fits(header.address_offsets_offset, (count + 1) * sizeof(uint64_t)) ||
+            !fits(header.counts_offset, count * sizeof(uint32_t)) || !fits(header.encodings_offset, count) ||
+            !fits(header.address_data_offset, header.address_data_size)) {
+            error = "Not a valid provenance sidecar: " + path;
+            file.Close();
+            return false;
+        }
+        string_count = count;
+        hashes = reinterpret_cast<const uint64_t*>(file.Data() + header.hashes_offset);
+        address_offsets = reinterpret_cast<const uint64_t*>(file.Data() + header.address_offsets_offset);
+        counts = reinterpret_cast<const uint32_t*>(file.Data() + header.counts_offset);
+        encodings = reinterpret_cast<const uint8_t*>(file.Data() + header.encodings_offset);
+        address_data = reinterpret_cast<const uint8_t*>(file.Data() + header.address_data_offset);
+        address_data_size = header.address_data_size;
+        return true;
+    }
+
+    bool Index::Find(std::string_view text, Record& record) const {
+        if (!IsOpen()) return false;
+        const uint64_t hash = StringInternSet::Hash(text);
+        const uint64_t* row = std::lower_bound(hashes, hashes + string_count, hash);
+        if (row == hashes + string_count || *row != hash) return false;
+        const size_t i = (size_t)(row - hashes);
+        record.encodings = encodings[i];
+        record.count = counts[i];
+        record.addresses.clear();
+        if (address_offsets[i] > address_data_size) return false;
+        const uint8_t* p = address_data + address_offsets[i];
+        const uint8_t* end = address_data + std::min(address_offsets[i + 1], address_data_size);
+        uint64_t address_count = 0, address = 0, delta = 0;
+        if (!GetVarint(p, end, address_count)) return false;
+        for (uint64_t a = 0; a < address_count && GetVarint(p, end, delta); ++a) {
+            address += delta;
+            record.addresses.push_back(address);
+        }
+        return true;
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Where the strings of a text dump came from: for each unique string, the encodings it was found
+// in, how often it occurred and its lowest addresses. Kept as a columnar sidecar next to the dump
+// (`<dump>.prov`), keyed by string hash, so one string can be looked up without reading the dump:
+//
+//   Header | hashes[string_count] (sorted) | address_offsets[string_count + 1] | counts[string_count]
+//          | encodings[string_count] | address data
+//
+// Each row's addresses are stored ascending as varints: the first one absolute, the rest as
+// deltas from the previous address.
+namespace Provenance {
+
+    struct Record {
+        uint8_t encodings = 0;              // StringScan::Encoding bits.
+        uint32_t count = 0;
+        std::vector<uint64_t> addresses;    // Ascending, at most the dump's address limit.
+    };
+
+    inline std::string SidecarPath(const std::string& dump_path) { return dump_path + ".prov"; }
+    // Short description of an encoding mask, e.g. "ASCII, UTF-16LE".
+    std::string EncodingNames(uint8_t encodings);
+
+    // Per-string payload kept in the text dumper's string sets while extracting (see
+    // StringInternSet). `max_addresses` is the same for every payload of one dump.
+    size_t PayloadSize(size_t max_addresses);
+    // Counts one occurrence at `address`.
+    void AddOccurrence(char* payload, size_t max_addresses, uint8_t encoding, uint64_t address);
+    // Folds the occurrences of `duplicate` into `kept`.
+    void MergePayload(char* kept, const char* duplicate, size_t max_addresses);
+    void DecodePayload(const char* payload, size_t max_addresses, Record& record);
+
+    // Builds the sidecar from (string hash, payload) rows.
+    class Writer {
+    public:
+        explicit Writer(size_t address_limit) : max_addresses(address_limit) {}
+        void Add(uint64_t hash, const char* payload);
+        bool Save(const std::string& dump_path, std::string& error);
+
+    private:
+        // One row per string. Its addresses are the `address_count` entries of `addresses` starting
+        // at `address_first`, so a dump with tens of millions of strings needs no allocation per row.
+        struct Row {
+            uint64_t hash;
+            uint64_t address_first;
+            uint32_t count;
+            uint8_t encodings;
+            uint8_t address_count;
+        };
+
+        size_t max_addresses;
+        std::vector<Row> rows;
+        std::vector<uint64_t> addresses;
+    };
+
+    // Memory-mapped sidecar. Lookups binary-search the hash column and decode one row.
+    class Index {
+    public:
+        bool Open(const std::string& dump_path, std::string& error);
+        bool IsOpen() const { return file.IsOpen(); }
+        uint64_t StringCount() const { return string_count; }
+        // Finds the record of `text` (UTF-8, as written to the dump).
+        bool Find(std::string_view text, Record& record) const;
+
+    private:
+        MappedFile file;
+        uint64_t string_count = 0;
+        const uint64_t* hashes = nullptr;
+        const uint8_t* encodings = nullptr;
+        const uint32_t* counts = nullptr;
+        const uint64_t* address_offsets = nullptr;
+        const uint8_t* address_data = nullptr;
+        uint64_t address_data_size = 0;
+    };
+}
@@ -0,0 +1,38 @@
+#include "string_arena.h"
+#include <algorithm>
+#include <cstring>
+
+char* StringArena::Reserve(size_t max_size) {
+    if (blocks.empty() || blocks.back().size - blocks.back().used < max_size) {
+        // Oversized strings get a block of their own rather than wasting the rest of a normal one.
+        Block block;
+        block.size = std::max(block_size, max_size);
+        block.data = std::make_unique<char[]>(block.size);
+        bytes_reserved += block.size;
+        blocks.push_back(std::move(block));
+    }
+    return blocks.back().data.get() + blocks.back().used;
+}
+
+std::string_view StringArena::Commit(size_t size) {
+    Block& block = blocks.back();
+    std::string_view text(block.data.get() + block.used, size);
+    block.used += size;
+    bytes_used += size;
+    return text;
+}
+
+std::string_view StringArena::Append(std::string_view text) {
+    char* out = Reserve(text.size());
+    if (!text.empty()) std::memcpy(out, text.data(), text.size());
+    return Commit(text.size());
+}
+
+void StringArena::Clear() {
+    if (blocks.size() > 1) blocks.resize(1);
+    if (!blocks.empty()) {
+        blocks[0].used = 0;
+        bytes_reserved = blocks[0].size;
+    }
+    bytes_used = 0;
+}
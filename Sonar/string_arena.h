@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Append-only storage for many short strings. Memory is taken in large blocks that never move, so
+// views into the arena stay valid until Clear(). Not thread-safe; text dump workers own one each.
+class StringArena {
+public:
+    explicit StringArena(size_t block_bytes = 1024 * 1024) : block_size(block_bytes) {}
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+    StringArena(StringArena&&) = default;
+    StringArena& operator=(StringArena&&) = default;
+
+    // Returns space for up to `max_size` bytes. Commit() then keeps the first `size` of them; the
+    // rest is reused by the next reservation.
+    char* Reserve(size_t max_size);
+    std::string_view Commit(size_t size);
+    std::string_view Append(std::string_view text);
+
+    // Drops every string but keeps the first block for reuse.
+    void Clear();
+    size_t BytesUsed() const { return bytes_used; }
+    size_t BytesReserved() const { return bytes_reserved; }
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+        size_t used = 0;
+    };
+
+    size_t block_size;
+    std::vector<Block> blocks;
+    size_t bytes_used = 0;
+    size_t bytes_reserved = 0;
+};
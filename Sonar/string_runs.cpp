@@ -0,0 +1,321 @@
+#include "string_runs.h"
+#include "dump_format.h"
+#include "frame_file.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+namespace {
+    constexpr size_t kSampleInterval = 1024;
+    constexpr size_t kIoBufferSize = 1024 * 1024;
+    constexpr size_t kReadBufferSize = 64 * 1024;
+    // Key ranges per merge thread; more ranges than threads evens out skewed key distributions.
+    constexpr size_t kRangesPerThread = 4;
+
+    // Appends to a PositionalFile through a buffer.
+    class BufferedWriter {
+    public:
+        explicit BufferedWriter(PositionalFile& target) : file(target) { buffer.reserve(kIoBufferSize); }
+        bool Write(const char* data, size_t size) {
+            if (buffer.size() + size > kIoBufferSize && !Flush()) return false;
+            if (size > kIoBufferSize) {
+                if (!file.WriteAt(offset, data, size)) return false;
+                offset += size;
+                return true;
+            }
+            buffer.insert(buffer.end(), data, data + size);
+            return true;
+        }
+        bool Flush() {
+            if (buffer.empty()) return true;
+            if (!file.WriteAt(offset, buffer.data(), buffer.size())) return false;
+            offset += buffer.size();
+            buffer.clear();
+            return true;
+        }
+        uint64_t Offset() const { return offset + buffer.size(); }
+
+    private:
+        PositionalFile& file;
+        std::vector<char> buffer;
+        uint64_t offset = 0;
+    };
+
+    // Reads one run line by line from a starting offset.
+    class RunReader {
+    public:
+        bool Open(const std::string& path, uint64_t start, std::string& error) {
+            if (!file.OpenForRead(path, error)) return false;
+            file_offset = start;
+            file_size = file.Size();
+            buffer.resize(kReadBufferSize);
+            return true;
+        }
+        // Advances to the next line; false at the end of the run.
+        bool Next() {
+            line.clear();
+            for (;;) {
+                if (pos == end) {
+                    if (file_offset >= file_size) return !line.empty();
+                    end = file.ReadAt(file_offset, buffer.data(), buffer.size());
+                    if (end == 0) return !line.empty();
+                    file_offset += end;
+                    pos = 0;
+                }
+                const char* start = buffer.data() + pos;
+                const char* newline = static_cast<const char*>(std::memchr(start, '\n', end - pos));
+                if (newline) {
+                    line.append(start, newline - start);
+                    pos += (newline - start) + 1;
+                    return true;
+                }
+                line.append(start, end - pos);
+                pos = end;
+            }
+        }
+        const std::string& Line() const { return line; }
+
+    private:
+        PositionalFile file;
+        std::vector<char> buffer;
+        size_t pos = 0;
+        size_t end = 0;
+        uint64_t file_offset = 0;
+        uint64_t file_size = 0;
+        std::string line;
+    };
+}
+
+struct SortedStringRuns::Cursor::Readers {
+    std::vector<RunReader> runs;
+    std::vector<size_t> heap;   // Runs with a line in range, as a min-heap on their current line.
+};
+
+SortedStringRuns::Cursor::Cursor(const SortedStringRuns& source, const std::string* from, const std::string* to) : runs(source), lower(from), upper(to) {}
+
+SortedStringRuns::Cursor::~Cursor() = default;
+
+bool SortedStringRuns::Cursor::Open(std::string& error) {
+    // Open every run at its last sample before `lower` and skip the few lines still below it.
+    readers = std::make_unique<Readers>();
+    readers->runs = std::vector<RunReader>(runs.runs.size());
+    for (size_t r = 0; r < runs.runs.size(); ++r) {
+        uint64_t start = 0;
+        if (lower) {
+            const auto& samples = runs.runs[r].samples;
+            auto it = std::lower_bound(samples.begin(), samples.end(), *lower, [](const auto& sample, const std::string& key) { return sample.first < key; });
+            if (it != samples.begin()) start = std::prev(it)->second;
+        }
+        RunReader& reader = readers->runs[r];
+        if (!reader.Open(runs.runs[r].path, start, error)) return false;
+        bool has_line = reader.Next();
+        while (has_line && lower && reader.Line() < *lower) has_line = reader.Next();
+        if (has_line && (!upper || reader.Line() < *upper)) readers->heap.push_back(r);
+    }
+    return true;
+}
+
+bool SortedStringRuns::Cursor::Next() {
+    auto& heap = readers->heap;
+    auto& run_readers = readers->runs;
+    auto greater = [&](size_t a, size_t b) { return run_readers[a].Line() > run_readers[b].Line(); };
+    if (!started) {
+        std::make_heap(heap.begin(), heap.end(), greater);
+        started = true;
+    }
+    // Runs are unique on their own, so duplicates only appear across runs, next to each other.
+    bool have_current = false;
+    while (!heap.empty()) {
+        const size_t r = heap.front();
+        if (have_current && run_readers[r].Line() != current) return true;
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        heap.pop_back();
+        if (!have_current) {
+            current = run_readers[r].Line();
+            have_current = true;
+        }
+        if (run_readers[r].Next() && (!upper || run_readers[r].Line() < *upper)) {
+            heap.push_back(r);
+            std::push_heap(heap.begin(), heap.end(), greater);
+        }
+    }
+    return have_current;
+}
+
+SortedStringRuns::SortedStringRuns(std::string prefix, TokenBucket* limit) : temp_prefix(std::move(prefix)), write_limit(limit) {}
+
+SortedStringRuns::~SortedStringRuns() { RemoveTempFiles(); }
+
+void SortedStringRuns::RemoveTempFiles() {
+    std::error_code ignored;
+    for (const auto& run : runs) std::filesystem::remove(run.path, ignored);
+    for (const auto& path : part_paths) std::filesystem::remove(path, ignored);
+    runs.clear();
+    part_paths.clear();
+}
+
+size_t SortedStringRuns::RunCount() const {
+    std::lock_guard<std::mutex> lock(runs_mutex);
+    return runs.size();
+}
+
+uint64_t SortedStringRuns::StringCount() const {
+    std::lock_guard<std::mutex> lock(runs_mutex);
+    uint64_t count = 0;
+    for (const auto& run : runs) count += run.strings;
+    return count;
+}
+
+bool SortedStringRuns::AddRun(std::vector<std::string_view>& strings, std::string& error) {
+    std::sort(strings.begin(), strings.end());
+    strings.erase(std::unique(strings.begin(), strings.end()), strings.end());
+    // Claim the run's slot (and file name) first; it is filled in once the file is written.
+    Run run;
+    size_t run_index;
+    {
+        std::lock_guard<std::mutex> lock(runs_mutex);
+        run_index = runs.size();
+        run.path = temp_prefix + ".run" + std::to_string(run_index);
+        runs.push_back({ run.path, 0, 0, {} });
+    }
+    PositionalFile file;
+    std::string file_error;
+    if (!file.Open(run.path, file_error)) { error = "Could not create sort run: " + file_error; return false; }
+    file.SetWriteLimit(write_limit);
+    BufferedWriter writer(file);
+    for (size_t i = 0; i < strings.size(); ++i) {
+        if (i % kSampleInterval == 0) run.samples.emplace_back(std::string(strings[i]), writer.Offset());
+        if (!writer.Write(strings[i].data(), strings[i].size()) || !writer.Write("\n", 1)) { error = "Could not write sort run " + run.path; return false; }
+    }
+    if (!writer.Flush()) { error = "Could not write sort run " + run.path; return false; }
+    run.size = writer.Offset();
+    run.strings = strings.size();
+    std::lock_guard<std::mutex> lock(runs_mutex);
+    runs[run_index] = std::move(run);
+    return true;
+}
+
+bool SortedStringRuns::MergeRange(const std::string* lower, const std::string* upper, const std::string& part_path, uint64_t& part_size, FrontCoded::BlockIndex* part_index, std::string& error) const {
+    Cursor cursor(*this, lower, upper);
+    if (!cursor.Open(error)) return false;
+    PositionalFile file;
+    std::string file_error;
+    if (!file.Open(part_path, file_error)) { error = "Could not create merge output: " + file_error; return false; }
+    file.SetWriteLimit(write_limit);
+    BufferedWriter writer(file);
+    FrontCoded::BlockEncoder encoder([&](const char* data, size_t size) { return writer.Write(data, size); });
+    while (cursor.Next()) {
+        const std::string& line = cursor.Current();
+        const bool ok = part_index ? encoder.Add(line) : writer.Write(line.data(), line.size()) && writer.Write("\n", 1);
+        if (!ok) { error = "Could not write merge output " + part_path; return false; }
+    }
+    if (!writer.Flush()) { error = "Could not write merge output " + part_path; return false; }
+    part_size = writer.Offset();
+    if (part_index) *part_index = encoder.Index();
+    return true;
+}
+
+bool SortedStringRuns::Merge(const std::string& output_path, bool compress, bool front_coded, int thread_count, uint64_t& bytes_written, std::string& error) {
+    thread_count = std::max(1, thread_count);
+    if (front_coded) compress = false;
+    // Splitters: evenly spaced keys among all samples, so each range holds a similar share of lines.
+    std::vector<std::string> keys;
+    for (const auto& run : runs) {
+        for (const auto& sample : run.samples) keys.push_back(sample.first);
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    std::vector<std::string> splitters;
+    const size_t range_count = std::min(keys.size(), (size_t)thread_count * kRangesPerThread);
+    for (size_t i = 1; i < range_count; ++i) splitters.push_back(keys[i * keys.size() / range_count]);
+    splitters.erase(std::unique(splitters.begin(), splitters.end()), splitters.end());
+    keys.clear();
+    keys.shrink_to_fit();
+
+    const size_t part_count = splitters.size() + 1;
+    for (size_t p = 0; p < part_count; ++p) part_paths.push_back(temp_prefix + ".part" + std::to_string(p));
+    std::vector<uint64_t> part_sizes(part_count, 0);
+    std::vector<FrontCoded::BlockIndex> part_indexes(front_coded ? part_count : 0);
+    std::atomic<size_t> next_part = 0;
+    std::atomic<bool> failed = false;
+    std::mutex error_mutex;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&]() {
+            for (size_t p = next_part++; p < part_count && !failed; p = next_part++) {
+                const std::string* lower = p > 0 ? &splitters[p - 1] : nullptr;
+                const std::string* upper = p < splitters.size() ? &splitters[p] : nullptr;
+                std::string part_error;
+                if (!MergeRange(lower, upper, part_paths[p], part_sizes[p], front_coded ? &part_indexes[p] : nullptr, part_error)) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!failed.exchange(true)) error = part_error;
+                }
+            }
+            });
+    }
+    for (auto& th : threads) th.join();
+    if (failed) return false;
+
+    // The parts are consecutive pieces of the output; copy them into place in parallel, as frames
+    // when compressing. Front-coded parts are block data: they land after the header and their
+    // indexes are joined into the file's index.
+    std::vector<uint64_t> part_offsets(part_count + 1, 0);
+    for (size_t p = 0; p < part_count; ++p) part_offsets[p + 1] = part_offsets[p] + part_sizes[p];
+    const uint64_t text_size = part_offsets[part_count];
+    const uint64_t data_offset = front_coded ? FrontCoded::DataOffset() : 0;
+    std::vector<PositionalFile> parts(part_count);
+    for (size_t p = 0; p < part_count; ++p) {
+        if (!parts[p].OpenForRead(part_paths[p], error)) return false;
+    }
+    PositionalFile out_file;
+    FrameWriter frame_out;
+    std::string file_error;
+    if (!(compress ? frame_out.Open(output_path, file_error) : out_file.Open(output_path, file_error))) { error = "Failed to create final output file: " + file_error; return false; }
+    out_file.SetWriteLimit(write_limit);
+    frame_out.SetWriteLimit(write_limit);
+    const size_t block_size = compress ? DumpFormat::kFrameSize : kIoBufferSize * 4;
+    const size_t block_count = (size_t)((text_size + block_size - 1) / block_size);
+    std::atomic<size_t> next_block = 0;
+    threads.clear();
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&]() {
+            std::vector<char> block(block_size);
+            for (size_t b = next_block++; b < block_count && !failed; b = next_block++) {
+                const uint64_t begin = (uint64_t)b * block_size;
+                const uint64_t end = std::min<uint64_t>(begin + block_size, text_size);
+                size_t p = (size_t)(std::upper_bound(part_offsets.begin(), part_offsets.end(), begin) - part_offsets.begin()) - 1;
+                for (uint64_t pos = begin; pos < end; ++p) {
+                    const uint64_t take = std::min(end, part_offsets[p + 1]) - pos;
+                    if (parts[p].ReadAt(pos - part_offsets[p], block.data() + (pos - begin), (size_t)take) != take) { failed = true; break; }
+                    pos += take;
+                }
+                if (failed) break;
+                const bool ok = compress ? frame_out.WriteFrame(begin, block.data(), (size_t)(end - begin)) : out_file.WriteAt(data_offset + begin, block.data(), (size_t)(end - begin));
+                if (!ok) failed = true;
+            }
+            });
+    }
+    for (auto& th : threads) th.join();
+    for (auto& part : parts) part.Close();
+    if (compress) {
+        if (!frame_out.Finish(text_size)) failed = true;
+        bytes_written = frame_out.BytesWritten();
+    }
+    else if (front_coded) {
+        FrontCoded::BlockIndex index;
+        for (size_t p = 0; p < part_count; ++p) index.Append(part_indexes[p], part_offsets[p]);
+        std::string index_error;
+        if (!failed && !FrontCoded::WriteIndex(out_file, index, text_size, index_error)) failed = true;
+        bytes_written = out_file.Size();
+        out_file.Close();
+    }
+    else {
+        out_file.Close();
+        bytes_written = text_size;
+    }
+    RemoveTempFiles();
+    if (failed) { error = "Failed while writing output file: " + output_path; return false; }
+    return true;
+}
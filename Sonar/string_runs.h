@@ -0,0 +1,79 @@
+#pragma once
+
+#include "dump_writer.h"
+#include "front_coded.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// External-memory sort for text dumps. Workers hand over their strings whenever they exceed their
+// memory budget; each batch is sorted, deduplicated and written as a run file of newline-terminated
+// lines. Merge() then combines the runs into one sorted, duplicate-free text. Several threads merge
+// disjoint key ranges, found from keys sampled while the runs were written, so memory stays bounded
+// by the read buffers no matter how many strings the target holds.
+class SortedStringRuns {
+public:
+    // Run and part files are created as `prefix` + ".run<N>" / ".part<N>" and removed by
+    // Merge() or the destructor. Writes are charged to `limit` (may be null).
+    SortedStringRuns(std::string prefix, TokenBucket* limit);
+    ~SortedStringRuns();
+    SortedStringRuns(const SortedStringRuns&) = delete;
+    SortedStringRuns& operator=(const SortedStringRuns&) = delete;
+
+    // Sorts `strings` in place and writes them as a new run. Strings must not contain '\n'.
+    // Thread-safe.
+    bool AddRun(std::vector<std::string_view>& strings, std::string& error);
+    size_t RunCount() const;
+
+    // Strings written to runs so far, counting a string once per run it is in.
+    uint64_t StringCount() const;
+
+    // Writes the merged runs to `output_path`: front-coded (see front_coded.h) when `front_coded` is
+    // set, otherwise as lines, framed (compressed) when `compress` is set.
+    bool Merge(const std::string& output_path, bool compress, bool front_coded, int thread_count, uint64_t& bytes_written, std::string& error);
+
+    // Streams the merged runs in order without duplicates, limited to keys in [from, to) when
+    // those are given. No runs may be added while a cursor is open.
+    class Cursor {
+    public:
+        Cursor(const SortedStringRuns& source, const std::string* from = nullptr, const std::string* to = nullptr);
+        ~Cursor();
+        bool Open(std::string& error);
+        // Advances to the next string; false at the end.
+        bool Next();
+        const std::string& Current() const { return current; }
+
+    private:
+        struct Readers;
+
+        const SortedStringRuns& runs;
+        const std::string* lower;
+        const std::string* upper;
+        std::unique_ptr<Readers> readers;
+        std::string current;
+        bool started = false;
+    };
+
+private:
+    struct Run {
+        std::string path;
+        uint64_t size = 0;
+        uint64_t strings = 0;
+        // Every kSampleInterval-th line and its file offset: merge splitters and seek points.
+        std::vector<std::pair<std::string, uint64_t>> samples;
+    };
+
+    // Merges one key range into a part file, front-coded when `part_index` is given.
+    bool MergeRange(const std::string* lower, const std::string* upper, const std::string& part_path, uint64_t& part_size, FrontCoded::BlockIndex* part_index, std::string& error) const;
+    void RemoveTempFiles();
+
+    std::string temp_prefix;
+    TokenBucket* write_limit;
+    mutable std::mutex runs_mutex;
+    std::vector<Run> runs;
+    std::vector<std::string> part_paths;
+};
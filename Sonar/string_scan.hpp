@@ -0,0 +1,545 @@
+#pragma once
+
+#include "string_arena.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#include <immintrin.h>
+#define SONAR_STRING_SCAN_SSE2 1
+#if defined(_MSC_VER)
+#define SONAR_TARGET_AVX2
+#else
+#define SONAR_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// Finds runs of printable ASCII (0x20-0x7E, what isprint() accepts in the "C" locale) in a buffer.
+// The text dumper and the differential analyzer run this over every byte they read, so bytes are
+// classified 16 or 32 at a time into bitmasks and runs are cut at the mask's bit transitions;
+// the cost per run is a couple of bit scans instead of a branch per byte.
+//
+// The text dumper also extracts UTF-8, Latin-1 and UTF-16 in the same pass (ExtractStrings): each
+// block is classified once into a few byte-class masks and every encoding's mask is derived from
+// those. At even byte offsets UTF-16 units count as printable anywhere in the BMP except the C0/C1
+// controls, surrogates and noncharacters. At odd offsets, which only unaligned strings use, units
+// must be printable Latin-1 (U+0020-U+007E, U+00A0-U+00FF): the wide class there would read
+// ordinary 8-bit text as CJK and flood the output.
+namespace StringScan {
+
+    struct Span {
+        size_t offset;
+        size_t length;
+    };
+
+
+    // Encodings the extractor recognizes. The values are bits so sets of them fit a mask; provenance
+    // sidecars store them as-is.
+    enum Encoding : uint8_t {
+        ENCODING_ASCII = 1,
+        ENCODING_UTF16LE = 2,
+        ENCODING_UTF8 = 4,
+        ENCODING_UTF16BE = 8,
+        ENCODING_LATIN1 = 16,
+    };
+    constexpr size_t kEncodingCount = 5;
+
+    // Position of an encoding's bit, for per-encoding tables.
+    inline size_t EncodingIndex(Encoding encoding) {
+        size_t index = 0;
+        while ((1u << index) != encoding) ++index;
+        return index;
+    }
+
+    inline const char* EncodingName(Encoding encoding) {
+        static const char* const kNames[kEncodingCount] = { "ASCII", "UTF-16LE", "UTF-8", "UTF-16BE", "Latin-1" };
+        return kNames[EncodingIndex(encoding)];
+    }
+
+    struct ExtractSettings {
+        unsigned encodings = ENCODING_ASCII;
+        size_t min_length[kEncodingCount] = { 4, 4, 4, 4, 4 };     // Characters, indexed by EncodingIndex().
+    };
+
+    namespace Detail {
+        // Bytes are classified in blocks of 64, one mask bit per byte.
+        constexpr size_t kBlock = 64;
+        // Masks are built in batches so the ISA-specific loop stays out of the run walker.
+        constexpr size_t kBatchBlocks = 64;
+
+        inline unsigned CountTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward64(&index, value);
+            return (unsigned)index;
+#else
+            return (unsigned)__builtin_ctzll(value);
+#endif
+        }
+
+        inline uint64_t LowBits(unsigned count) { return count >= 64 ? ~0ULL : (1ULL << count) - 1; }
+
+        inline uint64_t ScalarMask(const unsigned char* bytes, size_t count) {
+            uint64_t mask = 0;
+            for (size_t i = 0; i < count; ++i) mask |= (uint64_t)((unsigned char)(bytes[i] - 0x20) < 0x5F) << i;
+            return mask;
+        }
+
+        inline uint16_t LoadUnit(const unsigned char* bytes) { return (uint16_t)(bytes[0] | (bytes[1] << 8)); }
+
+        // Byte classes of one block for the multi-encoding pass, one bit per byte.
+        struct ClassMasks {
+            uint64_t ascii;         // Printable ASCII, 0x20-0x7E.
+            uint64_t high;          // Printable upper Latin-1, 0xA0-0xFF.
+            uint64_t non_ascii;     // 0x80-0xFF.
+            uint64_t zero;
+            // High bytes of UTF-16 units beyond Latin-1, and the bytes that make noncharacters.
+            uint64_t wide;          // 0x01-0xD7 and 0xE0-0xFF: not zero and not a surrogate.
+            uint64_t fd;            // 0xFD, with a low byte of 0xD0-0xEF: U+FDD0-U+FDEF.
+            uint64_t fdd0;          // 0xD0-0xEF.
+            uint64_t ff;            // 0xFF, with a low byte of 0xFE-0xFF: U+FFFE and U+FFFF.
+            uint64_t fe_ff;         // 0xFE-0xFF.
+        };
+
+        inline ClassMasks ScalarClassMasks(const unsigned char* bytes, size_t count) {
+            ClassMasks masks = {};
+            for (size_t i = 0; i < count; ++i) {
+                masks.ascii |= (uint64_t)((unsigned char)(bytes[i] - 0x20) < 0x5F) << i;
+                masks.high |= (uint64_t)(bytes[i] >= 0xA0) << i;
+                masks.non_ascii |= (uint64_t)(bytes[i] >= 0x80) << i;
+                masks.zero |= (uint64_t)(bytes[i] == 0) << i;
+                masks.wide |= (uint64_t)(bytes[i] != 0 && (bytes[i] & 0xF8) != 0xD8) << i;
+                masks.fd |= (uint64_t)(bytes[i] == 0xFD) << i;
+                masks.fdd0 |= (uint64_t)(bytes[i] >= 0xD0 && bytes[i] <= 0xEF) << i;
+                masks.ff |= (uint64_t)(bytes[i] == 0xFF) << i;
+                masks.fe_ff |= (uint64_t)(bytes[i] >= 0xFE) << i;
+            }
+            return masks;
+        }
+
+        // Gathers the even bits of `value` into the low 32 bits; UTF-16 unit masks come from byte masks
+        // this way.
+        inline uint64_t EvenBits(uint64_t value) {
+            value &= 0x5555555555555555ULL;
+            value = (value | (value >> 1)) & 0x3333333333333333ULL;
+            value = (value | (value >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+            value = (value | (value >> 4)) & 0x00FF00FF00FF00FFULL;
+            value = (value | (value >> 8)) & 0x0000FFFF0000FFFFULL;
+            value = (value | (value >> 16)) & 0x00000000FFFFFFFFULL;
+            return value;
+        }
+
+#ifdef SONAR_STRING_SCAN_SSE2
+        // Signed compares: bytes >= 0x80 are negative and fail the lower bound with the controls.
+        inline void BuildMasksSse2(const unsigned char* bytes, size_t blocks, uint64_t* masks) {
+            const __m128i low = _mm_set1_epi8(0x1F);
+            const __m128i high = _mm_set1_epi8(0x7F);
+            for (size_t b = 0; b < blocks; ++b) {
+                uint64_t mask = 0;
+                for (int lane = 0; lane < 4; ++lane) {
+                    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + b * kBlock + lane * 16));
+                    const __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(v, low), _mm_cmplt_epi8(v, high));
+                    mask |= (uint64_t)(uint32_t)_mm_movemask_epi8(printable) << (lane * 16);
+                }
+                masks[b] = mask;
+            }
+        }
+
+        SONAR_TARGET_AVX2 inline void BuildMasksAvx2(const unsigned char* bytes, size_t blocks, uint64_t* masks) {
+            const __m256i low = _mm256_set1_epi8(0x1F);
+            const __m256i high = _mm256_set1_epi8(0x7F);
+            for (size_t b = 0; b < blocks; ++b) {
+                const __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + b * kBlock));
+                const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + b * kBlock + 32));
+                const __m256i p0 = _mm256_and_si256(_mm256_cmpgt_epi8(v0, low), _mm256_cmpgt_epi8(high, v0));
+                const __m256i p1 = _mm256_and_si256(_mm256_cmpgt_epi8(v1, low), _mm256_cmpgt_epi8(high, v1));
+                masks[b] = (uint64_t)(uint32_t)_mm256_movemask_epi8(p0) | ((uint64_t)(uint32_t)_mm256_movemask_epi8(p1) << 32);
+            }
+        }
+
+
+        // Upper Latin-1 bytes are -96..-1 as signed bytes; the sign bit alone is non-ASCII. The
+        // UTF-16 high-byte masks are only built when `wide` is set.
+        inline void BuildClassMasksSse2(const unsigned char* bytes, size_t blocks, bool wide, ClassMasks* masks) {
+            const __m128i low = _mm_set1_epi8(0x1F);
+            const __m128i high = _mm_set1_epi8(0x7F);
+            const __m128i latin1 = _mm_set1_epi8((char)0x9F);
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i surrogate_bits = _mm_set1_epi8((char)0xF8);
+            const __m128i surrogate = _mm_set1_epi8((char)0xD8);
+            const __m128i fd = _mm_set1_epi8((char)0xFD);
+            const __m128i ff = _mm_set1_epi8((char)0xFF);
+            const __m128i below_d0 = _mm_set1_epi8((char)0xCF);
+            const __m128i above_ef = _mm_set1_epi8((char)0xF0);
+            const __m128i below_fe = _mm_set1_epi8((char)0xFD);
+            for (size_t b = 0; b < blocks; ++b) {
+                ClassMasks m = {};
+                for (int lane = 0; lane < 4; ++lane) {
+                    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + b * kBlock + lane * 16));
+                    const int shift = lane * 16;
+                    const __m128i is_zero = _mm_cmpeq_epi8(v, zero);
+                    m.ascii |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi8(v, low), _mm_cmplt_epi8(v, high))) << shift;
+                    m.high |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi8(v, latin1), _mm_cmplt_epi8(v, zero))) << shift;
+                    m.non_ascii |= (uint64_t)(uint32_t)_mm_movemask_epi8(v) << shift;
+                    m.zero |= (uint64_t)(uint32_t)_mm_movemask_epi8(is_zero) << shift;
+                    if (!wide) continue;
+                    const __m128i not_wide = _mm_or_si128(is_zero, _mm_cmpeq_epi8(_mm_and_si128(v, surrogate_bits), surrogate));
+                    m.wide |= (uint64_t)(~(uint32_t)_mm_movemask_epi8(not_wide) & 0xFFFF) << shift;
+                    m.fd |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, fd)) << shift;
+                    m.fdd0 |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi8(v, below_d0), _mm_cmplt_epi8(v, above_ef))) << shift;
+                    m.ff |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, ff)) << shift;
+                    m.fe_ff |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi8(v, below_fe), _mm_cmplt_epi8(v, zero))) << shift;
+                }
+                masks[b] = m;
+            }
+        }
+
+        SONAR_TARGET_AVX2 inline void BuildClassMasksAvx2(const unsigned char* bytes, size_t blocks, bool wide, ClassMasks* masks) {
+            const __m256i low = _mm256_set1_epi8(0x1F);
+            const __m256i high = _mm256_set1_epi8(0x7F);
+            const __m256i latin1 = _mm256_set1_epi8((char)0x9F);
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i surrogate_bits = _mm256_set1_epi8((char)0xF8);
+            const __m256i surrogate = _mm256_set1_epi8((char)0xD8);
+            const __m256i fd = _mm256_set1_epi8((char)0xFD);
+            const __m256i ff = _mm256_set1_epi8((char)0xFF);
+            const __m256i below_d0 = _mm256_set1_epi8((char)0xCF);
+            const __m256i above_ef = _mm256_set1_epi8((char)0xF0);
+            const __m256i below_fe = _mm256_set1_epi8((char)0xFD);
+            for (size_t b = 0; b < blocks; ++b) {
+                ClassMasks m = {};
+                for (int lane = 0; lane < 2; ++lane) {
+                    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + b * kBlock + lane * 32));
+                    const int shift = lane * 32;
+                    const __m256i is_zero = _mm256_cmpeq_epi8(v, zero);
+                    m.ascii |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpgt_epi8(v, low), _mm256_cmpgt_epi8(high, v))) << shift;
+                    m.high |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpgt_epi8(v, latin1), _mm256_cmpgt_epi8(zero, v))) << shift;
+                    m.non_ascii |= (uint64_t)(uint32_t)_mm256_movemask_epi8(v) << shift;
+                    m.zero |= (uint64_t)(uint32_t)_mm256_movemask_epi8(is_zero) << shift;
+                    if (!wide) continue;
+                    const __m256i not_wide = _mm256_or_si256(is_zero, _mm256_cmpeq_epi8(_mm256_and_si256(v, surrogate_bits), surrogate));
+                    m.wide |= (uint64_t)~(uint32_t)_mm256_movemask_epi8(not_wide) << shift;
+                    m.fd |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, fd)) << shift;
+                    m.fdd0 |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpgt_epi8(v, below_d0), _mm256_cmpgt_epi8(above_ef, v))) << shift;
+                    m.ff |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, ff)) << shift;
+                    m.fe_ff |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpgt_epi8(v, below_fe), _mm256_cmpgt_epi8(zero, v))) << shift;
+                }
+                masks[b] = m;
+            }
+        }
+
+        inline bool HasAvx2() {
+            static const bool supported = [] {
+#if defined(_MSC_VER)
+                int info[4];
+                __cpuid(info, 0);
+                if (info[0] < 7) return false;
+                __cpuid(info, 1);
+                // OSXSAVE and AVX, then the OS must save YMM state.
+                if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) return false;
+                if ((_xgetbv(0) & 6) != 6) return false;
+                __cpuidex(info, 7, 0);
+                return (info[1] & (1 << 5)) != 0;
+#else
+                return __builtin_cpu_supports("avx2") != 0;
+#endif
+            }();
+            return supported;
+        }
+#endif
+
+        constexpr size_t kNoRun = SIZE_MAX;
+
+        // Walks one block's mask, where bit i covers element base + i. Each iteration finds a run
+        // start (first set bit) or a run end (first clear bit after it); `run_start` carries an open
+        // run into the next block.
+        template <typename Emit>
+        inline void WalkMask(uint64_t printable, size_t base, size_t count, size_t min_length, size_t& run_start, Emit& emit) {
+            uint64_t gaps = ~printable & LowBits((unsigned)count);
+            for (;;) {
+                if (run_start == kNoRun) {
+                    if (printable == 0) return;
+                    const unsigned start = CountTrailingZeros(printable);
+                    run_start = base + start;
+                    gaps &= ~LowBits(start);
+                }
+                if (gaps == 0) return;
+                const unsigned end = CountTrailingZeros(gaps);
+                if (base + end - run_start >= min_length) emit(run_start, base + end - run_start);
+                run_start = kNoRun;
+                printable &= ~LowBits(end);
+            }
+        }
+
+        inline void BuildMasks(const unsigned char* bytes, size_t blocks, uint64_t* masks) {
+#ifdef SONAR_STRING_SCAN_SSE2
+            if (HasAvx2()) BuildMasksAvx2(bytes, blocks, masks);
+            else BuildMasksSse2(bytes, blocks, masks);
+#else
+            for (size_t b = 0; b < blocks; ++b) masks[b] = ScalarMask(bytes + b * kBlock, kBlock);
+#endif
+        }
+
+        struct RunState {
+            size_t start = kNoRun;
+            bool marked = false;
+        };
+
+        // WalkMask for runs that only count when they contain a bit of `marker` (UTF-8 and Latin-1
+        // runs need a non-ASCII byte; pure ASCII is reported as ASCII).
+        template <typename Emit>
+        inline void WalkMarkedMask(uint64_t printable, uint64_t marker, size_t base, size_t count, size_t min_length, RunState& run, Emit& emit) {
+            uint64_t gaps = ~printable & LowBits((unsigned)count);
+            unsigned segment = 0;   // Where the open run's part in this block starts.
+            for (;;) {
+                if (run.start == kNoRun) {
+                    if (printable == 0) return;
+                    segment = CountTrailingZeros(printable);
+                    run.start = base + segment;
+                    run.marked = false;
+                    gaps &= ~LowBits(segment);
+                }
+                if (gaps == 0) {
+                    run.marked |= (marker & LowBits((unsigned)count) & ~LowBits(segment)) != 0;
+                    return;
+                }
+                const unsigned end = CountTrailingZeros(gaps);
+                run.marked |= (marker & LowBits(end) & ~LowBits(segment)) != 0;
+                if (run.marked && base + end - run.start >= min_length) emit(run.start, base + end - run.start);
+                run.start = kNoRun;
+                printable &= ~LowBits(end);
+            }
+        }
+
+        inline void BuildClassMasks(const unsigned char* bytes, size_t blocks, bool wide, ClassMasks* masks) {
+#ifdef SONAR_STRING_SCAN_SSE2
+            if (HasAvx2()) BuildClassMasksAvx2(bytes, blocks, wide, masks);
+            else BuildClassMasksSse2(bytes, blocks, wide, masks);
+#else
+            for (size_t b = 0; b < blocks; ++b) masks[b] = ScalarClassMasks(bytes + b * kBlock, kBlock);
+#endif
+        }
+
+        inline size_t EncodeUtf8(uint32_t code, char* out) {
+            if (code < 0x80) {
+                out[0] = (char)code;
+                return 1;
+            }
+            if (code < 0x800) {
+                out[0] = (char)(0xC0 | (code >> 6));
+                out[1] = (char)(0x80 | (code & 0x3F));
+                return 2;
+            }
+            if (code < 0x10000) {
+                out[0] = (char)(0xE0 | (code >> 12));
+                out[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+                out[2] = (char)(0x80 | (code & 0x3F));
+                return 3;
+            }
+            out[0] = (char)(0xF0 | (code >> 18));
+            out[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+            out[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+            out[3] = (char)(0x80 | (code & 0x3F));
+            return 4;
+        }
+
+        // Decodes the multi-byte UTF-8 sequence at `bytes` (lead byte >= 0x80), with `available` bytes
+        // left. Returns its length, or 0 for an invalid, overlong or surrogate sequence.
+        inline size_t DecodeUtf8(const unsigned char* bytes, size_t available, uint32_t& code) {
+            const unsigned char lead = bytes[0];
+            size_t length;
+            uint32_t min_code;
+            if (lead >= 0xC2 && lead <= 0xDF) { length = 2; code = lead & 0x1F; min_code = 0x80; }
+            else if (lead >= 0xE0 && lead <= 0xEF) { length = 3; code = lead & 0x0F; min_code = 0x800; }
+            else if (lead >= 0xF0 && lead <= 0xF4) { length = 4; code = lead & 0x07; min_code = 0x10000; }
+            else return 0;
+            if (available < length) return 0;
+            for (size_t i = 1; i < length; ++i) {
+                if ((bytes[i] & 0xC0) != 0x80) return 0;
+                code = (code << 6) | (bytes[i] & 0x3F);
+            }
+            if (code < min_code || code > 0x10FFFF || (code >= 0xD800 && code < 0xE000)) return 0;
+            return length;
+        }
+
+        // Non-ASCII code points worth keeping: no C1 controls and no noncharacters U+xxFFFE/U+xxFFFF.
+        inline bool IsPrintableCode(uint32_t code) { return code >= 0xA0 && (code & 0xFFFE) != 0xFFFE; }
+
+        // Splits a run of printable ASCII and bytes >= 0x80 at every invalid or unprintable sequence and
+        // calls emit(offset, length) for the pieces with a multi-byte character and at least
+        // `min_chars` code points.
+        template <typename Emit>
+        inline void SplitUtf8Run(const unsigned char* bytes, size_t offset, size_t length, size_t min_chars, Emit&& emit) {
+            const size_t end = offset + length;
+            size_t start = offset;
+            size_t chars = 0;
+            bool multibyte = false;
+            size_t i = offset;
+            while (i < end) {
+                if (bytes[i] < 0x80) { ++i; ++chars; continue; }
+                uint32_t code;
+                const size_t sequence = DecodeUtf8(bytes + i, end - i, code);
+                if (sequence > 0 && IsPrintableCode(code)) {
+                    i += sequence;
+                    ++chars;
+                    multibyte = true;
+                    continue;
+                }
+                if (multibyte && chars >= min_chars) emit(start, i - start);
+                start = ++i;
+                chars = 0;
+                multibyte = false;
+            }
+            if (multibyte && chars >= min_chars) emit(start, end - start);
+        }
+    }
+
+    // Calls emit(offset, length) for every maximal printable run of at least `min_length` bytes, in
+    // order. Runs are not carried past the end of the buffer.
+    template <typename Emit>
+    inline void ForEachPrintableRun(const char* data, size_t size, size_t min_length, Emit&& emit) {
+        using namespace Detail;
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        size_t run_start = kNoRun;
+        uint64_t masks[kBatchBlocks];
+        size_t offset = 0;
+        while (size - offset >= kBlock) {
+            const size_t blocks = std::min(kBatchBlocks, (size - offset) / kBlock);
+            BuildMasks(bytes + offset, blocks, masks);
+            for (size_t b = 0; b < blocks; ++b) WalkMask(masks[b], offset + b * kBlock, kBlock, min_length, run_start, emit);
+            offset += blocks * kBlock;
+        }
+        if (offset < size) WalkMask(ScalarMask(bytes + offset, size - offset), offset, size - offset, min_length, run_start, emit);
+        if (run_start != kNoRun && size - run_start >= min_length) emit(run_start, size - run_start);
+    }
+
+
+    // Transcodes `units` UTF-16 code units at `data` (any alignment) to UTF-8 in `arena`. Unpaired
+    // surrogates become U+FFFD.
+    inline std::string_view TranscodeUtf16(const char* data, size_t units, StringArena& arena, bool big_endian = false) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        auto load = [&](size_t i) { return big_endian ? (uint32_t)((bytes[i * 2] << 8) | bytes[i * 2 + 1]) : (uint32_t)Detail::LoadUnit(bytes + i * 2); };
+        char* out = arena.Reserve(units * 3);
+        size_t length = 0;
+        for (size_t i = 0; i < units; ++i) {
+            uint32_t code = load(i);
+            if (code >= 0xD800 && code < 0xE000) {
+                const uint32_t next = i + 1 < units ? load(i + 1) : 0;
+                if (code < 0xDC00 && next >= 0xDC00 && next < 0xE000) {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (next - 0xDC00);
+                    ++i;
+                }
+                else {
+                    code = 0xFFFD;
+                }
+            }
+            length += Detail::EncodeUtf8(code, out + length);
+        }
+        return arena.Commit(length);
+    }
+
+    // Transcodes `length` Latin-1 bytes at `data` to UTF-8 in `arena`.
+    inline std::string_view TranscodeLatin1(const char* data, size_t length, StringArena& arena) {
+        char* out = arena.Reserve(length * 2);
+        size_t written = 0;
+        for (size_t i = 0; i < length; ++i) written += Detail::EncodeUtf8((unsigned char)data[i], out + written);
+        return arena.Commit(written);
+    }
+
+    // Extracts the strings of every encoding in `settings.encodings` from one buffer in a single pass.
+    // Each 64-byte block is classified once into byte-class masks and each encoding walks a mask
+    // derived from them:
+    //   ASCII       printable ASCII.
+    //   UTF-8       printable ASCII and valid multi-byte characters (U+00A0 and up), for runs that
+    //               hold at least one multi-byte character; pure ASCII runs are left to ASCII.
+    //   Latin-1     printable Latin-1 bytes, for runs that hold at least one byte >= 0xA0.
+    //   UTF-16LE/BE printable BMP units at even offsets, printable Latin-1 units at odd offsets.
+    // Calls emit(text, encoding, offset) with the string as UTF-8 and its byte offset in `data`. ASCII
+    // and UTF-8 text points into `data`; transcoded text stays in `arena` until the caller clears it.
+    // Minimum lengths count characters (bytes, code points or units).
+    template <typename Emit>
+    inline void ExtractStrings(const char* data, size_t size, const ExtractSettings& settings, StringArena& arena, Emit&& emit) {
+        using namespace Detail;
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        const unsigned encodings = settings.encodings;
+        auto min_length = [&](Encoding encoding) { return std::max<size_t>(settings.min_length[EncodingIndex(encoding)], 1); };
+        const size_t min_ascii = min_length(ENCODING_ASCII);
+        const size_t min_latin1 = min_length(ENCODING_LATIN1);
+        const size_t min_utf8 = min_length(ENCODING_UTF8);
+        const size_t min_utf16le = min_length(ENCODING_UTF16LE);
+        const size_t min_utf16be = min_length(ENCODING_UTF16BE);
+
+        auto emit_ascii = [&](size_t offset, size_t length) { emit(std::string_view(data + offset, length), ENCODING_ASCII, offset); };
+        auto emit_latin1 = [&](size_t offset, size_t length) { emit(TranscodeLatin1(data + offset, length, arena), ENCODING_LATIN1, offset); };
+        auto emit_utf8_piece = [&](size_t offset, size_t length) { emit(std::string_view(data + offset, length), ENCODING_UTF8, offset); };
+        auto emit_utf8 = [&](size_t offset, size_t length) { SplitUtf8Run(bytes, offset, length, min_utf8, emit_utf8_piece); };
+        // Unit streams: index is alignment for UTF-16LE and 2 + alignment for UTF-16BE.
+        auto emit_units = [&](unsigned stream, size_t unit, size_t units) {
+            const size_t offset = (stream & 1) + unit * 2;
+            const bool big_endian = stream >= 2;
+            emit(TranscodeUtf16(data + offset, units, arena, big_endian), big_endian ? ENCODING_UTF16BE : ENCODING_UTF16LE, offset);
+        };
+        auto emit_le0 = [&](size_t unit, size_t units) { emit_units(0, unit, units); };
+        auto emit_le1 = [&](size_t unit, size_t units) { emit_units(1, unit, units); };
+        auto emit_be0 = [&](size_t unit, size_t units) { emit_units(2, unit, units); };
+        auto emit_be1 = [&](size_t unit, size_t units) { emit_units(3, unit, units); };
+
+        RunState ascii_run, latin1_run, utf8_run, unit_runs[4];
+        // `next` classifies the byte after the block in its bit 0, if `has_next`; it completes a unit
+        // starting at the block's last byte.
+        auto walk_block = [&](const ClassMasks& m, size_t base, size_t count, const ClassMasks& next, bool has_next) {
+            const uint64_t latin1 = m.ascii | m.high;
+            // Bit i of the result: bit i + 1 of `mask`, so a unit's second byte lines up with its first.
+            auto second = [](uint64_t mask, uint64_t next_mask) { return (mask >> 1) | (next_mask << 63); };
+            if (encodings & ENCODING_ASCII) WalkMarkedMask(m.ascii, ~0ULL, base, kBlock, min_ascii, ascii_run, emit_ascii);
+            if (encodings & ENCODING_LATIN1) WalkMarkedMask(latin1, m.high, base, kBlock, min_latin1, latin1_run, emit_latin1);
+            if (encodings & ENCODING_UTF8) WalkMarkedMask(m.ascii | m.non_ascii, m.non_ascii, base, kBlock, 1, utf8_run, emit_utf8);
+            // Bit i: a printable unit starts at byte base + i. Even bits are alignment 0, odd bits 1.
+            if (encodings & ENCODING_UTF16LE) {
+                const uint64_t latin1_units = latin1 & second(m.zero, next.zero);
+                const uint64_t bmp_units = latin1_units | (second(m.wide, next.wide) & ~(second(m.fd, next.fd) & m.fdd0) & ~(second(m.ff, next.ff) & m.fe_ff));
+                WalkMarkedMask(EvenBits(bmp_units), ~0ULL, base / 2, kBlock / 2, min_utf16le, unit_runs[0], emit_le0);
+                WalkMarkedMask(EvenBits(latin1_units >> 1), ~0ULL, base / 2, kBlock / 2, min_utf16le, unit_runs[1], emit_le1);
+            }
+            if (encodings & ENCODING_UTF16BE) {
+                const uint64_t latin1_units = m.zero & second(latin1, next.ascii | next.high);
+                // The high byte comes first, so the unit also needs a second byte to exist.
+                const uint64_t complete = second(LowBits((unsigned)count), has_next ? 1 : 0);
+                const uint64_t bmp_units = latin1_units | (m.wide & complete & ~(m.fd & second(m.fdd0, next.fdd0)) & ~(m.ff & second(m.fe_ff, next.fe_ff)));
+                WalkMarkedMask(EvenBits(bmp_units), ~0ULL, base / 2, kBlock / 2, min_utf16be, unit_runs[2], emit_be0);
+                WalkMarkedMask(EvenBits(latin1_units >> 1), ~0ULL, base / 2, kBlock / 2, min_utf16be, unit_runs[3], emit_be1);
+            }
+        };
+
+        const bool wide = (encodings & (ENCODING_UTF16LE | ENCODING_UTF16BE)) != 0;
+        ClassMasks masks[kBatchBlocks];
+        size_t offset = 0;
+        while (size - offset >= kBlock) {
+            const size_t blocks = std::min(kBatchBlocks, (size - offset) / kBlock);
+            BuildClassMasks(bytes + offset, blocks, wide, masks);
+            for (size_t b = 0; b < blocks; ++b) {
+                const size_t base = offset + b * kBlock;
+                const bool has_next = base + kBlock < size;
+                walk_block(masks[b], base, kBlock, ScalarClassMasks(bytes + base + kBlock, has_next ? 1 : 0), has_next);
+            }
+            offset += blocks * kBlock;
+        }
+        // The tail, possibly empty, as a final block: nothing past the end is printable or zero, so
+        // every open run closes at `size`.
+        ClassMasks tail = ScalarClassMasks(bytes + offset, size - offset);
+        walk_block(tail, offset, size - offset, ClassMasks{}, false);
+    }
+
+    // Appends the printable runs of at least `min_length` bytes to `spans`.
+    inline void FindPrintableRuns(const char* data, size_t size, size_t min_length, std::vector<Span>& spans) {
+        ForEachPrintableRun(data, size, min_length, [&](size_t offset, size_t length) { spans.push_back({ offset, length }); });
+    }
+
+} // namespace StringScan
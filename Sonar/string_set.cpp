@@ -0,0 +1,110 @@
+#include "string_set.h"
+#include "hash128.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace {
+    constexpr size_t kInitialSlots = 16;
+}
+
+StringInternSet::StringInternSet(size_t payload_bytes) : shards((size_t)1 << kShardBits), payload_size(payload_bytes) {}
+
+uint64_t StringInternSet::Hash(std::string_view text) { return Hash128::Compute(text.data(), text.size()).lo; }
+
+StringInternSet::Entry& StringInternSet::Probe(Shard& shard, std::string_view text, uint64_t hash) {
+    const size_t mask = shard.slots.size() - 1;
+    for (size_t i = (size_t)hash & mask;; i = (i + 1) & mask) {
+        Entry& entry = shard.slots[i];
+        if (!entry.data) return entry;
+        if (entry.hash == hash && entry.length == text.size() && std::memcmp(entry.data, text.data(), text.size()) == 0) return entry;
+    }
+}
+
+void StringInternSet::Grow(Shard& shard, size_t min_slots) {
+    size_t size = std::max(kInitialSlots, shard.slots.size());
+    while (size < min_slots) size <<= 1;
+    if (size == shard.slots.size()) return;
+    std::vector<Entry> old_slots(size);
+    old_slots.swap(shard.slots);
+    const size_t mask = size - 1;
+    for (const auto& entry : old_slots) {
+        if (!entry.data) continue;
+        size_t i = (size_t)entry.hash & mask;
+        while (shard.slots[i].data) i = (i + 1) & mask;
+        shard.slots[i] = entry;
+    }
+}
+
+bool StringInternSet::Insert(std::string_view text) { return InsertWithPayload(text).second; }
+
+std::pair<char*, bool> StringInternSet::InsertWithPayload(std::string_view text) {
+    const uint64_t hash = Hash(text);
+    Shard& shard = shards[ShardIndex(hash)];
+    // Keep the load factor at or below 3/4.
+    if ((shard.count + 1) * 4 > shard.slots.size() * 3) Grow(shard, shard.slots.size() * 2);
+    Entry& entry = Probe(shard, text, hash);
+    if (entry.data) return { entry.data - payload_size, false };
+    char* stored = arena.Reserve(payload_size + text.size());
+    std::memset(stored, 0, payload_size);
+    if (!text.empty()) std::memcpy(stored + payload_size, text.data(), text.size());
+    arena.Commit(payload_size + text.size());
+    entry.data = stored + payload_size;
+    entry.hash = hash;
+    entry.length = (uint32_t)text.size();
+    ++shard.count;
+    return { stored, true };
+}
+
+size_t StringInternSet::Size() const {
+    size_t size = 0;
+    for (const auto& shard : shards) size += shard.count;
+    return size;
+}
+
+size_t StringInternSet::MemoryUsage() const {
+    size_t bytes = arena.BytesReserved();
+    for (const auto& merged : merged_arenas) bytes += merged.BytesReserved();
+    for (const auto& shard : shards) bytes += shard.slots.size() * sizeof(Entry);
+    return bytes;
+}
+
+StringInternSet StringInternSet::Merge(std::vector<StringInternSet>& sets, int thread_count, const std::function<void(char*, const char*)>& merge_payload) {
+    StringInternSet result(sets.empty() ? 0 : sets[0].payload_size);
+    std::atomic<size_t> next_shard = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < std::max(1, thread_count); ++t) {
+        threads.emplace_back([&]() {
+            for (size_t s = next_shard++; s < result.shards.size(); s = next_shard++) {
+                Shard& target = result.shards[s];
+                size_t upper_bound = 0;
+                for (const auto& set : sets) upper_bound += set.shards[s].count;
+                // Sized up front for the worst case (no duplicates), so the shard never rehashes.
+                Grow(target, (upper_bound * 4 + 2) / 3 + 1);
+                for (auto& set : sets) {
+                    Shard& source = set.shards[s];
+                    for (const auto& entry : source.slots) {
+                        if (!entry.data) continue;
+                        Entry& slot = Probe(target, std::string_view(entry.data, entry.length), entry.hash);
+                        if (slot.data) {
+                            if (merge_payload) merge_payload(slot.data - result.payload_size, entry.data - result.payload_size);
+                            continue;
+                        }
+                        slot = entry;
+                        ++target.count;
+                    }
+                    // The input shard is no longer needed; free it before the next one is built.
+                    source = Shard();
+                }
+            }
+            });
+    }
+    for (auto& th : threads) th.join();
+    for (auto& set : sets) {
+        result.merged_arenas.push_back(std::move(set.arena));
+        for (auto& merged : set.merged_arenas) result.merged_arenas.push_back(std::move(merged));
+        set.merged_arenas.clear();
+    }
+    return result;
+}
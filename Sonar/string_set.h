@@ -0,0 +1,82 @@
+#pragma once
+
+#include "string_arena.h"
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Deduplicating string set for text dumps. Strings are packed into an arena and the index is an
+// open-addressing table of (hash, length, pointer) entries, 24 bytes per string with no per-string
+// allocation. The table is split into shards on the top hash bits so that per-thread sets can be
+// merged shard by shard in parallel, and each input shard is freed as soon as it is merged.
+//
+// A set can keep a fixed-size payload with every string (stored just before it in the arena), for
+// callers that track per-string data such as provenance.
+class StringInternSet {
+public:
+    explicit StringInternSet(size_t payload_bytes = 0);
+    StringInternSet(StringInternSet&&) = default;
+    StringInternSet& operator=(StringInternSet&&) = default;
+
+    // Adds `text`, copying it into the arena if it is new. Returns true if it was new.
+    bool Insert(std::string_view text);
+    // Same, and returns the string's payload (zeroed when the string is new).
+    std::pair<char*, bool> InsertWithPayload(std::string_view text);
+    size_t Size() const;
+    // Bytes held by the index and the string storage.
+    size_t MemoryUsage() const;
+
+    // Visits every string once, in hash order.
+    template <typename Visit>
+    void ForEach(Visit&& visit) const {
+        for (const auto& shard : shards) {
+            for (const auto& entry : shard.slots) {
+                if (entry.data) visit(std::string_view(entry.data, entry.length));
+            }
+        }
+    }
+
+    // Visits every string with its payload.
+    template <typename Visit>
+    void ForEachWithPayload(Visit&& visit) const {
+        for (const auto& shard : shards) {
+            for (const auto& entry : shard.slots) {
+                if (entry.data) visit(std::string_view(entry.data, entry.length), (const char*)entry.data - payload_size);
+            }
+        }
+    }
+
+    static uint64_t Hash(std::string_view text);
+
+    // Unions `sets` into one set using `thread_count` threads, one shard at a time per thread. The
+    // inputs are consumed: their strings move into the result without being copied. For a string
+    // found in several sets, `merge_payload(kept, duplicate)` folds the duplicate's payload into the
+    // kept one; calls for one string never run concurrently.
+    static StringInternSet Merge(std::vector<StringInternSet>& sets, int thread_count, const std::function<void(char*, const char*)>& merge_payload = {});
+
+private:
+    static constexpr unsigned kShardBits = 6;
+
+    struct Entry {
+        char* data = nullptr;           // Null marks an empty slot.
+        uint64_t hash = 0;
+        uint32_t length = 0;
+    };
+    struct Shard {
+        std::vector<Entry> slots;       // Power-of-two size, linear probing.
+        size_t count = 0;
+    };
+
+    static size_t ShardIndex(uint64_t hash) { return (size_t)(hash >> (64 - kShardBits)); }
+    // Finds `text` in the shard or the empty slot where it belongs.
+    static Entry& Probe(Shard& shard, std::string_view text, uint64_t hash);
+    static void Grow(Shard& shard, size_t min_slots);
+
+    std::vector<Shard> shards;
+    size_t payload_size;
+    StringArena arena;
+    // Arenas taken over from merged sets; the entries point into them.
+    std::vector<StringArena> merged_arenas;
+};
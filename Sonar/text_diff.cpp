@@ -0,0 +1,221 @@
+#include "text_diff.h"
+#include "frame_file.h"
+#include "front_coded.h"
+#include "string_runs.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+namespace {
+    constexpr uint64_t kPieceSize = 64 * 1024 * 1024;
+    constexpr size_t kReadSize = 1024 * 1024;
+    constexpr uint64_t kMinWorkerBudget = 16 * 1024 * 1024;
+    // Per line, on top of its characters: its arena span and the string_view handed to AddRun().
+    constexpr uint64_t kLineOverhead = sizeof(std::pair<size_t, size_t>) + sizeof(std::string_view);
+    constexpr uint64_t kProgressInterval = 65536;
+    // Share of the progress bar for sorting the inputs; the merge-join takes the rest.
+    constexpr float kSortShare = 0.6f;
+
+    // One input as a sorted, duplicate-free stream: a front-coded dump read directly, or the runs
+    // sorted from a plain one.
+    struct SortedSide {
+        bool front_coded = false;
+        FrontCoded::Reader front_coded_reader;
+        std::unique_ptr<FrontCoded::Reader::Cursor> front_coded_cursor;
+        std::unique_ptr<SortedStringRuns> runs;
+        // Declared after `runs` so its files are closed before the runs are removed.
+        std::unique_ptr<SortedStringRuns::Cursor> runs_cursor;
+
+        uint64_t Count() const { return front_coded ? front_coded_reader.StringCount() : runs->StringCount(); }
+        bool Next() { return front_coded ? front_coded_cursor->Next() : runs_cursor->Next(); }
+        std::string_view Current() const { return front_coded ? front_coded_cursor->Current() : std::string_view(runs_cursor->Current()); }
+    };
+
+    // Collects lines into an arena and writes them out as a sorted run whenever the budget is used.
+    class LineBatch {
+    public:
+        LineBatch(SortedStringRuns& output, uint64_t memory_budget) : runs(output), budget(memory_budget) { arena.reserve((size_t)memory_budget); }
+
+        void Append(const char* data, size_t size) { arena.insert(arena.end(), data, data + size); }
+        void BeginLine() { line_begin = arena.size(); }
+        // Ends the line appended since BeginLine(); empty lines (after trimming '\r') are dropped.
+        bool EndLine(std::string& error) {
+            if (arena.size() > line_begin && arena.back() == '\r') arena.pop_back();
+            if (arena.size() == line_begin) return true;
+            spans.emplace_back(line_begin, arena.size() - line_begin);
+            if (arena.size() + spans.size() * kLineOverhead < budget) return true;
+            return Flush(error);
+        }
+        bool Flush(std::string& error) {
+            if (spans.empty()) return true;
+            std::vector<std::string_view> strings;
+            strings.reserve(spans.size());
+            for (const auto& span : spans) strings.emplace_back(arena.data() + span.first, span.second);
+            if (!runs.AddRun(strings, error)) return false;
+            arena.clear();
+            spans.clear();
+            return true;
+        }
+
+    private:
+        SortedStringRuns& runs;
+        uint64_t budget;
+        std::vector<char> arena;
+        std::vector<std::pair<size_t, size_t>> spans;
+        size_t line_begin = 0;
+    };
+
+    // Adds the lines starting in [begin, end) of `source` to `batch`. The line running into the
+    // piece from before `begin` belongs to the previous piece; the last line is read past `end`.
+    bool ReadPiece(const DumpFileSource& source, uint64_t begin, uint64_t end, std::vector<char>& buffer, LineBatch& batch, std::atomic<uint64_t>& bytes_done, std::string& error) {
+        const uint64_t size = source.Size();
+        uint64_t offset = begin == 0 ? 0 : begin - 1;
+        bool skipping = begin > 0;      // Until the newline ending the previous piece's last line.
+        bool in_line = false;
+        while (offset < size) {
+            const size_t got = source.ReadAt(offset, buffer.data(), (size_t)std::min<uint64_t>(buffer.size(), size - offset));
+            if (got == 0) break;
+            size_t i = 0;
+            bool done = false;
+            while (i < got) {
+                const char* newline = static_cast<const char*>(std::memchr(buffer.data() + i, '\n', got - i));
+                const size_t take = newline ? (size_t)(newline - (buffer.data() + i)) : got - i;
+                if (skipping) {
+                    if (newline) skipping = false;
+                    i += take + 1;
+                    continue;
+                }
+                if (!in_line) {
+                    if (offset + i >= end) { done = true; break; }
+                    batch.BeginLine();
+                    in_line = true;
+                }
+                batch.Append(buffer.data() + i, take);
+                if (newline) {
+                    if (!batch.EndLine(error)) return false;
+                    in_line = false;
+                }
+                i += take + 1;
+            }
+            // Progress counts only the piece's own bytes, so the pieces add up to the file size.
+            const uint64_t counted_begin = std::max(offset, begin);
+            const uint64_t counted_end = std::min(offset + got, end);
+            if (counted_end > counted_begin) bytes_done += counted_end - counted_begin;
+            offset += got;
+            if (done || (!skipping && !in_line && offset >= end)) break;
+        }
+        if (in_line && !batch.EndLine(error)) return false;
+        return true;
+    }
+
+    // Sorts the lines of a plain or framed text dump into `runs` on `thread_count` workers.
+    bool SortLines(const std::string& path, SortedStringRuns& runs, uint64_t memory_budget, int thread_count, const std::function<void(uint64_t)>& advance, std::string& error) {
+        DumpFileSource source;
+        if (!source.Open(path, error)) return false;
+        const uint64_t size = source.Size();
+        const size_t piece_count = (size_t)((size + kPieceSize - 1) / kPieceSize);
+        thread_count = (int)std::max<size_t>(1, std::min<size_t>(thread_count, piece_count));
+        const uint64_t worker_budget = std::max(memory_budget / thread_count, kMinWorkerBudget);
+        std::atomic<size_t> next_piece = 0;
+        std::atomic<uint64_t> bytes_done = 0;
+        std::atomic<bool> failed = false;
+        std::mutex error_mutex;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&]() {
+                std::vector<char> buffer(kReadSize);
+                LineBatch batch(runs, worker_budget);
+                std::string worker_error;
+                bool ok = true;
+                for (size_t p = next_piece++; ok && p < piece_count && !failed; p = next_piece++) {
+                    ok = ReadPiece(source, p * kPieceSize, std::min(size, (p + 1) * kPieceSize), buffer, batch, bytes_done, worker_error);
+                    if (advance) advance(bytes_done);
+                }
+                if (ok) ok = batch.Flush(worker_error);
+                if (!ok) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!failed.exchange(true)) error = worker_error;
+                }
+                });
+        }
+        for (auto& th : threads) th.join();
+        return !failed;
+    }
+
+    bool OpenSide(const std::string& path, const std::string& temp_prefix, uint64_t memory_budget, int thread_count, const std::function<void(uint64_t)>& advance, SortedSide& side, std::string& error) {
+        side.front_coded = FrontCoded::IsFrontCoded(path);
+        if (side.front_coded) {
+            if (!side.front_coded_reader.Open(path, error)) return false;
+            side.front_coded_cursor = std::make_unique<FrontCoded::Reader::Cursor>(side.front_coded_reader);
+            return true;
+        }
+        side.runs = std::make_unique<SortedStringRuns>(temp_prefix, nullptr);
+        if (!SortLines(path, *side.runs, memory_budget, thread_count, advance, error)) return false;
+        side.runs_cursor = std::make_unique<SortedStringRuns::Cursor>(*side.runs);
+        return side.runs_cursor->Open(error);
+    }
+}
+
+namespace TextDiff {
+
+    bool Compare(const std::string& clean_path, const std::string& dirty_path, uint64_t memory_budget, int thread_count, const std::string& temp_prefix, const std::function<void(float)>& progress, Result& result, std::string& error) {
+        thread_count = std::max(1, thread_count);
+        // Sorting progress is by input bytes; front-coded inputs need no sorting.
+        uint64_t sort_bytes = 0;
+        for (const std::string* path : { &clean_path, &dirty_path }) {
+            if (FrontCoded::IsFrontCoded(*path)) continue;
+            DumpFileSource source;
+            std::string ignored;
+            if (source.Open(*path, ignored)) sort_bytes += source.Size();
+        }
+        const float sort_share = sort_bytes ? kSortShare : 0.0f;
+        uint64_t sorted_before = 0;
+        std::function<void(uint64_t)> advance = [&](uint64_t side_bytes) {
+            if (progress) progress(sort_share * (float)(sorted_before + side_bytes) / (float)sort_bytes);
+        };
+
+        // One side at a time, so each gets the whole budget and every core.
+        SortedSide clean;
+        SortedSide dirty;
+        if (!OpenSide(clean_path, temp_prefix + ".clean", memory_budget, thread_count, advance, clean, error)) { error = "Could not read clean dump: " + error; return false; }
+        if (!clean.front_coded) {
+            DumpFileSource source;
+            std::string ignored;
+            if (source.Open(clean_path, ignored)) sorted_before = source.Size();
+        }
+        if (!OpenSide(dirty_path, temp_prefix + ".dirty", memory_budget, thread_count, advance, dirty, error)) { error = "Could not read dirty dump: " + error; return false; }
+
+        // Merge-join: both sides are sorted and unique, so each string is seen once per side.
+        const uint64_t total = std::max<uint64_t>(1, clean.Count() + dirty.Count());
+        uint64_t done = 0;
+        uint64_t steps = 0;
+        bool has_clean = clean.Next();
+        bool has_dirty = dirty.Next();
+        while (has_clean || has_dirty) {
+            if (!has_dirty || (has_clean && clean.Current() < dirty.Current())) {
+                result.removed_strings.emplace_back(clean.Current());
+                has_clean = clean.Next();
+                ++done;
+            }
+            else if (!has_clean || dirty.Current() < clean.Current()) {
+                result.new_strings.emplace_back(dirty.Current());
+                has_dirty = dirty.Next();
+                ++done;
+            }
+            else {
+                ++result.common_count;
+                has_clean = clean.Next();
+                has_dirty = dirty.Next();
+                done += 2;
+            }
+            if (progress && ++steps % kProgressInterval == 0) progress(sort_share + (1.0f - sort_share) * std::min(1.0f, (float)done / (float)total));
+        }
+        if (progress) progress(1.0f);
+        return true;
+    }
+}
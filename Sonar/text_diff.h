@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Bounded-memory comparison of two text dumps. Each plain or framed input is cut into 64 MB
+// pieces at line starts; workers collect the lines of their pieces until their share of the
+// memory budget is used, then sort the batch and write it as a run (see string_runs.h). Front-coded
+// inputs are already sorted and unique and are read as they are. One streaming merge-join over both
+// sorted sides then yields the strings only in the dirty dump, only in the clean dump, and the
+// number in both. Memory is bounded by the budget plus the read buffers, whatever the dump sizes;
+// only the result lists are held in full.
+namespace TextDiff {
+
+    struct Result {
+        std::vector<std::string> new_strings;       // Only in the dirty dump, sorted.
+        std::vector<std::string> removed_strings;   // Only in the clean dump, sorted.
+        uint64_t common_count = 0;                  // Unique strings in both.
+    };
+
+    // Run files are created as `temp_prefix` + ".clean.run<N>" / ".dirty.run<N>" and removed before
+    // returning. `memory_budget` is shared by the `thread_count` workers sorting one side.
+    bool Compare(const std::string& clean_path, const std::string& dirty_path, uint64_t memory_budget, int thread_count, const std::string& temp_prefix, const std::function<void(float)>& progress, Result& result, std::string& error);
+}
@@ -0,0 +1,102 @@
+#include "throttle.h"
+#include <algorithm>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace {
+    // CPU time consumed by the calling thread, in microseconds.
+    uint64_t ThreadCpuMicroseconds() {
+#ifdef _WIN32
+        FILETIME creation, exit, kernel, user;
+        if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) return 0;
+        const uint64_t kernel_100ns = ((uint64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+        const uint64_t user_100ns = ((uint64_t)user.dwHighDateTime << 32) | user.dwLowDateTime;
+        return (kernel_100ns + user_100ns) / 10;
+#else
+        timespec ts;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+        return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+#endif
+    }
+
+    // Background mode lowers both CPU and I/O priority for the thread. There is no per-thread
+    // equivalent that can be undone without privileges elsewhere, so it is Windows-only.
+    void SetBackgroundMode(bool enable) {
+#ifdef _WIN32
+        SetThreadPriority(GetCurrentThread(), enable ? THREAD_MODE_BACKGROUND_BEGIN : THREAD_MODE_BACKGROUND_END);
+#else
+        (void)enable;
+#endif
+    }
+}
+
+void TokenBucket::Consume(uint64_t bytes) {
+    total += bytes;
+    const uint64_t limit = rate.load();
+    if (limit == 0) return;
+    double wait_seconds = 0.0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto now = std::chrono::steady_clock::now();
+        if (!started) {
+            tokens = (double)limit;
+            started = true;
+        }
+        else {
+            tokens += std::chrono::duration<double>(now - last_refill).count() * limit;
+        }
+        last_refill = now;
+        // At most one second of burst, and a lowered rate drains old credit immediately.
+        tokens = std::min(tokens, (double)limit) - (double)bytes;
+        if (tokens < 0.0) wait_seconds = -tokens / limit;
+    }
+    if (wait_seconds > 0.0) std::this_thread::sleep_for(std::chrono::duration<double>(wait_seconds));
+}
+
+WorkerThrottle::~WorkerThrottle() {
+    if (background) SetBackgroundMode(false);
+}
+
+void WorkerThrottle::Begin() {
+    if (!limits) return;
+    const bool want_background = limits->low_priority.load();
+    if (want_background != background) {
+        SetBackgroundMode(want_background);
+        background = want_background;
+    }
+    cpu_start_us = ThreadCpuMicroseconds();
+}
+
+void WorkerThrottle::End() {
+    if (!limits) return;
+    const int percent = std::clamp(limits->cpu_percent.load(), 1, 100);
+    if (percent >= 100) return;
+    // Idle for as long as it takes the CPU time just spent to be `percent` of the elapsed time.
+    const uint64_t used_us = ThreadCpuMicroseconds() - cpu_start_us;
+    const uint64_t idle_us = used_us * (100 - percent) / percent;
+    if (idle_us > 0) std::this_thread::sleep_for(std::chrono::microseconds(idle_us));
+}
+
+double RateMeter::Sample(uint64_t total) {
+    const auto now = std::chrono::steady_clock::now();
+    if (!started || total < last_total) {
+        started = true;
+        last_total = total;
+        last_time = now;
+        rate = 0.0;
+        return rate;
+    }
+    const double elapsed = std::chrono::duration<double>(now - last_time).count();
+    if (elapsed >= 0.5) {
+        rate = (total - last_total) / elapsed;
+        last_total = total;
+        last_time = now;
+    }
+    return rate;
+}
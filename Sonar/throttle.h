@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+// Limits a byte rate. Callers report bytes after the work that moved them and sleep off any debt,
+// so the limit holds on average with bursts of at most one second's worth. The rate can change at
+// any time; 0 means unlimited.
+class TokenBucket {
+public:
+    void SetRate(uint64_t bytes_per_second) { rate = bytes_per_second; }
+    uint64_t Rate() const { return rate.load(); }
+    // Accounts `bytes` and, if the bucket is in debt, sleeps until the debt is paid off.
+    void Consume(uint64_t bytes);
+    // Bytes consumed so far, for the achieved-rate readout.
+    uint64_t Total() const { return total.load(); }
+
+private:
+    std::mutex mutex;
+    double tokens = 0.0;
+    bool started = false;
+    std::chrono::steady_clock::time_point last_refill;
+    std::atomic<uint64_t> rate{ 0 };
+    std::atomic<uint64_t> total{ 0 };
+};
+
+// Resource limits for dumps and scans on busy hosts, shared between the running workers and the
+// UI. Every field may be changed while a job runs and takes effect at the next unit of work.
+struct ResourceLimits {
+    TokenBucket read;                       // Bytes read from target processes.
+    TokenBucket write;                      // Bytes written to disk.
+    std::atomic<int> cpu_percent{ 100 };    // Share of each worker thread's time spent on the CPU.
+    std::atomic<bool> low_priority{ false };// Run workers in background mode (lower CPU and I/O priority).
+};
+
+// Applies ResourceLimits to one worker thread. Call Begin() before and End() after each unit of
+// work; End() sleeps long enough to keep the thread's CPU time within cpu_percent. A null
+// `worker_limits` makes both calls no-ops. The thread's priority is restored on destruction.
+class WorkerThrottle {
+public:
+    explicit WorkerThrottle(ResourceLimits* worker_limits) : limits(worker_limits) {}
+    ~WorkerThrottle();
+    WorkerThrottle(const WorkerThrottle&) = delete;
+    WorkerThrottle& operator=(const WorkerThrottle&) = delete;
+
+    void Begin();
+    void End();
+
+private:
+    ResourceLimits* limits;
+    bool background = false;
+    uint64_t cpu_start_us = 0;
+};
+
+// Turns a running byte total into a rate for display, averaged over about half a second.
+class RateMeter {
+public:
+    double Sample(uint64_t total);
+
+private:
+    bool started = false;
+    uint64_t last_total = 0;
+    std::chrono::steady_clock::time_point last_time;
+    double rate = 0.0;
+};
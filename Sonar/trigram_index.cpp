@@ -0,0 +1,525 @@
+#include "trigram_index.h"
+#include "dump_format.h"
+#include "dump_reader.h"
+#include "dump_writer.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <regex>
+#include <set>
+#include <thread>
+
+namespace {
+    const char kMagic[8] = { 'S', 'O', 'N', 'A', 'R', 'T', 'R', 'I' };
+    constexpr uint32_t kVersion = 1;
+    constexpr uint64_t kPageSize = DumpFormat::kPageSize;
+    // Pages per build slice; a worker holds one slice's trigram keys at a time.
+    constexpr uint64_t kSlicePages = 4096;
+    // Trigram ranges merged in parallel once every slice is indexed.
+    constexpr uint32_t kMergeRanges = 64;
+    constexpr uint32_t kTrigramSpace = 1u << 24;
+    constexpr size_t kPreviewLength = 64;
+
+    struct IndexHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t page_size;
+        uint64_t page_count;
+        uint64_t dump_size;             // Identity of the indexed dump: image size, dump id, file time.
+        uint64_t dump_id[2];
+        int64_t dump_time;
+        uint64_t trigram_count;
+        uint64_t directory_offset;
+        uint64_t postings_offset;
+        uint64_t postings_size;
+        uint64_t dense_offset;
+        uint64_t dense_count;
+        uint64_t dense_size;
+    };
+
+    struct DirectoryEntry {
+        uint64_t offset;                // Into the posting data.
+        uint32_t trigram;
+        uint32_t page_count;
+    };
+
+    // One slice's posting lists: local page numbers as varint deltas, per trigram.
+    struct SlicePostings {
+        uint64_t first_page = 0;
+        std::vector<uint32_t> trigrams;
+        std::vector<uint64_t> offsets;  // trigrams.size() + 1 entries into `data`.
+        std::vector<uint8_t> data;
+        std::vector<uint64_t> dense_pages;
+    };
+
+    inline uint8_t Fold(uint8_t c) { return (c >= 'A' && c <= 'Z') ? (uint8_t)(c + 32) : c; }
+    inline uint32_t Trigram(const uint8_t* p) { return ((uint32_t)Fold(p[0]) << 16) | ((uint32_t)Fold(p[1]) << 8) | Fold(p[2]); }
+
+    void PutVarint(std::vector<uint8_t>& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((uint8_t)value);
+    }
+    bool GetVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && p < end; shift += 7) {
+            const uint8_t byte = *p++;
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    int64_t DumpTime(const std::string& path) {
+        std::error_code ignored;
+        return (int64_t)std::filesystem::last_write_time(path, ignored).time_since_epoch().count();
+    }
+
+    void IndexSlice(const DumpReader& reader, uint64_t first_page, uint64_t page_count, std::vector<char>& buffer, std::vector<uint64_t>& keys, SlicePostings& slice) {
+        slice.first_page = first_page;
+        const uint64_t start = first_page * kPageSize;
+        // Two bytes past the slice complete the trigrams that start in its last page.
+        const size_t available = reader.Read(start, buffer.data(), (size_t)std::min<uint64_t>(page_count * kPageSize + 2, reader.LogicalSize() - start));
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(buffer.data());
+        keys.clear();
+        std::vector<uint32_t> page_trigrams;
+        page_trigrams.reserve(kPageSize);
+        for (uint64_t local = 0; local < page_count; ++local) {
+            const size_t begin = (size_t)(local * kPageSize);
+            if (begin >= available) break;
+            const size_t end = std::min<size_t>(begin + kPageSize, available >= 2 ? available - 2 : 0);
+            page_trigrams.clear();
+            for (size_t i = begin; i < end; ++i) page_trigrams.push_back(Trigram(bytes + i));
+            std::sort(page_trigrams.begin(), page_trigrams.end());
+            page_trigrams.erase(std::unique(page_trigrams.begin(), page_trigrams.end()), page_trigrams.end());
+            if (page_trigrams.size() > TrigramIndex::kDensePageTrigrams) {
+                slice.dense_pages.push_back(first_page + local);
+                continue;
+            }
+            for (uint32_t trigram : page_trigrams) keys.push_back(((uint64_t)trigram << 32) | local);
+        }
+        std::sort(keys.begin(), keys.end());
+        uint32_t current = UINT32_MAX;
+        uint64_t previous = 0;
+        for (uint64_t key : keys) {
+            const uint32_t trigram = (uint32_t)(key >> 32);
+            const uint64_t local = key & 0xFFFFFFFFu;
+            if (trigram != current) {
+                slice.trigrams.push_back(trigram);
+                slice.offsets.push_back(slice.data.size());
+                current = trigram;
+                previous = 0;
+            }
+            PutVarint(slice.data, local - previous);
+            previous = local;
+        }
+        slice.offsets.push_back(slice.data.size());
+    }
+
+    // Merges the slices' lists for trigrams in [low, high) into global page lists.
+    void MergeRange(const std::vector<SlicePostings>& slices, uint32_t low, uint32_t high, std::vector<DirectoryEntry>& entries, std::vector<uint8_t>& data) {
+        struct Item {
+            uint32_t trigram;
+            uint32_t slice;
+            size_t index;
+        };
+        std::vector<Item> items;
+        for (size_t s = 0; s < slices.size(); ++s) {
+            const auto& trigrams = slices[s].trigrams;
+            const size_t first = std::lower_bound(trigrams.begin(), trigrams.end(), low) - trigrams.begin();
+            const size_t last = std::lower_bound(trigrams.begin(), trigrams.end(), high) - trigrams.begin();
+            for (size_t i = first; i < last; ++i) items.push_back({ trigrams[i], (uint32_t)s, i });
+        }
+        // Slices are in page order, so (trigram, slice) order yields ascending pages per trigram.
+        std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) { return a.trigram != b.trigram ? a.trigram < b.trigram : a.slice < b.slice; });
+        for (size_t i = 0; i < items.size();) {
+            DirectoryEntry entry = { data.size(), items[i].trigram, 0 };
+            uint64_t previous = 0;
+            for (; i < items.size() && items[i].trigram == entry.trigram; ++i) {
+                const SlicePostings& slice = slices[items[i].slice];
+                const uint8_t* p = slice.data.data() + slice.offsets[items[i].index];
+                const uint8_t* end = slice.data.data() + slice.offsets[items[i].index + 1];
+                uint64_t local = 0, delta = 0;
+                while (p < end && GetVarint(p, end, delta)) {
+                    local += delta;
+                    const uint64_t page = slice.first_page + local;
+                    PutVarint(data, page - previous);
+                    previous = page;
+                    ++entry.page_count;
+                }
+            }
+            entries.push_back(entry);
+        }
+    }
+
+    // Ascending union of `pages` and the page before each, so a trigram found in page p also
+    // admits a match starting in p - 1.
+    std::vector<uint64_t> WithPreviousPages(const std::vector<uint64_t>& pages) {
+        std::vector<uint64_t> previous;
+        previous.reserve(pages.size());
+        for (uint64_t page : pages) {
+            if (page > 0) previous.push_back(page - 1);
+        }
+        std::vector<uint64_t> result;
+        result.reserve(pages.size() * 2);
+        std::merge(pages.begin(), pages.end(), previous.begin(), previous.end(), std::back_inserter(result));
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+    // Process address of an image offset, for structured dumps.
+    bool OffsetToAddress(const DumpReader& reader, uint64_t offset, uint64_t& address) {
+        if (!reader.IsStructured()) return false;
+        const auto& regions = reader.Regions();
+        const uint64_t page_size = reader.Header().page_size;
+        auto it = std::upper_bound(regions.begin(), regions.end(), offset, [&](uint64_t value, const DumpFormat::RegionEntry& region) { return value < region.first_page * page_size; });
+        if (it == regions.begin()) return false;
+        --it;
+        const uint64_t region_offset = offset - it->first_page * page_size;
+        if (region_offset >= it->size) return false;
+        address = it->base_address + region_offset;
+        return true;
+    }
+}
+
+namespace TrigramIndex {
+
+    bool Build(const std::string& dump_path, int thread_count, const std::function<void(float)>& progress, uint64_t& index_size, std::string& error) {
+        DumpReader reader;
+        std::string open_error;
+        if (!reader.Open(dump_path, open_error)) { error = "Could not open dump: " + open_error; return false; }
+        thread_count = std::max(1, thread_count);
+        const uint64_t size = reader.LogicalSize();
+        const uint64_t page_count = (size + kPageSize - 1) / kPageSize;
+        const size_t slice_count = (size_t)((page_count + kSlicePages - 1) / kSlicePages);
+        std::vector<SlicePostings> slices(slice_count);
+        std::atomic<size_t> next_slice = 0;
+        std::atomic<size_t> slices_done = 0;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&]() {
+                std::vector<char> buffer(kSlicePages * kPageSize + 2);
+                std::vector<uint64_t> keys;
+                for (size_t s = next_slice++; s < slice_count; s = next_slice++) {
+                    const uint64_t first_page = s * kSlicePages;
+                    IndexSlice(reader, first_page, std::min(kSlicePages, page_count - first_page), buffer, keys, slices[s]);
+                    progress(0.9f * (float)(++slices_done) / (float)slice_count);
+                }
+                });
+        }
+        for (auto& th : threads) th.join();
+
+        std::vector<std::vector<DirectoryEntry>> range_entries(kMergeRanges);
+        std::vector<std::vector<uint8_t>> range_data(kMergeRanges);
+        std::atomic<uint32_t> next_range = 0;
+        threads.clear();
+        for (int t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&]() {
+                const uint32_t range_width = kTrigramSpace / kMergeRanges;
+                for (uint32_t r = next_range++; r < kMergeRanges; r = next_range++) MergeRange(slices, r * range_width, (r + 1) * range_width, range_entries[r], range_data[r]);
+                });
+        }
+        for (auto& th : threads) th.join();
+        progress(0.95f);
+
+        std::vector<DirectoryEntry> directory;
+        std::vector<uint8_t> postings;
+        for (uint32_t r = 0; r < kMergeRanges; ++r) {
+            for (DirectoryEntry entry : range_entries[r]) {
+                entry.offset += postings.size();
+                directory.push_back(entry);
+            }
+            postings.insert(postings.end(), range_data[r].begin(), range_data[r].end());
+            std::vector<uint8_t>().swap(range_data[r]);
+        }
+        std::vector<uint8_t> dense;
+        uint64_t dense_count = 0, previous = 0;
+        for (const auto& slice : slices) {
+            for (uint64_t page : slice.dense_pages) {
+                PutVarint(dense, page - previous);
+                previous = page;
+                ++dense_count;
+            }
+        }
+
+        IndexHeader header = {};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.page_size = (uint32_t)kPageSize;
+        header.page_count = page_count;
+        header.dump_size = size;
+        header.dump_id[0] = reader.Header().dump_id[0];
+        header.dump_id[1] = reader.Header().dump_id[1];
+        header.dump_time = DumpTime(dump_path);
+        header.trigram_count = directory.size();
+        header.directory_offset = sizeof(IndexHeader);
+        header.postings_offset = header.directory_offset + directory.size() * sizeof(DirectoryEntry);
+        header.postings_size = postings.size();
+        header.dense_offset = header.postings_offset + postings.size();
+        header.dense_count = dense_count;
+        header.dense_size = dense.size();
+
+        PositionalFile file;
+        std::string file_error;
+        const std::string path = SidecarPath(dump_path);
+        if (!file.Open(path, file_error)) { error = "Could not create trigram index: " + file_error; return false; }
+        const bool ok = file.WriteAt(0, &header, sizeof(header)) &&
+                        file.WriteAt(header.directory_offset, directory.data(), directory.size() * sizeof(DirectoryEntry)) &&
+                        file.WriteAt(header.postings_offset, postings.data(), postings.size()) &&
+                        file.WriteAt(header.dense_offset, dense.data(), dense.size());
+        if (!ok) { error = "Could not write trigram index " + path; return false; }
+        index_size = header.dense_offset + dense.size();
+        progress(1.0f);
+        return true;
+    }
+
+    bool Index::Open(const std::string& dump_path, const DumpReader& reader, std::string& error) {
+        const std::string path = SidecarPath(dump_path);
+        if (!file.Open(path, error)) return false;
+        IndexHeader header;
+        if (file.Size() < sizeof(header)) { error = "Trigram index is truncated: " + path; file.Close(); return false; }
+        std::memcpy(&header, file.Data(), sizeof(header));
+        auto fits = [&](uint64_t offset, uint64_t bytes) { return offset <= file.Size() && bytes <= file.Size() - offset; };
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion || header.page_size != kPageSize ||
+            header.trigram_count > kTrigramSpace || !fits(header.directory_offset, header.trigram_count * sizeof(DirectoryEntry)) ||
+            !fits(header.postings_offset, header.postings_size) || !fits(header.dense_offset, header.dense_size)) {
+            error = "Not a valid trigram index: " + path;
+            file.Close();
+            return false;
+        }
+        if (header.dump_size != reader.LogicalSize() || header.dump_id[0] != reader.Header().dump_id[0] || header.dump_id[1] != reader.Header().dump_id[1] ||
+            header.dump_time != DumpTime(dump_path)) {
+            error = "Trigram index is out of date: " + path;
+            file.Close();
+            return false;
+        }
+        page_count = header.page_count;
+        trigram_count = header.trigram_count;
+        directory = file.Data() + header.directory_offset;
+        postings = reinterpret_cast<const uint8_t*>(file.Data() + header.postings_offset);
+        postings_size = header.postings_size;
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(file.Data() + header.dense_offset);
+        const uint8_t* end = p + header.dense_size;
+        uint64_t page = 0, delta = 0;
+        dense_pages.clear();
+        for (uint64_t i = 0; i < header.dense_count && GetVarint(p, end, delta); ++i) dense_pages.push_back(page += delta);
+        return true;
+    }
+
+    std::vector<uint64_t> Index::Postings(uint32_t trigram) const {
+        uint64_t low = 0, high = trigram_count;
+        DirectoryEntry entry = {};
+        while (low < high) {
+            const uint64_t mid = low + (high - low) / 2;
+            std::memcpy(&entry, directory + mid * sizeof(DirectoryEntry), sizeof(entry));
+            if (entry.trigram < trigram) low = mid + 1;
+            else high = mid;
+        }
+        std::vector<uint64_t> pages;
+        if (low < trigram_count) {
+            std::memcpy(&entry, directory + low * sizeof(DirectoryEntry), sizeof(entry));
+            if (entry.trigram == trigram && entry.offset <= postings_size) {
+                const uint8_t* p = postings + entry.offset;
+                const uint8_t* end = postings + postings_size;
+                uint64_t page = 0, delta = 0;
+                pages.reserve(entry.page_count);
+                for (uint32_t i = 0; i < entry.page_count && GetVarint(p, end, delta); ++i) pages.push_back(page += delta);
+            }
+        }
+        if (dense_pages.empty()) return pages;
+        std::vector<uint64_t> merged;
+        merged.reserve(pages.size() + dense_pages.size());
+        std::merge(pages.begin(), pages.end(), dense_pages.begin(), dense_pages.end(), std::back_inserter(merged));
+        return merged;
+    }
+
+    std::vector<uint64_t> Index::Candidates(const std::vector<std::string>& literals) const {
+        std::set<uint32_t> trigrams;
+        for (const auto& literal : literals) {
+            // Only trigrams within a page of the match start are guaranteed to sit in its page or the next.
+            const size_t length = std::min<size_t>(literal.size(), kPageSize + 2);
+            for (size_t i = 0; i + 3 <= length; ++i) trigrams.insert(Trigram(reinterpret_cast<const uint8_t*>(literal.data()) + i));
+        }
+        std::vector<uint64_t> candidates;
+        bool first = true;
+        for (uint32_t trigram : trigrams) {
+            const std::vector<uint64_t> pages = WithPreviousPages(Postings(trigram));
+            if (first) candidates = pages;
+            else {
+                std::vector<uint64_t> both;
+                std::set_intersection(candidates.begin(), candidates.end(), pages.begin(), pages.end(), std::back_inserter(both));
+                candidates.swap(both);
+            }
+            first = false;
+            if (candidates.empty()) break;
+        }
+        return candidates;
+    }
+
+    std::vector<std::string> RequiredLiterals(const std::string& pattern, bool regex) {
+        std::vector<std::string> literals;
+        if (!regex) {
+            if (pattern.size() >= 3) literals.push_back(pattern);
+            return literals;
+        }
+        std::string current;
+        auto close = [&]() {
+            if (current.size() >= 3) literals.push_back(current);
+            current.clear();
+        };
+        // Skips a bracketed class or group starting at `i`, returning the index of its closing character.
+        auto skip = [&](size_t i, char open, char close_char) {
+            int depth = 0;
+            for (; i < pattern.size(); ++i) {
+                if (pattern[i] == '\\') { ++i; continue; }
+                if (open == '(' && pattern[i] == '[') {
+                    // Brackets inside a group may hold parentheses.
+                    for (++i; i < pattern.size() && pattern[i] != ']'; ++i) if (pattern[i] == '\\') ++i;
+                    continue;
+                }
+                if (pattern[i] == open && (open == '(' || depth == 0)) ++depth;
+                else if (pattern[i] == close_char && --depth == 0) return i;
+            }
+            return pattern.size();
+        };
+        for (size_t i = 0; i < pattern.size(); ++i) {
+            const char c = pattern[i];
+            switch (c) {
+            case '|':
+                // Any branch may match; no literal is required.
+                return {};
+            case '\\':
+                if (i + 1 < pattern.size() && !std::isalnum((unsigned char)pattern[i + 1])) { current += pattern[++i]; break; }
+                // Classes, assertions and coded characters end the literal, along with their operands:
+                // \xHH, \uHHHH, \cX and the digits of a backreference.
+                close();
+                if (++i >= pattern.size()) break;
+                if (pattern[i] == 'x') i += 2;
+                else if (pattern[i] == 'u') i += 4;
+                else if (pattern[i] == 'c') i += 1;
+                else if (std::isdigit((unsigned char)pattern[i])) { while (i + 1 < pattern.size() && std::isdigit((unsigned char)pattern[i + 1])) ++i; }
+                break;
+            case '[': close(); i = skip(i, '[', ']'); break;
+            case '(': close(); i = skip(i, '(', ')'); break;
+            case '*': case '?':
+                // The previous character may be absent.
+                if (!current.empty()) current.pop_back();
+                close();
+                break;
+            case '{':
+                if (!current.empty()) current.pop_back();
+                close();
+                while (i < pattern.size() && pattern[i] != '}') ++i;
+                break;
+            case '+': close(); break;
+            case '.': case '^': case '$': close(); break;
+            default: current += c; break;
+            }
+        }
+        close();
+        return literals;
+    }
+
+    bool Search(const std::string& dump_path, const Query& query, int thread_count, std::vector<Hit>& hits, SearchStats& stats, std::string& error) {
+        hits.clear();
+        stats = {};
+        if (query.pattern.empty()) { error = "The search pattern is empty."; return false; }
+        DumpReader reader;
+        std::string open_error;
+        if (!reader.Open(dump_path, open_error)) { error = "Could not open dump: " + open_error; return false; }
+        const uint64_t size = reader.LogicalSize();
+        stats.page_count = (size + kPageSize - 1) / kPageSize;
+
+        std::regex pattern_regex;
+        if (query.regex) {
+            try {
+                auto flags = std::regex::ECMAScript | std::regex::optimize;
+                if (query.case_insensitive) flags |= std::regex::icase;
+                pattern_regex = std::regex(query.pattern, flags);
+            }
+            catch (const std::regex_error& e) {
+                error = std::string("Invalid regular expression: ") + e.what();
+                return false;
+            }
+        }
+        std::string literal = query.pattern;
+        if (query.case_insensitive) std::transform(literal.begin(), literal.end(), literal.begin(), [](char c) { return (char)Fold((uint8_t)c); });
+        const std::boyer_moore_horspool_searcher<std::string::const_iterator> searcher(literal.begin(), literal.end());
+
+        std::vector<uint64_t> pages;
+        const std::vector<std::string> literals = RequiredLiterals(query.pattern, query.regex);
+        Index index;
+        std::string index_error;
+        if (!literals.empty() && index.Open(dump_path, reader, index_error)) {
+            pages = index.Candidates(literals);
+            stats.used_index = true;
+        }
+        else {
+            pages.resize((size_t)stats.page_count);
+            for (size_t p = 0; p < pages.size(); ++p) pages[p] = p;
+        }
+
+        // Each candidate is verified on its page plus the next one, keeping matches that start in it.
+        std::atomic<size_t> next_page = 0;
+        std::atomic<size_t> hit_count = 0;
+        std::atomic<uint64_t> verified = 0;
+        std::mutex hits_mutex;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < std::max(1, thread_count); ++t) {
+            threads.emplace_back([&]() {
+                // A literal is verified over its page plus literal.size() - 1 bytes, which may exceed a page.
+                std::vector<char> buffer(kPageSize + std::max<size_t>(kPageSize, literal.size()));
+                std::vector<Hit> local_hits;
+                auto add_hit = [&](uint64_t offset, const char* match, size_t length) {
+                    Hit hit;
+                    hit.offset = offset;
+                    hit.length = length;
+                    hit.has_address = OffsetToAddress(reader, offset, hit.address);
+                    hit.preview.assign(match, std::min(length, kPreviewLength));
+                    for (char& c : hit.preview) if ((unsigned char)c < 0x20 || (unsigned char)c > 0x7E) c = '.';
+                    local_hits.push_back(std::move(hit));
+                    ++hit_count;
+                };
+                for (size_t i = next_page++; i < pages.size() && hit_count < query.max_hits; i = next_page++) {
+                    const uint64_t start = pages[i] * kPageSize;
+                    if (start >= size) continue;
+                    const size_t page_length = (size_t)std::min<uint64_t>(kPageSize, size - start);
+                    const size_t window = (size_t)std::min<uint64_t>(query.regex ? kPageSize * 2 : kPageSize + literal.size() - 1, size - start);
+                    const size_t got = reader.Read(start, buffer.data(), window);
+                    ++verified;
+                    if (query.regex) {
+                        for (std::cregex_iterator it(buffer.data(), buffer.data() + got, pattern_regex), end; it != end; ++it) {
+                            const size_t position = (size_t)it->position();
+                            if (position >= page_length) break;
+                            if (it->length() > 0) add_hit(start + position, buffer.data() + position, (size_t)it->length());
+                        }
+                        continue;
+                    }
+                    std::string text(buffer.data(), got);
+                    if (query.case_insensitive) std::transform(text.begin(), text.end(), text.begin(), [](char c) { return (char)Fold((uint8_t)c); });
+                    for (auto it = text.cbegin();;) {
+                        const auto match = searcher(it, text.cend());
+                        if (match.first == text.cend() || (size_t)(match.first - text.cbegin()) >= page_length) break;
+                        const size_t position = (size_t)(match.first - text.cbegin());
+                        add_hit(start + position, buffer.data() + position, literal.size());
+                        it = match.first + 1;
+                    }
+                }
+                std::lock_guard<std::mutex> lock(hits_mutex);
+                hits.insert(hits.end(), std::make_move_iterator(local_hits.begin()), std::make_move_iterator(local_hits.end()));
+                });
+        }
+        for (auto& th : threads) th.join();
+        std::sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b) { return a.offset < b.offset; });
+        if (hits.size() > query.max_hits) hits.resize(query.max_hits);
+        stats.pages_verified = verified;
+        return true;
+    }
+}
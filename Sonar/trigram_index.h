@@ -0,0 +1,88 @@
+#pragma once
+
+#include "mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class DumpReader;
+
+// Trigram index over a dump's flat image, kept as a sidecar (`<dump>.tri`) so repeated searches
+// of the same dump read only the pages that can match. For every 4 KB page it records the byte
+// trigrams that start in the page (ASCII letters folded to lower case) as posting lists of page
+// numbers:
+//
+//   Header | directory[trigram_count] (sorted by trigram) | posting data | dense pages
+//
+// Posting lists and the dense page list are varint deltas. Pages with more than
+// kDensePageTrigrams distinct trigrams (compressed or random data) would bloat every list, so
+// they are only listed as dense and every query checks them.
+//
+// A query is reduced to literals that every match must contain. A page is a candidate when every
+// trigram of those literals starts in it or in the next page (a match may run across the page
+// boundary), and only candidates are read and verified. Matches are limited to one page plus the
+// next, which is also how far regular expressions are matched.
+namespace TrigramIndex {
+
+    constexpr uint32_t kDensePageTrigrams = 2048;
+
+    inline std::string SidecarPath(const std::string& dump_path) { return dump_path + ".tri"; }
+
+    // Indexes the dump at `dump_path` and writes the sidecar. Slices of the image are indexed in
+    // parallel by `thread_count` workers, and their posting lists are merged by trigram range.
+    bool Build(const std::string& dump_path, int thread_count, const std::function<void(float)>& progress, uint64_t& index_size, std::string& error);
+
+    struct Query {
+        std::string pattern;
+        bool regex = false;             // ECMAScript syntax.
+        bool case_insensitive = false;
+        size_t max_hits = 10000;
+    };
+
+    struct Hit {
+        uint64_t offset = 0;            // In the flat image.
+        uint64_t address = 0;           // Process address, for structured dumps.
+        bool has_address = false;
+        size_t length = 0;
+        std::string preview;            // The matched bytes, unprintable ones as '.'.
+    };
+
+    struct SearchStats {
+        bool used_index = false;
+        uint64_t page_count = 0;
+        uint64_t pages_verified = 0;
+    };
+
+    // Searches the dump through its index when an up-to-date sidecar exists; otherwise, or when the
+    // query has no literal of three bytes or more, every page is verified. Hits are in offset order.
+    bool Search(const std::string& dump_path, const Query& query, int thread_count, std::vector<Hit>& hits, SearchStats& stats, std::string& error);
+
+    // Literals every match of `pattern` must contain, for the index lookup. Alternations and
+    // patterns without a fixed run of three bytes give none.
+    std::vector<std::string> RequiredLiterals(const std::string& pattern, bool regex);
+
+    // Memory-mapped sidecar.
+    class Index {
+    public:
+        // Opens the sidecar of `dump_path`; fails when it is missing or was built from a different
+        // dump than `reader`.
+        bool Open(const std::string& dump_path, const DumpReader& reader, std::string& error);
+        uint64_t PageCount() const { return page_count; }
+        // Pages where a match containing all of `literals` can start, ascending.
+        std::vector<uint64_t> Candidates(const std::vector<std::string>& literals) const;
+
+    private:
+        // The pages holding `trigram`, including the dense pages.
+        std::vector<uint64_t> Postings(uint32_t trigram) const;
+
+        MappedFile file;
+        uint64_t page_count = 0;
+        uint64_t trigram_count = 0;
+        const char* directory = nullptr;
+        const uint8_t* postings = nullptr;
+        uint64_t postings_size = 0;
+        std::vector<uint64_t> dense_pages;
+    };
+}
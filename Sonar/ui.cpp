@@ -2,6 +2,8 @@
 #define NOMINMAX
 #include <GLFW/glfw3.h>
 #include "ui.h"
+#include "provenance.h"
+#include "string_scan.hpp"
 #include "imgui_internal.h"
 #include <cstdio>
 #include <thread>
@@ -36,6 +38,13 @@ std::string GetConfigFilePath() {
     return GetAppDataDirectory() + "\\sonar_settings.ini";
 }
 
+void ApplyResourceLimits(AppState& state) {
+    state.resource_limits.read.SetRate((uint64_t)state.limit_read_mb * 1024 * 1024);
+    state.resource_limits.write.SetRate((uint64_t)state.limit_write_mb * 1024 * 1024);
+    state.resource_limits.cpu_percent = state.limit_cpu_percent;
+    state.resource_limits.low_priority = state.limit_low_priority;
+}
+
 void SaveSettings(const AppState& state) {
     std::ofstream settings_file(GetConfigFilePath());
     if (!settings_file.is_open()) return;
@@ -48,6 +57,10 @@ void SaveSettings(const AppState& state) {
 
     settings_file << "\n[Performance]" << std::endl;
     settings_file << "scanner_thread_count=" << state.scanner_thread_count << std::endl;
+    settings_file << "limit_read_mb=" << state.limit_read_mb << std::endl;
+    settings_file << "limit_write_mb=" << state.limit_write_mb << std::endl;
+    settings_file << "limit_cpu_percent=" << state.limit_cpu_percent << std::endl;
+    settings_file << "limit_low_priority=" << state.limit_low_priority << std::endl;
 
     settings_file << "\n[Workflow]" << std::endl;
     settings_file << "case_insensitive=" << state.scan_case_insensitive << std::endl;
@@ -63,7 +76,23 @@ void SaveSettings(const AppState& state) {
     settings_file << "\n[DumperDefaults]" << std::endl;
     settings_file << "dump_type=" << state.dump_type << std::endl;
     settings_file << "dump_optimize=" << state.dump_optimize << std::endl;
+    settings_file << "dump_compress=" << state.dump_compress << std::endl;
+    settings_file << "dump_checkpoint=" << state.dump_checkpoint << std::endl;
+    settings_file << "dump_text_utf8=" << state.dump_text_utf8 << std::endl;
+    settings_file << "dump_text_utf16be=" << state.dump_text_utf16be << std::endl;
+    settings_file << "dump_text_latin1=" << state.dump_text_latin1 << std::endl;
+    settings_file << "dump_min_length=";
+    for (size_t e = 0; e < StringScan::kEncodingCount; ++e) settings_file << (e ? "," : "") << state.dump_min_length[e];
+    settings_file << std::endl;
+    settings_file << "dump_text_sorted=" << state.dump_text_sorted << std::endl;
+    settings_file << "dump_text_front_coded=" << state.dump_text_front_coded << std::endl;
+    settings_file << "dump_text_budget_mb=" << state.dump_text_budget_mb << std::endl;
+    settings_file << "dump_provenance=" << state.dump_provenance << std::endl;
+    settings_file << "dump_provenance_addresses=" << state.dump_provenance_addresses << std::endl;
+    settings_file << "dump_container=" << state.dump_container << std::endl;
+    settings_file << "dump_segment_mb=" << state.dump_segment_mb << std::endl;
     settings_file << "dump_string_type=" << state.dump_string_type << std::endl;
+    settings_file << "diff_binary_mode=" << state.diff_binary_mode << std::endl;
     settings_file << "use_filter_list=" << state.use_filter_list << std::endl;
     settings_file << "filter_non_ascii=" << state.filter_non_ascii << std::endl;
 }
@@ -88,6 +117,10 @@ void LoadSettings(AppState& state) {
                 else if (key == "enable_animations") state.settings_enable_animations = (std::stoi(value) != 0);
                 // Performance
                 else if (key == "scanner_thread_count") state.scanner_thread_count = std::stoi(value);
+                else if (key == "limit_read_mb") state.limit_read_mb = std::max(0, std::stoi(value));
+                else if (key == "limit_write_mb") state.limit_write_mb = std::max(0, std::stoi(value));
+                else if (key == "limit_cpu_percent") state.limit_cpu_percent = std::clamp(std::stoi(value), 5, 100);
+                else if (key == "limit_low_priority") state.limit_low_priority = (std::stoi(value) != 0);
                 // Workflow
                 else if (key == "case_insensitive") state.scan_case_insensitive = (std::stoi(value) != 0);
                 else if (key == "clear_signatures_on_complete") state.clear_signatures_on_complete = (std::stoi(value) != 0);
@@ -101,7 +134,25 @@ void LoadSettings(AppState& state) {
                 // Dumper Defaults
                 else if (key == "dump_type") state.dump_type = static_cast<AppState::DumpType>(std::stoi(value));
                 else if (key == "dump_optimize") state.dump_optimize = (std::stoi(value) != 0);
+                else if (key == "dump_compress") state.dump_compress = (std::stoi(value) != 0);
+                else if (key == "dump_checkpoint") state.dump_checkpoint = (std::stoi(value) != 0);
+                else if (key == "dump_text_utf8") state.dump_text_utf8 = (std::stoi(value) != 0);
+                else if (key == "dump_text_utf16be") state.dump_text_utf16be = (std::stoi(value) != 0);
+                else if (key == "dump_text_latin1") state.dump_text_latin1 = (std::stoi(value) != 0);
+                else if (key == "dump_min_length") {
+                    std::istringstream lengths(value);
+                    std::string length;
+                    for (size_t e = 0; e < StringScan::kEncodingCount && std::getline(lengths, length, ','); ++e) state.dump_min_length[e] = std::clamp(std::stoi(length), 1, 256);
+                }
+                else if (key == "dump_text_sorted") state.dump_text_sorted = (std::stoi(value) != 0);
+                else if (key == "dump_text_front_coded") state.dump_text_front_coded = (std::stoi(value) != 0);
+                else if (key == "dump_text_budget_mb") state.dump_text_budget_mb = std::max(16, std::stoi(value));
+                else if (key == "dump_provenance") state.dump_provenance = (std::stoi(value) != 0);
+                else if (key == "dump_provenance_addresses") state.dump_provenance_addresses = std::clamp(std::stoi(value), 1, 64);
+                else if (key == "dump_container") state.dump_container = static_cast<DumpContainer>(std::stoi(value));
+                else if (key == "dump_segment_mb") state.dump_segment_mb = std::max(1, std::stoi(value));
                 else if (key == "dump_string_type") state.dump_string_type = static_cast<AppState::DumpStringType>(std::stoi(value));
+                else if (key == "diff_binary_mode") state.diff_binary_mode = static_cast<BinaryDiffMode>(std::stoi(value));
                 else if (key == "use_filter_list") state.use_filter_list = (std::stoi(value) != 0);
                 else if (key == "filter_non_ascii") state.filter_non_ascii = (std::stoi(value) != 0);
             }
@@ -110,6 +161,8 @@ void LoadSettings(AppState& state) {
         }
     }
 
+    ApplyResourceLimits(state);
+
     // After loading, check for any uninitialized forensic paths and derive them from the default directory.
     if (state.default_output_dir[0] != '\0') {
         std::filesystem::path base_path(state.default_output_dir);
@@ -242,6 +295,42 @@ static bool BeginCard(const char* title, const ImVec2& size = ImVec2(0, 0), bool
     if (with_separator) Separator();
     return true;
 }
+static void RenderResourceLimits(AppState& state) {
+    bool changed = false;
+    ImGui::PushItemWidth(140.0f);
+    changed |= ImGui::InputInt("Read limit (MB/s)", &state.limit_read_mb, 10, 100);
+    if (ImGui::IsItemHovered()) ImGui::SetTooltip("Caps how fast dumps and scans read target process memory. 0 = unlimited.");
+    changed |= ImGui::InputInt("Write limit (MB/s)", &state.limit_write_mb, 10, 100);
+    if (ImGui::IsItemHovered()) ImGui::SetTooltip("Caps how fast dumps write to disk. 0 = unlimited.");
+    changed |= ImGui::SliderInt("Worker CPU (%)", &state.limit_cpu_percent, 5, 100);
+    if (ImGui::IsItemHovered()) ImGui::SetTooltip("Each worker thread idles so that it spends at most this share of its time on the CPU.");
+    ImGui::PopItemWidth();
+    changed |= ImGui::Checkbox("Low priority (background mode)", &state.limit_low_priority);
+    if (ImGui::IsItemHovered()) ImGui::SetTooltip("Runs workers with background CPU and I/O priority so the target's own work goes first.");
+    if (changed) {
+        state.limit_read_mb = std::max(0, state.limit_read_mb);
+        state.limit_write_mb = std::max(0, state.limit_write_mb);
+        ApplyResourceLimits(state);
+    }
+}
+
+// Achieved vs configured rates for a running job, with the limits editable in place.
+static void RenderResourceReadout(AppState& state, const char* id) {
+    const double read_rate = state.read_meter.Sample(state.resource_limits.read.Total()) / (1024.0 * 1024.0);
+    const double write_rate = state.write_meter.Sample(state.resource_limits.write.Total()) / (1024.0 * 1024.0);
+    char read_limit[32] = "unlimited", write_limit[32] = "unlimited";
+    if (state.limit_read_mb > 0) snprintf(read_limit, sizeof(read_limit), "%d MB/s", state.limit_read_mb);
+    if (state.limit_write_mb > 0) snprintf(write_limit, sizeof(write_limit), "%d MB/s", state.limit_write_mb);
+    ImGui::TextDisabled("Read %.1f MB/s (%s)  Write %.1f MB/s (%s)  CPU %d%%%s", read_rate, read_limit, write_rate, write_limit,
+        state.limit_cpu_percent, state.limit_low_priority ? "  Low priority" : "");
+    ImGui::PushID(id);
+    if (ImGui::TreeNode("Limits")) {
+        RenderResourceLimits(state);
+        ImGui::TreePop();
+    }
+    ImGui::PopID();
+}
+
 static void EndCard() {
     ImGui::EndGroup();
     ImGui::PopStyleVar();
@@ -346,6 +435,7 @@ static void RenderQuickScan(AppState& state, const ImVec2& contentSize) {
         if (ImGui::Button(ICON_FA_SYNC " Refresh")) {
             state.process_list = GetProcessList();
             state.quick_scan_selections.assign(state.process_list.size(), false);
+            state.dump_selections.assign(state.process_list.size(), false);
             state.forensic_dump_selection = -1;
             state.last_quick_scan_selection = -1;
         }
@@ -486,6 +576,7 @@ static void RenderQuickScan(AppState& state, const ImVec2& contentSize) {
             float progress; std::string status;
             { std::lock_guard<std::mutex> lock(state.scan_progress_mutex); progress = state.scan_progress; status = state.scan_status; }
             ImGui::ProgressBar(progress, ImVec2(-1, 0), status.c_str());
+            RenderResourceReadout(state, "scan_limits");
         }
         EndCard();
     }
@@ -557,6 +648,7 @@ static void RenderForensic(AppState& state, const ImVec2& contentSize) {
             state.process_list = GetProcessList();
             state.quick_scan_selections.assign(state.process_list.size(), false);
             state.last_quick_scan_selection = -1;
+            state.dump_selections.assign(state.process_list.size(), false);
             state.forensic_dump_selection = -1;
         }
 
@@ -571,7 +663,21 @@ static void RenderForensic(AppState& state, const ImVec2& contentSize) {
                     std::string disp_lower = p.display_name; for (auto& c : disp_lower) c = (char)tolower(c);
                     if (disp_lower.find(filt_lower) == std::string::npos) continue;
                 }
-                if (ImGui::Selectable(p.display_name.c_str(), state.forensic_dump_selection == i)) state.forensic_dump_selection = i;
+                if (ImGui::Selectable(p.display_name.c_str(), state.dump_selections[i])) {
+                    if (!ImGui::GetIO().KeyCtrl && !ImGui::GetIO().KeyShift) {
+                        std::fill(state.dump_selections.begin(), state.dump_selections.end(), false);
+                        state.dump_selections[i] = true;
+                    }
+                    else if (ImGui::GetIO().KeyShift && state.forensic_dump_selection != -1) {
+                        int start = std::min(state.forensic_dump_selection, i);
+                        int end = std::max(state.forensic_dump_selection, i);
+                        for (int j = start; j <= end; ++j) state.dump_selections[j] = true;
+                    }
+                    else {
+                        state.dump_selections[i] = !state.dump_selections[i];
+                    }
+                    state.forensic_dump_selection = i;
+                }
             }
         }
         ImGui::EndChild();
@@ -610,9 +716,37 @@ static void RenderForensic(AppState& state, const ImVec2& contentSize) {
             }
         }
 
+        const bool plain_container = state.dump_type == AppState::DUMP_TYPE_BINARY && state.dump_container != DUMP_CONTAINER_SONAR;
         if (state.dump_type == AppState::DUMP_TYPE_BINARY) {
+            ImGui::Text("Format:"); ImGui::SameLine();
+            ImGui::RadioButton("Sonar", (int*)&state.dump_container, DUMP_CONTAINER_SONAR); ImGui::SameLine();
+            ImGui::RadioButton("ELF Core", (int*)&state.dump_container, DUMP_CONTAINER_ELF_CORE);
+            if (ImGui::IsItemHovered()) ImGui::SetTooltip("Writes a standard ELF core file (one PT_LOAD segment per region, NT_FILE notes\nfor mapped files) that opens directly in gdb and other ELF tooling.");
+            ImGui::SameLine();
+            ImGui::RadioButton("Minidump", (int*)&state.dump_container, DUMP_CONTAINER_MINIDUMP);
+            if (ImGui::IsItemHovered()) ImGui::SetTooltip("Writes a full-memory minidump (module list and Memory64 list) that opens in WinDbg.");
+        }
+        if (state.dump_type == AppState::DUMP_TYPE_BINARY && !plain_container) {
             ImGui::Checkbox("Optimize", &state.dump_optimize);
-            if (ImGui::IsItemHovered()) ImGui::SetTooltip("For binary dumps only. Skips writing identical pages of memory.");
+            if (ImGui::IsItemHovered()) ImGui::SetTooltip("For binary dumps only. Stores each unique page once and references duplicates,\nso the full dump can still be reconstructed.");
+            if (state.dump_optimize) {
+                ImGui::SameLine();
+                ImGui::Checkbox("Incremental", &state.dump_incremental);
+                if (ImGui::IsItemHovered()) ImGui::SetTooltip("Stores only the pages that changed since an earlier optimized dump of the same process.\nThe base dump must be kept; reading this dump reads unchanged pages from it.");
+                if (state.dump_incremental) {
+                    ImGui::PushItemWidth(-style.ItemSpacing.x);
+                    ImGui::InputTextWithHint("##base_dump_path", "Base Dump Path...", state.dump_base_path, IM_ARRAYSIZE(state.dump_base_path));
+                    ImGui::PopItemWidth();
+                }
+            }
+            ImGui::Checkbox("Segmented", &state.dump_segmented);
+            if (ImGui::IsItemHovered()) ImGui::SetTooltip("Splits the dump into numbered segment files of at most this size, each with its own\nregion table. The output path gets a manifest that opens the segments as one dump.");
+            if (state.dump_segmented) {
+                ImGui::SameLine();
+                ImGui::PushItemWidth(120.0f);
+                if (ImGui::InputInt("MB per segment", &state.dump_segment_mb, 256, 1024)) state.dump_segment_mb = std::max(1, state.dump_segment_mb);
+                ImGui::PopItemWidth();
+            }
         }
 
         if (state.dump_type == AppState::DUMP_TYPE_TEXT) {
@@ -620,6 +754,18 @@ static void RenderForensic(AppState& state, const ImVec2& contentSize) {
             ImGui::RadioButton("ASCII", (int*)&state.dump_string_type, AppState::DUMP_ASCII_ONLY); ImGui::SameLine();
             ImGui::RadioButton("Unicode", (int*)&state.dump_string_type, AppState::DUMP_UNICODE_ONLY); ImGui::SameLine();
             ImGui::RadioButton("Both", (int*)&state.dump_string_type, AppState::DUMP_BOTH);
+            ImGui::Checkbox("UTF-8", &state.dump_text_utf8); ImGui::SameLine();
+            ImGui::Checkbox("UTF-16BE", &state.dump_text_utf16be); ImGui::SameLine();
+            ImGui::Checkbox("Latin-1", &state.dump_text_latin1);
+            if (ImGui::IsItemHovered()) ImGui::SetTooltip("Extra encodings, extracted in the same pass. UTF-8 and Latin-1 keep only strings with\nnon-ASCII characters; plain ASCII comes from the ASCII pass. Latin-1 also turns UTF-8\ntext into look-alike strings, so enable it only for legacy 8-bit text.");
+            if (ImGui::TreeNode("Minimum lengths")) {
+                ImGui::PushItemWidth(120.0f);
+                for (size_t e = 0; e < StringScan::kEncodingCount; ++e) {
+                    if (ImGui::InputInt(StringScan::EncodingName((StringScan::Encoding)(1u << e)), &state.dump_min_length[e], 1, 4)) state.dump_min_length[e] = std::clamp(state.dump_min_length[e], 1, 256);
+                }
+                ImGui::PopItemWidth();
+                ImGui::TreePop();
+            }
 
             ImGui::Checkbox("Use Filter List", &state.use_filter_list); ImGui::SameLine();
             ImGui::Checkbox("Filter Non-ASCII", &state.filter_non_ascii);
@@ -627,6 +773,36 @@ static void RenderForensic(AppState& state, const ImVec2& contentSize) {
             ImGui::PushItemWidth(-style.ItemSpacing.x);
             ImGui::InputTextWithHint("##filter_path", "Filter File Path...", state.filter_list_path, IM_ARRAYSIZE(state.filter_list_path));
             ImGui::PopItemWidth();
+
+            ImGui::Checkbox("Provenance", &state.dump_provenance);
+            if (ImGui::IsItemHovered()) ImGui::SetTooltip("Writes a sidecar (.prov) recording each string's encodings, occurrence count and lowest\naddresses. The Differential Analyzer shows it when hovering a new string. Not available\nwith sorted output.");
+            if (state.dump_provenance) {
+                ImGui::SameLine();
+                ImGui::PushItemWidth(120.0f);
+                if (ImGui::InputInt("addresses per string", &state.dump_provenance_addresses, 1, 4)) state.dump_provenance_addresses = std::clamp(state.dump_provenance_addresses, 1, 64);
+                ImGui::PopItemWidth();
+            }
+            ImGui::Checkbox("Sorted Output", &state.dump_text_sorted);
+            if (ImGui::IsItemHovered()) ImGui::SetTooltip("Writes the strings sorted, so dumps of the same process diff cleanly. Workers spill sorted\nruns to temporary files next to the output once the memory budget is reached, so memory use\nstays bounded however many strings the process holds.");
+            if (state.dump_text_sorted) {
+                ImGui::SameLine();
+                ImGui::PushItemWidth(120.0f);
+                if (ImGui::InputInt("MB memory budget", &state.dump_text_budget_mb, 64, 256)) state.dump_text_budget_mb = std::max(16, state.dump_text_budget_mb);
+                ImGui::PopItemWidth();
+            }
+            ImGui::Checkbox("Front-Coded", &state.dump_text_front_coded);
+            if (ImGui::IsItemHovered()) ImGui::SetTooltip("Writes the strings sorted and prefix-compressed, with a block index, instead of as lines.\nSeveral times smaller than plain text, and two front-coded dumps diff in one streaming pass.\nReplaces compression.");
+        }
+
+        const bool front_coded_text = state.dump_type == AppState::DUMP_TYPE_TEXT && state.dump_text_front_coded;
+        if (!plain_container && !front_coded_text) {
+            ImGui::Checkbox("Compress", &state.dump_compress);
+            if (ImGui::IsItemHovered()) ImGui::SetTooltip("Compresses the dump in independent frames while it is written.\nCompressed dumps can still be diffed and read back directly.");
+        }
+        if (state.dump_type != AppState::DUMP_TYPE_TEXT && !(state.dump_compress && !plain_container)) {
+            if (!plain_container) ImGui::SameLine();
+            ImGui::Checkbox("Resumable", &state.dump_checkpoint);
+            if (ImGui::IsItemHovered()) ImGui::SetTooltip("Keeps a checkpoint journal next to the dump. If the dump is interrupted, dumping the same\nprocess to the same path again continues where it stopped. Not available for compressed dumps.");
         }
 
         ImGui::Dummy(ImVec2(0, 5.0f));
@@ -649,18 +825,60 @@ static void RenderForensic(AppState& state, const ImVec2& contentSize) {
         }
 
         ImGui::SetCursorPosY(group_start_y);
-        const bool dump_button_disabled = state.dump_running || state.forensic_dump_selection < 0;
+        std::vector<ProcessInfo> dump_targets;
+        for (size_t i = 0; i < state.process_list.size() && i < state.dump_selections.size(); ++i) if (state.dump_selections[i]) dump_targets.push_back(state.process_list[i]);
+        const bool dump_button_disabled = state.dump_running || dump_targets.empty();
         if (dump_button_disabled) ImGui::BeginDisabled();
         if (AccentButton(ICON_FA_FLOPPY_DISK " Create Dump", state, ImVec2(button_width, button_height))) {
             state.dump_running = true; state.dump_progress = 0.0f;
-            ProcessInfo target_process = state.process_list[state.forensic_dump_selection];
-            PushLog(state.forensic_log_lines, state.accent_color, "[DUMP] Starting dump for %s...", target_process.display_name.c_str());
-            std::thread([&state, target_process]() {
+            if (dump_targets.size() == 1) PushLog(state.forensic_log_lines, state.accent_color, "[DUMP] Starting dump for %s...", dump_targets[0].display_name.c_str());
+            else PushLog(state.forensic_log_lines, state.accent_color, "[DUMP] Starting batch dump of %zu processes...", dump_targets.size());
+            std::thread([&state, dump_targets]() {
                 auto cb = [&](float p, const std::string& m) { std::lock_guard<std::mutex> l(state.dump_progress_mutex); state.dump_progress = p; state.dump_status = m; };
-                auto [success, message] = CreateManualMemoryDump(target_process.pid, state.dump_output_path, state.dump_optimize, (state.dump_type == AppState::DUMP_TYPE_TEXT), state.dump_string_type, state.filter_list_path, state.use_filter_list, state.filter_non_ascii, cb);
+                DumpOptions options;
+                options.optimize = state.dump_optimize;
+                options.as_text = (state.dump_type == AppState::DUMP_TYPE_TEXT);
+                options.string_type = state.dump_string_type;
+                if (state.dump_text_utf8) options.extra_encodings |= StringScan::ENCODING_UTF8;
+                if (state.dump_text_utf16be) options.extra_encodings |= StringScan::ENCODING_UTF16BE;
+                if (state.dump_text_latin1) options.extra_encodings |= StringScan::ENCODING_LATIN1;
+                std::copy(std::begin(state.dump_min_length), std::end(state.dump_min_length), options.min_string_length);
+                options.filter_list_path = state.filter_list_path;
+                options.use_filter_list = state.use_filter_list;
+                options.filter_non_ascii = state.filter_non_ascii;
+                options.compress = state.dump_compress;
+                options.checkpoint = state.dump_checkpoint && !options.as_text;
+                options.front_coded = options.as_text && state.dump_text_front_coded;
+                if (options.front_coded) options.compress = false;
+                if (options.as_text && state.dump_text_sorted) options.text_memory_budget = (uint64_t)state.dump_text_budget_mb * 1024 * 1024;
+                if (options.as_text && state.dump_provenance && !state.dump_text_sorted) options.provenance_addresses = (uint32_t)state.dump_provenance_addresses;
+                options.limits = &state.resource_limits;
+                if (state.dump_incremental && state.dump_optimize && !options.as_text) options.base_dump_path = state.dump_base_path;
+                if (state.dump_segmented && !options.as_text) options.segment_size = (uint64_t)state.dump_segment_mb * 1024 * 1024;
+                if (!options.as_text && state.dump_container != DUMP_CONTAINER_SONAR) {
+                    // Standard containers are plain images; Sonar-specific encodings don't apply.
+                    options.container = state.dump_container;
+                    options.optimize = false;
+                    options.compress = false;
+                    options.base_dump_path.clear();
+                    options.segment_size = 0;
+                }
+                std::pair<bool, std::string> result;
+                if (dump_targets.size() == 1) result = CreateManualMemoryDump(dump_targets[0].pid, state.dump_output_path, options, cb);
+                else {
+                    std::vector<DWORD> pids;
+                    for (const auto& target : dump_targets) pids.push_back(target.pid);
+                    result = CreateBatchMemoryDump(pids, state.dump_output_path, options, cb);
+                }
+                auto& [success, message] = result;
                 std::lock_guard<std::mutex> lock(state.log_mutex);
                 if (!success && message == "[ACCESS_DENIED]") state.show_elevation_modal = true;
-                else PushLog(state.forensic_log_lines, success ? ImVec4(0.7f, 0.95f, 0.7f, 1.0f) : ImVec4(0.98f, 0.55f, 0.55f, 1.0f), "[DUMP] %s", message.c_str());
+                else {
+                    // Batch results list each failed process on its own line.
+                    std::istringstream lines(message);
+                    std::string line;
+                    while (std::getline(lines, line)) PushLog(state.forensic_log_lines, success ? ImVec4(0.7f, 0.95f, 0.7f, 1.0f) : ImVec4(0.98f, 0.55f, 0.55f, 1.0f), "[DUMP] %s", line.c_str());
+                }
                 state.dump_running = false;
                 }).detach();
         }
@@ -671,6 +889,7 @@ static void RenderForensic(AppState& state, const ImVec2& contentSize) {
             float progress; std::string status;
             { std::lock_guard<std::mutex> lock(state.dump_progress_mutex); progress = state.dump_progress; status = state.dump_status; }
             ImGui::ProgressBar(progress, ImVec2(-1, 0), status.c_str());
+            RenderResourceReadout(state, "dump_limits");
         }
         ImGui::Dummy(ImVec2(0, 5));
         EndCard();
@@ -683,6 +902,15 @@ static void RenderForensic(AppState& state, const ImVec2& contentSize) {
         ImGui::InputTextWithHint("##clean_path", ICON_FA_FILE_CODE " Clean Dump Path...", state.clean_dump_path, IM_ARRAYSIZE(state.clean_dump_path));
         ImGui::InputTextWithHint("##dirty_path", ICON_FA_FILE_CODE " Dirty Dump Path...", state.dirty_dump_path, IM_ARRAYSIZE(state.dirty_dump_path));
         ImGui::PopItemWidth();
+        ImGui::Text("Binary Dumps:"); ImGui::SameLine();
+        ImGui::RadioButton("By Offset", (int*)&state.diff_binary_mode, BINARY_DIFF_BY_OFFSET);
+        if (ImGui::IsItemHovered()) ImGui::SetTooltip("Compares the flat images byte for byte at the same file offset.");
+        ImGui::SameLine();
+        ImGui::RadioButton("By Address", (int*)&state.diff_binary_mode, BINARY_DIFF_BY_ADDRESS);
+        if (ImGui::IsItemHovered()) ImGui::SetTooltip("Optimized dumps only. Lines regions up by base address and reports added, removed\nand resized regions; content is compared only where both dumps cover an address.");
+        ImGui::SameLine();
+        ImGui::RadioButton("By Content", (int*)&state.diff_binary_mode, BINARY_DIFF_BY_CONTENT);
+        if (ImGui::IsItemHovered()) ImGui::SetTooltip("Cuts both dumps into content-defined chunks and matches them by hash, so data that\nmoved or was pushed along by an insertion is reported as moved, not as changed.");
         ImGui::Dummy(ImVec2(0, 5));
 
         bool diff_button_disabled = state.diff_running || state.clean_dump_path[0] == '\0' || state.dirty_dump_path[0] == '\0';
@@ -691,13 +919,17 @@ static void RenderForensic(AppState& state, const ImVec2& contentSize) {
         if (AccentButton(ICON_FA_SEARCH " Compare Dumps", state, ImVec2(180, 35))) {
             state.diff_running = true; state.new_diff_results_ready = false; state.diff_progress = 0.0f;
             PushLog(state.forensic_log_lines, state.accent_color, "[DIFF] Starting analysis...");
-            std::thread([&state]() {
+            std::thread([&state, binary_mode = state.diff_binary_mode]() {
                 auto progress_callback = [&](float progress) { std::lock_guard<std::mutex> lock(state.diff_progress_mutex); state.diff_progress = progress; };
-                DiffResult results = PerformDifferentialAnalysis(state.clean_dump_path, state.dirty_dump_path, progress_callback);
+                DiffResult results = PerformDifferentialAnalysis(state.clean_dump_path, state.dirty_dump_path, progress_callback, binary_mode);
+                // A text dump's provenance sidecar, if it has one, tells where each new string was found.
+                auto provenance = std::make_shared<Provenance::Index>();
+                std::string provenance_error;
+                if (!provenance->Open(state.dirty_dump_path, provenance_error)) provenance.reset();
                 std::lock_guard<std::mutex> lock(state.log_mutex);
-                state.diff_result = results; state.new_diff_results_ready = true; state.diff_running = false;
+                state.diff_result = results; state.diff_provenance = provenance; state.new_diff_results_ready = true; state.diff_running = false;
                 if (!results.error.empty()) PushLog(state.forensic_log_lines, ImVec4(0.98f, 0.55f, 0.55f, 1.0f), "[DIFF] %s", results.error.c_str());
-                else PushLog(state.forensic_log_lines, ImVec4(0.7f, 0.95f, 0.7f, 1.0f), "[DIFF] Analysis complete. Found %zu new strings and %zu modified regions.", results.new_strings.size(), results.modified_regions.size());
+                else PushLog(state.forensic_log_lines, ImVec4(0.7f, 0.95f, 0.7f, 1.0f), "[DIFF] Analysis complete. Found %zu new strings, %zu removed strings, %llu common strings and %zu modified regions.", results.new_strings.size(), results.removed_strings.size(), (unsigned long long)results.common_string_count, results.modified_regions.size());
                 }).detach();
         }
         if (diff_button_disabled) ImGui::EndDisabled();
@@ -725,18 +957,64 @@ static void RenderForensic(AppState& state, const ImVec2& contentSize) {
                         ImGui::SetClipboardText(ss.str().c_str());
                     }
                     ImGui::BeginChild("StringsList", ImVec2(0, 0), true);
-                    for (const auto& str : state.diff_result.new_strings) ImGui::TextUnformatted(str.c_str());
+                    // Large text diffs can list millions of strings; only the visible rows are drawn.
+                    ImGuiListClipper clipper;
+                    clipper.Begin((int)state.diff_result.new_strings.size());
+                    while (clipper.Step()) {
+                        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                            const auto& str = state.diff_result.new_strings[i];
+                            ImGui::TextUnformatted(str.c_str());
+                            Provenance::Record record;
+                            if (state.diff_provenance && ImGui::IsItemHovered() && state.diff_provenance->Find(str, record)) {
+                                std::string addresses;
+                                char address[32];
+                                for (uint64_t a : record.addresses) { snprintf(address, sizeof(address), "\n  0x%llX", (unsigned long long)a); addresses += address; }
+                                ImGui::SetTooltip("%s, seen %u times. Lowest addresses:%s", Provenance::EncodingNames(record.encodings).c_str(), record.count, addresses.c_str());
+                            }
+                        }
+                    }
+                    ImGui::EndChild();
+                    ImGui::EndTabItem();
+                }
+                std::string removed_label = "Removed Strings (" + std::to_string(state.diff_result.removed_strings.size()) + ")";
+                if (ImGui::BeginTabItem(removed_label.c_str())) {
+                    if (ImGui::Button("Copy to Clipboard##Removed")) {
+                        std::stringstream ss; for (const auto& str : state.diff_result.removed_strings) ss << str << "\n";
+                        ImGui::SetClipboardText(ss.str().c_str());
+                    }
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("%llu strings are in both dumps.", (unsigned long long)state.diff_result.common_string_count);
+                    ImGui::BeginChild("RemovedStringsList", ImVec2(0, 0), true);
+                    ImGuiListClipper clipper;
+                    clipper.Begin((int)state.diff_result.removed_strings.size());
+                    while (clipper.Step()) {
+                        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) ImGui::TextUnformatted(state.diff_result.removed_strings[i].c_str());
+                    }
                     ImGui::EndChild();
                     ImGui::EndTabItem();
                 }
                 if (!state.diff_result.modified_regions.empty()) {
                     std::string regions_label = "Modified Regions (" + std::to_string(state.diff_result.modified_regions.size()) + ")";
                     if (ImGui::BeginTabItem(regions_label.c_str())) {
-                        if (ImGui::BeginTable("RegionsTable", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
-                            ImGui::TableSetupColumn("Offset"); ImGui::TableSetupColumn("Size"); ImGui::TableSetupColumn("Hashes (Clean -> Dirty)"); ImGui::TableHeadersRow();
-                            for (const auto& region : state.diff_result.modified_regions) {
-                                ImGui::TableNextRow(); ImGui::TableNextColumn(); ImGui::Text("0x%llX", region.offset); ImGui::TableNextColumn(); ImGui::Text("%zu bytes", region.size); ImGui::TableNextColumn();
-                                std::stringstream ss; ss << "0x" << std::hex << region.clean_hash << " -> 0x" << region.dirty_hash; ImGui::Text("%s", ss.str().c_str());
+                        if (ImGui::BeginTable("RegionsTable", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
+                            ImGui::TableSetupColumn("Change"); ImGui::TableSetupColumn("Address"); ImGui::TableSetupColumn("Offset"); ImGui::TableSetupColumn("Size"); ImGui::TableSetupColumn("Changed Bytes"); ImGui::TableHeadersRow();
+                            ImGuiListClipper clipper;
+                            clipper.Begin((int)state.diff_result.modified_regions.size());
+                            while (clipper.Step()) {
+                                for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                                    const auto& region = state.diff_result.modified_regions[i];
+                                    ImGui::TableNextRow(); ImGui::TableNextColumn(); ImGui::TextUnformatted(BinaryDiff::ChangeKindName(region.kind));
+                                    ImGui::TableNextColumn();
+                                    if (region.has_address) ImGui::Text("0x%llX", (unsigned long long)region.address);
+                                    else ImGui::TextDisabled("-");
+                                    ImGui::TableNextColumn();
+                                    if (region.kind == BinaryDiff::CHANGE_MOVED) ImGui::Text("0x%llX -> 0x%llX", (unsigned long long)region.clean_offset, (unsigned long long)region.offset);
+                                    else ImGui::Text("0x%llX", (unsigned long long)region.offset);
+                                    ImGui::TableNextColumn();
+                                    if (region.kind == BinaryDiff::CHANGE_RESIZED) ImGui::Text("%llu -> %llu bytes", (unsigned long long)region.clean_size, (unsigned long long)region.size);
+                                    else ImGui::Text("%llu bytes", (unsigned long long)region.size);
+                                    ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)region.changed_bytes);
+                                }
                             }
                             ImGui::EndTable();
                         }
@@ -753,7 +1031,9 @@ static void RenderForensic(AppState& state, const ImVec2& contentSize) {
     ImGui::NextColumn();
 
     // --- RIGHT COLUMN ---
-    if (BeginCard(ICON_FA_SEARCH " PE File Inspector", ImVec2(0, top_card_height))) {
+    // The inspector and dump search share the top of the column; the log takes what is left.
+    const float right_card_height = contentSize.y * 0.33f;
+    if (BeginCard(ICON_FA_SEARCH " PE File Inspector", ImVec2(0, right_card_height))) {
         ImGui::PushItemWidth(-ImGui::GetStyle().ItemSpacing.x);
         ImGui::InputTextWithHint("##file_path_inspect", ICON_FA_FILE_CODE " File Path (drag/drop)...", state.file_to_inspect, IM_ARRAYSIZE(state.file_to_inspect));
         ImGui::PopItemWidth();
@@ -808,6 +1088,91 @@ static void RenderForensic(AppState& state, const ImVec2& contentSize) {
 
     ImGui::Dummy(ImVec2(0, item_spacing));
 
+    if (BeginCard(ICON_FA_SEARCH " Dump Search", ImVec2(0, right_card_height), true, 10.f, true)) {
+        ImGui::PushItemWidth(-ImGui::GetStyle().ItemSpacing.x);
+        ImGui::InputTextWithHint("##search_dump_path", ICON_FA_FILE_CODE " Dump Path...", state.search_dump_path, IM_ARRAYSIZE(state.search_dump_path));
+        ImGui::InputTextWithHint("##search_query", ICON_FA_SEARCH " Text or regular expression...", state.search_query, IM_ARRAYSIZE(state.search_query));
+        ImGui::PopItemWidth();
+        ImGui::Checkbox("Regex", &state.search_regex);
+        ImGui::SameLine();
+        ImGui::Checkbox("Case Insensitive##search", &state.search_case_insensitive);
+        if (ImGui::IsItemHovered()) ImGui::SetTooltip("Folds ASCII letters only.");
+
+        const bool index_button_disabled = state.search_running || state.search_dump_path[0] == '\0';
+        const bool search_button_disabled = index_button_disabled || state.search_query[0] == '\0';
+        const int search_threads = std::max(1, (int)std::thread::hardware_concurrency());
+        ImGui::SetCursorPosX(ImGui::GetContentRegionMax().x - 365.0f - ImGui::GetStyle().WindowPadding.x);
+        if (index_button_disabled) ImGui::BeginDisabled();
+        if (AccentButton(ICON_FA_DATABASE " Build Index", state, ImVec2(180, 35))) {
+            state.search_running = true; state.search_progress = 0.0f;
+            PushLog(state.forensic_log_lines, state.accent_color, "[SEARCH] Indexing '%s'...", state.search_dump_path);
+            const std::string dump_path = state.search_dump_path;
+            std::thread([&state, dump_path, search_threads]() {
+                auto progress_callback = [&](float progress) { std::lock_guard<std::mutex> lock(state.search_progress_mutex); state.search_progress = progress; };
+                uint64_t index_size = 0;
+                std::string error;
+                const bool success = TrigramIndex::Build(dump_path, search_threads, progress_callback, index_size, error);
+                std::lock_guard<std::mutex> lock(state.log_mutex);
+                state.search_running = false;
+                if (!success) PushLog(state.forensic_log_lines, ImVec4(0.98f, 0.55f, 0.55f, 1.0f), "[SEARCH] ERROR: %s", error.c_str());
+                else PushLog(state.forensic_log_lines, ImVec4(0.7f, 0.95f, 0.7f, 1.0f), "[SEARCH] Index written to '%s' (%.2f MB).", TrigramIndex::SidecarPath(dump_path).c_str(), index_size / (1024.0 * 1024.0));
+                }).detach();
+        }
+        if (index_button_disabled) ImGui::EndDisabled();
+        if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) ImGui::SetTooltip("Writes a trigram index next to the dump so later searches read only the pages that can match.");
+        ImGui::SameLine();
+        if (search_button_disabled) ImGui::BeginDisabled();
+        if (AccentButton(ICON_FA_SEARCH " Search", state, ImVec2(180, 35))) {
+            state.search_running = true; state.search_results_ready = false;
+            TrigramIndex::Query query;
+            query.pattern = state.search_query;
+            query.regex = state.search_regex;
+            query.case_insensitive = state.search_case_insensitive;
+            const std::string dump_path = state.search_dump_path;
+            std::thread([&state, dump_path, query, search_threads]() {
+                std::vector<TrigramIndex::Hit> hits;
+                TrigramIndex::SearchStats stats;
+                std::string error;
+                const bool success = TrigramIndex::Search(dump_path, query, search_threads, hits, stats, error);
+                std::lock_guard<std::mutex> lock(state.log_mutex);
+                state.search_hits = std::move(hits); state.search_stats = stats; state.search_results_ready = success; state.search_running = false;
+                if (!success) PushLog(state.forensic_log_lines, ImVec4(0.98f, 0.55f, 0.55f, 1.0f), "[SEARCH] ERROR: %s", error.c_str());
+                else PushLog(state.forensic_log_lines, ImVec4(0.7f, 0.95f, 0.7f, 1.0f), "[SEARCH] %zu hit(s); verified %llu of %llu pages%s.", state.search_hits.size(),
+                    (unsigned long long)stats.pages_verified, (unsigned long long)stats.page_count, stats.used_index ? " using the index" : " without an index");
+                }).detach();
+        }
+        if (search_button_disabled) ImGui::EndDisabled();
+        Separator();
+        if (state.search_running) {
+            float progress; { std::lock_guard<std::mutex> lock(state.search_progress_mutex); progress = state.search_progress; }
+            ImGui::ProgressBar(progress, ImVec2(-1, 0), "Working...");
+        }
+        else if (state.search_results_ready) {
+            ImGui::TextDisabled("%zu hit(s), %llu of %llu pages verified%s", state.search_hits.size(), (unsigned long long)state.search_stats.pages_verified,
+                (unsigned long long)state.search_stats.page_count, state.search_stats.used_index ? " (indexed)" : "");
+            if (ImGui::BeginTable("SearchHitsTable", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
+                ImGui::TableSetupColumn("Offset"); ImGui::TableSetupColumn("Address"); ImGui::TableSetupColumn("Match"); ImGui::TableHeadersRow();
+                ImGuiListClipper clipper;
+                clipper.Begin((int)state.search_hits.size());
+                while (clipper.Step()) {
+                    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                        const auto& hit = state.search_hits[i];
+                        ImGui::TableNextRow(); ImGui::TableNextColumn(); ImGui::Text("0x%llX", (unsigned long long)hit.offset);
+                        ImGui::TableNextColumn();
+                        if (hit.has_address) ImGui::Text("0x%llX", (unsigned long long)hit.address);
+                        else ImGui::TextDisabled("-");
+                        ImGui::TableNextColumn(); ImGui::TextUnformatted(hit.preview.c_str());
+                    }
+                }
+                ImGui::EndTable();
+            }
+        }
+        else ImGui::TextDisabled("Index a dump once, then search it by text or pattern.");
+        EndCard();
+    }
+
+    ImGui::Dummy(ImVec2(0, item_spacing));
+
     if (BeginCard(ICON_FA_CLIPBOARD " Forensic Log", ImVec2(0, ImGui::GetContentRegionAvail().y), true, 10.f, true)) {
         if (state.forensic_log_lines.empty()) ImGui::TextDisabled("Logs from Forensic Toolkit actions will appear here.");
         else {
@@ -852,7 +1217,8 @@ static void RenderSettings(AppState& state, const ImVec2& contentSize) {
         ImGui::Text("Default Memory Dumper Options");
         ImGui::RadioButton("Binary", (int*)&state.dump_type, AppState::DUMP_TYPE_BINARY); ImGui::SameLine();
         ImGui::RadioButton("Text (Strings)", (int*)&state.dump_type, AppState::DUMP_TYPE_TEXT);
-        ImGui::Checkbox("Optimize binary dumps (skip identical pages)", &state.dump_optimize);
+        ImGui::Checkbox("Optimize binary dumps (store identical pages once)", &state.dump_optimize);
+        ImGui::Checkbox("Compress dumps", &state.dump_compress);
         ImGui::Checkbox("Use filter list for text dumps", &state.use_filter_list);
         ImGui::Checkbox("Filter non-ASCII characters from text dumps", &state.filter_non_ascii);
 
@@ -870,6 +1236,9 @@ static void RenderSettings(AppState& state, const ImVec2& contentSize) {
         int max_threads = std::thread::hardware_concurrency();
         ImGui::SliderInt("Scanner Threads", &state.scanner_thread_count, 1, max_threads);
         if (ImGui::IsItemHovered()) ImGui::SetTooltip("Controls how many CPU threads to use for memory scanning.\nYour system has %d threads.", max_threads);
+        ImGui::Dummy(ImVec2(0, 5.0f));
+        ImGui::Text("Resource Limits (dumps and scans)");
+        RenderResourceLimits(state);
         ImGui::Dummy(ImVec2(0, 15.0f));
 
 
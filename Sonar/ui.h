@@ -2,11 +2,14 @@
 
 #include "imgui.h"
 #include "backend.h"
+#include "throttle.h"
+#include "trigram_index.h"
 #include "icons.h"
 #include <string>
 #include <vector>
 #include <mutex>
 #include <chrono>
+#include <memory>
 #include <GLFW/glfw3.h>
 
 // Struct for colored log lines (UI-specific)
@@ -15,6 +18,8 @@ struct ColoredLine {
 	std::string text;
 };
 
+namespace Provenance { class Index; }
+
 // The main application state, now focused on UI
 struct AppState {
 	enum DumpStringType { DUMP_ASCII_ONLY = 0, DUMP_UNICODE_ONLY = 1, DUMP_BOTH = 2 };
@@ -28,6 +33,15 @@ struct AppState {
 
 	// Performance
 	int scanner_thread_count; // Will be initialized by the backend
+	// Limits for dumps and scans. The UI copies these into resource_limits, which running workers
+	// read, so changes apply while a job runs. 0 MB/s means unlimited.
+	int limit_read_mb = 0;
+	int limit_write_mb = 0;
+	int limit_cpu_percent = 100;
+	bool limit_low_priority = false;
+	ResourceLimits resource_limits;
+	RateMeter read_meter;
+	RateMeter write_meter;
 
 	// Workflow
 	bool scan_case_insensitive = true;
@@ -56,10 +70,27 @@ struct AppState {
 
 	// Forensic - Dumper
 	int forensic_dump_selection = -1;
+	std::vector<bool> dump_selections; // Ctrl/Shift-click selects several processes for a batch dump.
 	char dump_output_path[512] = ""; // FIXED: Initialized to empty string
 	bool dump_running = false;
 	char forensic_process_filter[128] = ""; // FIXED: Initialized to empty string
 	bool dump_optimize = true;
+	bool dump_compress = false;
+	bool dump_checkpoint = false;
+	bool dump_text_utf8 = false;
+	bool dump_text_utf16be = false;
+	bool dump_text_latin1 = false;
+	int dump_min_length[5] = { 4, 4, 4, 4, 4 }; // Indexed by StringScan::EncodingIndex().
+	bool dump_text_sorted = false;
+	bool dump_text_front_coded = false;
+	int dump_text_budget_mb = 512;
+	bool dump_provenance = false;
+	int dump_provenance_addresses = 8;
+	bool dump_incremental = false;
+	char dump_base_path[512] = "";
+	DumpContainer dump_container = DUMP_CONTAINER_SONAR;
+	bool dump_segmented = false;
+	int dump_segment_mb = 1024;
 	DumpType dump_type;
 	float dump_progress = 0.0f;
 	std::string dump_status;
@@ -77,9 +108,22 @@ struct AppState {
 	char dirty_dump_path[512] = ""; // FIXED: Initialized to empty string
 	bool diff_running = false;
 	DiffResult diff_result;
+	std::shared_ptr<Provenance::Index> diff_provenance; // Sidecar of the dirty text dump, if any.
 	bool new_diff_results_ready = false;
 	float diff_progress = 0.0f;
 	char diff_export_path[512] = ""; // FIXED: Initialized to empty string
+	BinaryDiffMode diff_binary_mode = BINARY_DIFF_BY_OFFSET;
+
+	// Forensic - Dump Search
+	char search_dump_path[512] = "";
+	char search_query[256] = "";
+	bool search_regex = false;
+	bool search_case_insensitive = true;
+	bool search_running = false;
+	bool search_results_ready = false;
+	float search_progress = 0.0f;
+	std::vector<TrigramIndex::Hit> search_hits;
+	TrigramIndex::SearchStats search_stats;
 
 	// Shared UI
 	bool scan_running = false;
@@ -100,6 +144,7 @@ struct AppState {
 	std::mutex scan_progress_mutex;
 	std::mutex dump_progress_mutex;
 	std::mutex diff_progress_mutex;
+	std::mutex search_progress_mutex;
 	std::string path_to_drop;
 	std::mutex drop_mutex;
 
@@ -108,6 +153,8 @@ struct AppState {
 // Config Functions
 void SaveSettings(const AppState& state);
 void LoadSettings(AppState& state);
+// Copies the limit settings into resource_limits, where running dumps and scans pick them up.
+void ApplyResourceLimits(AppState& state);
 
 // UI Function Declarations
 void ApplySonarStyle(AppState& state);
@@ -0,0 +1,173 @@
+// Parses the headers Minidump::Plan() builds back through the documented layout: header, stream
+// directory, system info, module list with its name strings, and the Memory64 list. Then writes a
+// whole minidump the way the dump job does and reads every Memory64 range back from its RVA.
+//
+// Build from the repository root on Linux (or use tests/CMakeLists.txt):
+//   g++ -std=c++17 -O2 -ISonar tests/minidump_test.cpp Sonar/minidump.cpp Sonar/dump_writer.cpp
+//       Sonar/throttle.cpp -lpthread -o minidump_test
+#include "dump_writer.h"
+#include "minidump.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+static int failures = 0;
+
+static void Check(bool condition, const char* what) {
+    if (condition) return;
+    std::printf("FAILED: %s\n", what);
+    ++failures;
+}
+
+template <typename T>
+static bool Read(const std::vector<char>& data, uint64_t rva, T& value) {
+    if (rva > data.size() || sizeof(T) > data.size() - rva) return false;
+    std::memcpy(&value, data.data() + rva, sizeof(T));
+    return true;
+}
+
+// Known content for every address, so each range can be checked wherever it lands in the file.
+static char Pattern(uint64_t address) {
+    return (char)((address * 0x9E3779B97F4A7C15ULL) >> 56);
+}
+
+static bool FindStream(const std::vector<char>& data, uint32_t type, Minidump::LocationDescriptor& location) {
+    Minidump::Header header = {};
+    if (!Read(data, 0, header)) return false;
+    for (uint32_t s = 0; s < header.number_of_streams; ++s) {
+        Minidump::Directory directory = {};
+        if (!Read(data, header.stream_directory_rva + s * (uint64_t)sizeof(directory), directory)) return false;
+        if (directory.stream_type == type) {
+            location = directory.location;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool ReadString(const std::vector<char>& data, uint32_t rva, std::u16string& text) {
+    uint32_t length = 0;
+    if (rva % 4 != 0 || !Read(data, rva, length) || length % 2 != 0 || rva + 4ULL + length + 2 > data.size()) return false;
+    text.resize(length / 2);
+    std::memcpy(&text[0], data.data() + rva + 4, length);
+    char16_t terminator = 1;
+    std::memcpy(&terminator, data.data() + rva + 4 + length, 2);
+    return terminator == 0;
+}
+
+int main() {
+    std::vector<DumpFormat::RegionEntry> regions(3);
+    regions[0].base_address = 0x10000;
+    regions[0].size = 0x2000;
+    regions[1].base_address = 0x7FF600000000;
+    regions[1].size = 0x1000;
+    regions[2].base_address = 0x7FFE0000;
+    regions[2].size = 0x5000;
+    std::vector<Minidump::Module> modules = {
+        { 0x7FF600000000, 0x1000, 0x1234, 0x5678, u"C:\\Windows\\System32\\ntdll.dll" },
+        { 0x140000000, 0x20000, 0, 0, u"C:\\target.exe" },
+    };
+    Minidump::SystemInfo system;
+    system.number_of_processors = 8;
+    system.build_number = 19045;
+    const Minidump::Layout layout = Minidump::Plan(regions, modules, system, 0x60000000);
+    const std::vector<char>& data = layout.headers;
+
+    Minidump::Header header = {};
+    Check(Read(data, 0, header), "header fits");
+    Check(header.signature == Minidump::kSignature && (header.version & 0xFFFF) == Minidump::kVersion, "signature and version");
+    Check(header.number_of_streams == 3 && header.time_date_stamp == 0x60000000, "stream count and time stamp");
+    Check(header.flags == Minidump::kWithFullMemory, "full-memory flag");
+    Check(layout.data_offset == data.size() && layout.data_offset % DumpFormat::kPageSize == 0, "headers end at the page-aligned data offset");
+
+    bool seen_system = false, seen_modules = false, seen_memory = false;
+    for (uint32_t s = 0; s < header.number_of_streams; ++s) {
+        Minidump::Directory directory = {};
+        if (!Read(data, header.stream_directory_rva + s * (uint64_t)sizeof(directory), directory)) { Check(false, "directory fits"); continue; }
+        Check(directory.location.rva + (uint64_t)directory.location.data_size <= data.size(), "stream inside the headers");
+        if (directory.stream_type == Minidump::kSystemInfoStream) {
+            seen_system = true;
+            Minidump::SystemInfoRecord info = {};
+            Check(directory.location.data_size == 56 && Read(data, directory.location.rva, info), "system info size");
+            Check(info.processor_architecture == 9 && info.number_of_processors == 8 && info.build_number == 19045 && info.platform_id == 2, "system info fields");
+            std::u16string csd;
+            Check(ReadString(data, info.csd_version_rva, csd) && csd.empty(), "CSD version string");
+        }
+        else if (directory.stream_type == Minidump::kModuleListStream) {
+            seen_modules = true;
+            uint32_t count = 0;
+            Check(Read(data, directory.location.rva, count) && count == modules.size(), "module count");
+            Check(directory.location.data_size == 4 + count * 108, "module list size");
+            for (uint32_t m = 0; m < count && m < modules.size(); ++m) {
+                Minidump::ModuleRecord record = {};
+                Check(Read(data, directory.location.rva + 4 + m * 108ULL, record), "module record fits");
+                Check(record.base_of_image == modules[m].base && record.size_of_image == modules[m].size && record.checksum == modules[m].checksum &&
+                    record.time_date_stamp == modules[m].time_date_stamp, "module record fields");
+                std::u16string name;
+                Check(ReadString(data, record.module_name_rva, name) && name == modules[m].path, "module name string");
+            }
+        }
+        else if (directory.stream_type == Minidump::kMemory64ListStream) {
+            seen_memory = true;
+            uint64_t count = 0, base_rva = 0;
+            Check(directory.location.rva % 8 == 0, "Memory64 list alignment");
+            Check(Read(data, directory.location.rva, count) && count == regions.size(), "Memory64 range count");
+            Check(Read(data, directory.location.rva + 8, base_rva) && base_rva == layout.data_offset, "Memory64 BaseRva");
+            Check(directory.location.data_size == 16 + count * 16, "Memory64 list size");
+            uint64_t total = 0;
+            for (uint64_t r = 0; r < count && r < regions.size(); ++r) {
+                Minidump::MemoryDescriptor64 descriptor = {};
+                Check(Read(data, directory.location.rva + 16 + r * 16, descriptor), "descriptor fits");
+                Check(descriptor.start_of_memory_range == regions[r].base_address && descriptor.data_size == regions[r].size, "descriptor fields");
+                total += descriptor.data_size;
+            }
+            Check(layout.file_size == base_rva + total, "file size covers the memory blob");
+        }
+    }
+    Check(seen_system && seen_modules && seen_memory, "all three streams present");
+
+    // Round trip: headers at offset 0 and each chunk at data_offset plus its flat offset, as
+    // BinaryDumpJob writes them, through a sparse, preallocated file.
+    const std::string path = (std::filesystem::temp_directory_path() / "sonar_minidump_test.dmp").string();
+    {
+        for (uint64_t r = 0, first_page = 0; r < regions.size(); ++r) {
+            regions[r].first_page = first_page;
+            first_page += DumpFormat::PagesForSize(regions[r].size, DumpFormat::kPageSize);
+        }
+        PositionalFile out;
+        std::string error;
+        Check(out.Open(path, error), "create the minidump file");
+        out.MakeSparse();
+        Check(out.Preallocate(layout.file_size), "preallocate the minidump file");
+        Check(out.WriteAt(0, data.data(), data.size()), "write the headers");
+        for (const DumpChunk& chunk : PlanDumpChunks(regions, DumpFormat::kPageSize, 2 * DumpFormat::kPageSize)) {
+            std::vector<char> bytes((size_t)chunk.size);
+            for (size_t i = 0; i < bytes.size(); ++i) bytes[i] = Pattern(chunk.address + i);
+            Check(out.WriteAt(layout.data_offset + chunk.flat_offset, bytes.data(), bytes.size()), "write a chunk");
+        }
+    }
+    std::ifstream in(path, std::ios::binary);
+    const std::vector<char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::filesystem::remove(path);
+    Check(file.size() == layout.file_size, "written file has the planned size");
+
+    Minidump::LocationDescriptor memory = {};
+    uint64_t range_count = 0, rva = 0;
+    Check(FindStream(file, Minidump::kMemory64ListStream, memory) && Read(file, memory.rva, range_count) && Read(file, memory.rva + 8, rva), "Memory64 list in the written file");
+    uint64_t ranges_matched = 0;
+    for (uint64_t r = 0; r < range_count; ++r) {
+        Minidump::MemoryDescriptor64 descriptor = {};
+        if (!Read(file, memory.rva + 16 + r * 16, descriptor) || rva > file.size() || descriptor.data_size > file.size() - rva) break;
+        bool same = true;
+        for (uint64_t i = 0; i < descriptor.data_size && same; ++i) same = file[(size_t)(rva + i)] == Pattern(descriptor.start_of_memory_range + i);
+        if (same) ++ranges_matched;
+        rva += descriptor.data_size;
+    }
+    Check(range_count == regions.size() && ranges_matched == range_count, "every range reads back its own bytes at its RVA");
+    std::printf(failures ? "%d checks failed\n" : "ok\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+// Indexed and unindexed dump searches must return the same hits.
+//
+// Build from the repository root on Linux (or use tests/CMakeLists.txt):
+//   g++ -std=c++17 -O2 -ISonar tests/trigram_index_test.cpp Sonar/trigram_index.cpp Sonar/dump_reader.cpp
+//       Sonar/dump_manifest.cpp Sonar/dump_writer.cpp Sonar/mapped_file.cpp Sonar/frame_file.cpp
+//       Sonar/block_codec.cpp Sonar/throttle.cpp -lpthread -o trigram_index_test
+#include "trigram_index.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+static std::vector<std::pair<uint64_t, size_t>> Hits(const std::string& path, const TrigramIndex::Query& query, bool& used_index) {
+    std::vector<TrigramIndex::Hit> hits;
+    TrigramIndex::SearchStats stats;
+    std::string error;
+    if (!TrigramIndex::Search(path, query, 4, hits, stats, error)) std::printf("search failed: %s\n", error.c_str());
+    used_index = stats.used_index;
+    std::vector<std::pair<uint64_t, size_t>> result;
+    for (const auto& hit : hits) result.emplace_back(hit.offset, hit.length);
+    return result;
+}
+
+int main() {
+    const std::string path = (std::filesystem::temp_directory_path() / "sonar_trigram_test.bin").string();
+    std::filesystem::remove(TrigramIndex::SidecarPath(path));
+
+    // Random text over eight letters, few enough trigrams that no page is dense, with the needles
+    // planted at and across page boundaries.
+    std::mt19937_64 rng(7);
+    std::string image(64 * 4096, '\0');
+    for (char& c : image) c = (char)('a' + rng() % 8);
+    const std::string long_literal = std::string(5000, 'Q') + "END";
+    for (uint64_t offset : { 100ULL, 4094ULL, 8190ULL, 20000ULL, 40958ULL, 131070ULL }) image.replace((size_t)offset, 9, "ABCDE\nXYZ");
+    image.replace(200000, long_literal.size(), long_literal);
+    std::ofstream(path, std::ios::binary).write(image.data(), (std::streamsize)image.size());
+
+    const std::vector<TrigramIndex::Query> queries = {
+        { "ABCDE", false }, { "abcde", false, true }, { long_literal, false },
+        { "\\x41BCDE", true }, { "\\u0041BCDE", true }, { "A\\x42CDE", true }, { "[A]BC\\x44E", true },
+        { "(A)\\1*BCDE", true }, { "\\nXYZ", true }, { "\\dBCDE|ABCDE", true }, { "Q{10}END", true },
+    };
+    std::vector<std::vector<std::pair<uint64_t, size_t>>> unindexed;
+    bool used_index = false;
+    for (const auto& query : queries) unindexed.push_back(Hits(path, query, used_index));
+
+    uint64_t index_size = 0;
+    std::string error;
+    if (!TrigramIndex::Build(path, 4, [](float) {}, index_size, error)) { std::printf("build failed: %s\n", error.c_str()); return 1; }
+    int failures = 0;
+    for (size_t q = 0; q < queries.size(); ++q) {
+        const auto indexed = Hits(path, queries[q], used_index);
+        const bool same = indexed == unindexed[q];
+        if (!same) ++failures;
+        std::printf("%-12s %-24.24s %zu hits unindexed, %zu indexed%s\n", same ? "ok" : "MISMATCH", queries[q].pattern.c_str(), unindexed[q].size(), indexed.size(), used_index ? "" : " (index not used)");
+    }
+    std::filesystem::remove(path);
+    std::filesystem::remove(TrigramIndex::SidecarPath(path));
+    return failures == 0 ? 0 : 1;
+}